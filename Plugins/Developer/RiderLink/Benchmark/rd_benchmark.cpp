@@ -0,0 +1,532 @@
+#include "wire/SocketWire.h"
+#include "wire/SharedMemoryWire.h"
+#include "protocol/Protocol.h"
+#include "impl/RdSignal.h"
+#include "impl/RdMap.h"
+#include "impl/RdStream.h"
+#include "task/RdCall.h"
+#include "task/RdEndpoint.h"
+#include "scheduler/SingleThreadScheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+
+/**
+ * \brief Loopback benchmark of the RD stack: two protocols within this process, connected by [SocketWire] or
+ * [SharedMemoryWire], each served by its own scheduler.
+ *
+ * Every measurement is printed as one JSON object per line:
+ * - "burst" cases send all messages at once, latency is measured from sending to delivery of each message under load
+ * - "stream_wstring" cases are bursts of values written to a single [RdStream], received as its chunks arrive
+ * - "round_trip" cases send the next message only after the previous one was answered
+ * - payload_bytes is the serialized size of the value, mb_per_s counts payload bytes only
+ * - allocs_per_msg counts every heap allocation of the process while the case runs, divided by the message count
+ * - ctx_switches_per_msg counts the voluntary and involuntary context switches of the process the same way
+ *
+ * The "socket_uring" wire is a [SocketWire] doing its I/O through io_uring, it is skipped where that isn't supported.
+ *
+ * Usage: rd_benchmark [socket|socket_uring|shm|all] [messages]
+ */
+namespace
+{
+std::atomic<uint64_t> allocations{0};
+
+void* allocate(std::size_t size, std::size_t alignment)
+{
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	// aligned_alloc wants a size which is a multiple of the alignment
+	size = (std::max)(size, std::size_t{1});
+	void* p = alignment <= alignof(std::max_align_t) ? std::malloc(size)
+													  : std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+	if (p == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return p;
+}
+}	 // namespace
+
+void* operator new(std::size_t size)
+{
+	return allocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	return allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept
+{
+	std::free(p);
+}
+
+namespace
+{
+using namespace rd;
+using clock_type = std::chrono::steady_clock;
+
+/**
+ * \brief Caps the bytes sent by a single burst case, so large payloads run fewer messages.
+ */
+constexpr size_t BURST_BYTES_LIMIT = 64u << 20;
+constexpr int32_t ROUND_TRIPS = 10000;
+
+struct WirePair
+{
+	std::shared_ptr<IWire> server;
+	std::shared_ptr<IWire> client;
+};
+
+WirePair create_socket_wires(Lifetime lifetime, IScheduler* server_scheduler, IScheduler* client_scheduler)
+{
+	auto server = std::make_shared<SocketWire::Server>(lifetime, server_scheduler, 0, "BenchmarkServer");
+	auto client = std::make_shared<SocketWire::Client>(lifetime, client_scheduler, server->port, "BenchmarkClient");
+	return {server, client};
+}
+
+WirePair create_shared_memory_wires(Lifetime lifetime, IScheduler* server_scheduler, IScheduler* client_scheduler)
+{
+	auto server = std::make_shared<SharedMemoryWire::Server>(lifetime, server_scheduler, "BenchmarkServer");
+	auto client = std::make_shared<SharedMemoryWire::Client>(lifetime, client_scheduler, server->name, "BenchmarkClient");
+	return {server, client};
+}
+
+bool wait_until(std::function<bool()> const& condition)
+{
+	const auto deadline = clock_type::now() + std::chrono::seconds(60);
+	while (!condition())
+	{
+		if (clock_type::now() > deadline)
+		{
+			return false;
+		}
+		std::this_thread::sleep_for(std::chrono::microseconds(50));
+	}
+	return true;
+}
+
+/**
+ * \brief Serialized size of a wstring of [length] characters: length prefix and UTF-16 code units.
+ */
+size_t wstring_bytes(size_t length)
+{
+	return sizeof(int32_t) + 2 * length;
+}
+
+struct Measurement
+{
+	std::string name;
+	std::string mode;
+	size_t payload_bytes = 0;
+	int32_t messages = 0;
+	double seconds = 0;
+	std::vector<double> latencies_us;
+	uint64_t allocations = 0;
+	uint64_t context_switches = 0;
+	bool complete = false;
+};
+
+uint64_t context_switches()
+{
+	rusage usage{};
+	getrusage(RUSAGE_SELF, &usage);
+	return static_cast<uint64_t>(usage.ru_nvcsw) + static_cast<uint64_t>(usage.ru_nivcsw);
+}
+
+/**
+ * \brief Prints the counters of a socket wire, other wires don't provide them.
+ */
+void report_stats(std::string const& wire, std::shared_ptr<IWire> const& server)
+{
+	const auto socket_wire = std::dynamic_pointer_cast<SocketWire::Base>(server);
+	if (!socket_wire)
+	{
+		return;
+	}
+	const auto stats = socket_wire->get_stats();
+	std::printf(
+		"{\"wire\":\"%s\",\"stats\":\"server\",\"messages_sent\":%llu,\"bytes_sent\":%llu,\"messages_received\":%llu,"
+		"\"bytes_received\":%llu,\"pending_packages\":%zu,\"reconnects\":%u,\"heartbeat_echo_delay_us\":%lld,\"acks\":%llu,"
+		"\"ack_p50_us\":%lld,\"ack_p99_us\":%lld,\"ack_p999_us\":%lld}\n",
+		wire.c_str(), static_cast<unsigned long long>(stats.messages_sent), static_cast<unsigned long long>(stats.bytes_sent),
+		static_cast<unsigned long long>(stats.messages_received), static_cast<unsigned long long>(stats.bytes_received),
+		stats.pending_packages, stats.reconnects, static_cast<long long>(stats.heartbeat_echo_delay.count()),
+		static_cast<unsigned long long>(stats.ack_latency.count()), static_cast<long long>(stats.ack_latency.percentile(0.5).count()),
+		static_cast<long long>(stats.ack_latency.percentile(0.99).count()),
+		static_cast<long long>(stats.ack_latency.percentile(0.999).count()));
+	std::fflush(stdout);
+}
+
+void report(std::string const& wire, Measurement& m)
+{
+	std::sort(m.latencies_us.begin(), m.latencies_us.end());
+	auto percentile = [&](double p) {
+		return m.latencies_us.empty() ? 0.0 : m.latencies_us[static_cast<size_t>(p * (m.latencies_us.size() - 1))];
+	};
+	const double messages = m.messages;
+	std::printf(
+		"{\"wire\":\"%s\",\"case\":\"%s\",\"mode\":\"%s\",\"payload_bytes\":%zu,\"messages\":%d,\"complete\":%s,"
+		"\"msg_per_s\":%.0f,\"mb_per_s\":%.2f,\"p50_us\":%.1f,\"p99_us\":%.1f,\"p999_us\":%.1f,\"allocs_per_msg\":%.2f,"
+		"\"ctx_switches_per_msg\":%.3f}\n",
+		wire.c_str(), m.name.c_str(), m.mode.c_str(), m.payload_bytes, m.messages, m.complete ? "true" : "false",
+		messages / m.seconds, messages * m.payload_bytes / m.seconds / 1e6, percentile(0.5), percentile(0.99), percentile(0.999),
+		m.allocations / messages, m.context_switches / messages);
+	std::fflush(stdout);
+}
+
+/**
+ * \brief Both ends of every benchmarked entity, the server side sends and the client side receives.
+ */
+class Fixture
+{
+	SingleThreadScheduler& server_scheduler;
+	SingleThreadScheduler& client_scheduler;
+	LifetimeDefinition definition{Lifetime::Eternal()};
+	Lifetime lifetime = definition.lifetime;
+	WirePair wires;
+	std::unique_ptr<Protocol> server;
+	std::unique_ptr<Protocol> client;
+
+	RdSignal<int32_t> int_signal;
+	RdSignal<int32_t> int_signal_peer;
+	RdSignal<int32_t> int_reply;
+	RdSignal<int32_t> int_reply_peer;
+	RdSignal<std::wstring> string_signal;
+	RdSignal<std::wstring> string_signal_peer;
+	RdStream<std::wstring> string_stream;
+	RdStream<std::wstring> string_stream_peer;
+	RdMap<int32_t, std::wstring> map;
+	RdMap<int32_t, std::wstring> map_peer;
+	RdEndpoint<std::wstring, int32_t> endpoint;
+	RdCall<std::wstring, int32_t> call;
+
+	/**
+	 * \brief Written by the sending side of a burst before each message, read by the receiving side.
+	 */
+	std::vector<clock_type::time_point> send_times;
+	/**
+	 * \brief Filled by the receiving side, handed over to the main thread by [received].
+	 */
+	std::vector<double> latencies_us;
+	std::atomic<int32_t> received{0};
+	std::atomic<bool> echo{false};
+	std::atomic<int32_t> answered{0};
+	std::vector<WiredRdTask<int32_t>> pending_calls;
+
+	void on_received()
+	{
+		const int32_t index = received.load(std::memory_order_relaxed);
+		latencies_us.push_back(std::chrono::duration<double, std::micro>(clock_type::now() - send_times[index]).count());
+		received.store(index + 1, std::memory_order_release);
+	}
+
+	void bind()
+	{
+		int_signal.async = int_reply_peer.async = string_signal.async = true;
+		server_scheduler.queue([this] {
+			statics(int_signal, 1);
+			statics(int_reply_peer, 2);
+			statics(string_signal, 3);
+			statics(map, 4);
+			statics(endpoint, 5);
+			statics(string_stream, 6);
+			map.is_master = true;
+			int_signal.bind(lifetime, server.get(), "int_signal");
+			int_reply_peer.bind(lifetime, server.get(), "int_reply");
+			string_signal.bind(lifetime, server.get(), "string_signal");
+			map.bind(lifetime, server.get(), "map");
+			endpoint.bind(lifetime, server.get(), "call");
+			string_stream.bind(lifetime, server.get(), "string_stream");
+			int_reply_peer.advise(lifetime, [this](int32_t const&) { answered.fetch_add(1, std::memory_order_release); });
+			endpoint.set([](std::wstring const& request) { return static_cast<int32_t>(request.size()); });
+		});
+		client_scheduler.queue([this] {
+			statics(int_signal_peer, 1);
+			statics(int_reply, 2);
+			statics(string_signal_peer, 3);
+			statics(map_peer, 4);
+			statics(call, 5);
+			statics(string_stream_peer, 6);
+			int_signal_peer.bind(lifetime, client.get(), "int_signal");
+			int_reply.bind(lifetime, client.get(), "int_reply");
+			string_signal_peer.bind(lifetime, client.get(), "string_signal");
+			map_peer.bind(lifetime, client.get(), "map");
+			call.bind(lifetime, client.get(), "call");
+			string_stream_peer.bind(lifetime, client.get(), "string_stream");
+			int_signal_peer.advise(lifetime, [this](int32_t const& value) {
+				if (echo)
+				{
+					int_reply.fire(value);
+				}
+				else
+				{
+					on_received();
+				}
+			});
+			string_signal_peer.advise(lifetime, [this](std::wstring const&) { on_received(); });
+			string_stream_peer.advise(lifetime, [this](std::wstring const&) { on_received(); });
+			map_peer.advise_add_remove(lifetime, [this](AddRemove kind, int32_t const&, std::wstring const&) {
+				if (kind == AddRemove::ADD)
+				{
+					on_received();
+				}
+			});
+		});
+		server_scheduler.flush();
+		client_scheduler.flush();
+	}
+
+	template <typename F>
+	Measurement burst(std::string name, size_t payload_bytes, int32_t messages, F&& send)
+	{
+		Measurement m;
+		m.name = std::move(name);
+		m.mode = "burst";
+		m.payload_bytes = payload_bytes;
+		m.messages = messages;
+		send_times.assign(messages, {});
+		latencies_us.clear();
+		latencies_us.reserve(messages);
+		received = 0;
+
+		const uint64_t allocations_at_start = allocations.load();
+		const uint64_t context_switches_at_start = context_switches();
+		const auto start = clock_type::now();
+		server_scheduler.queue([&] {
+			for (int32_t i = 0; i < messages; ++i)
+			{
+				send_times[i] = clock_type::now();
+				send(i);
+			}
+		});
+		m.complete = wait_until([&] { return received.load(std::memory_order_acquire) >= messages; });
+		m.seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+		m.allocations = allocations.load() - allocations_at_start;
+		m.context_switches = context_switches() - context_switches_at_start;
+		server_scheduler.flush();
+		m.latencies_us = std::move(latencies_us);
+		latencies_us = {};
+		return m;
+	}
+
+	/**
+	 * \brief Runs [start] for one round trip after another, each must increment [answered] once it completes.
+	 */
+	template <typename F>
+	Measurement round_trips(std::string name, size_t payload_bytes, F&& start)
+	{
+		Measurement m;
+		m.name = std::move(name);
+		m.mode = "round_trip";
+		m.payload_bytes = payload_bytes;
+		m.messages = ROUND_TRIPS;
+		m.latencies_us.reserve(ROUND_TRIPS);
+		answered = 0;
+
+		const uint64_t allocations_at_start = allocations.load();
+		const uint64_t context_switches_at_start = context_switches();
+		const auto begin = clock_type::now();
+		m.complete = true;
+		for (int32_t i = 0; i < ROUND_TRIPS && m.complete; ++i)
+		{
+			const auto sent = clock_type::now();
+			start(i);
+			while (answered.load(std::memory_order_acquire) <= i)
+			{
+				if (clock_type::now() - sent > std::chrono::seconds(10))
+				{
+					m.complete = false;
+					break;
+				}
+			}
+			m.latencies_us.push_back(std::chrono::duration<double, std::micro>(clock_type::now() - sent).count());
+		}
+		m.seconds = std::chrono::duration<double>(clock_type::now() - begin).count();
+		m.allocations = allocations.load() - allocations_at_start;
+		m.context_switches = context_switches() - context_switches_at_start;
+		return m;
+	}
+
+public:
+	Fixture(WirePair (*create)(Lifetime, IScheduler*, IScheduler*), SingleThreadScheduler& server_scheduler,
+		SingleThreadScheduler& client_scheduler)
+		: server_scheduler(server_scheduler), client_scheduler(client_scheduler)
+	{
+		wires = create(lifetime, &server_scheduler, &client_scheduler);
+		server = std::make_unique<Protocol>(Identities::SERVER, &server_scheduler, wires.server, lifetime);
+		client = std::make_unique<Protocol>(Identities::CLIENT, &client_scheduler, wires.client, lifetime);
+		bind();
+	}
+
+	~Fixture()
+	{
+		server_scheduler.flush();
+		client_scheduler.flush();
+		definition.terminate();
+	}
+
+	std::shared_ptr<IWire> const& get_server_wire() const
+	{
+		return wires.server;
+	}
+
+	bool connect()
+	{
+		const bool connected = wait_until([&] { return wires.server->connected.get() && wires.client->connected.get(); });
+		// let both sides settle their handshakes before measuring
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		return connected;
+	}
+
+	/**
+	 * \brief Runs every case, passing each measurement to [report] as soon as it completes.
+	 * \return whether all of them completed
+	 */
+	template <typename F>
+	bool run(int32_t messages, F&& report_measurement)
+	{
+		bool complete = true;
+		auto report = [&](Measurement m) {
+			complete &= m.complete;
+			report_measurement(m);
+		};
+		auto limit = [&](size_t payload_bytes) {
+			return static_cast<int32_t>((std::min)(static_cast<size_t>(messages), (std::max)(size_t{1000}, BURST_BYTES_LIMIT / payload_bytes)));
+		};
+
+		report(burst("signal_int", sizeof(int32_t), messages, [&](int32_t i) { int_signal.fire(i); }));
+
+		echo = true;
+		report(round_trips("signal_int", sizeof(int32_t), [&](int32_t i) {
+			server_scheduler.queue([this, i] { int_signal.fire(i); });
+		}));
+		echo = false;
+
+		for (size_t length : {16, 256, 4096, 65536})
+		{
+			std::wstring payload(length, L'x');
+			report(burst("signal_wstring", wstring_bytes(length), limit(wstring_bytes(length)),
+				[&](int32_t) { string_signal.fire(payload); }));
+		}
+
+		for (size_t length : {16, 4096, 65536})
+		{
+			// a single stream carries all values of the case
+			const std::wstring payload(length, L'x');
+			const int32_t count = limit(wstring_bytes(length));
+			std::unique_ptr<RdStream<std::wstring>::Writer> writer;
+			report(burst("stream_wstring", wstring_bytes(length), count, [&](int32_t i) {
+				if (i == 0)
+				{
+					writer = std::make_unique<RdStream<std::wstring>::Writer>(string_stream.open());
+				}
+				writer->write(payload);
+				if (i == count - 1)
+				{
+					writer.reset();
+				}
+			}));
+		}
+
+		int32_t first_key = 0;
+		for (size_t length : {16, 1024, 16384})
+		{
+			// every put adds a new key, removals would race with the acknowledgements of the master side
+			const std::wstring payload(length, L'x');
+			const int32_t count = limit(wstring_bytes(length));
+			report(burst("map_put", sizeof(int32_t) + wstring_bytes(length), count, [&](int32_t i) { map.set(first_key + i, payload); }));
+			first_key += count;
+		}
+
+		for (size_t length : {16, 1024, 16384})
+		{
+			const std::wstring payload(length, L'x');
+			pending_calls.clear();
+			pending_calls.reserve(ROUND_TRIPS);
+			report(round_trips("call", wstring_bytes(length), [&](int32_t) {
+				client_scheduler.queue([&] {
+					// tasks have to outlive their response
+					pending_calls.push_back(call.start(payload, &client_scheduler));
+					pending_calls.back().advise(lifetime, [this](RdTaskResult<int32_t> const&) {
+						answered.fetch_add(1, std::memory_order_release);
+					});
+				});
+			}));
+			client_scheduler.flush();
+		}
+		return complete;
+	}
+};
+
+bool run(std::string const& wire, WirePair (*create)(Lifetime, IScheduler*, IScheduler*), int32_t messages,
+	SingleThreadScheduler& server_scheduler, SingleThreadScheduler& client_scheduler)
+{
+	Fixture fixture(create, server_scheduler, client_scheduler);
+	if (!fixture.connect())
+	{
+		std::printf("{\"wire\":\"%s\",\"error\":\"not_connected\"}\n", wire.c_str());
+		return false;
+	}
+	const bool complete = fixture.run(messages, [&](Measurement& measurement) { report(wire, measurement); });
+	report_stats(wire, fixture.get_server_wire());
+	return complete;
+}
+}	 // namespace
+
+int main(int argc, char** argv)
+{
+	const std::string wire = argc > 1 ? argv[1] : "all";
+	const int32_t messages = argc > 2 ? std::atoi(argv[2]) : 100000;
+	spdlog::set_level(spdlog::level::err);
+
+	LifetimeDefinition scheduler_definition(Lifetime::Eternal());
+	SingleThreadScheduler server_scheduler(scheduler_definition.lifetime, "BenchmarkServerScheduler");
+	SingleThreadScheduler client_scheduler(scheduler_definition.lifetime, "BenchmarkClientScheduler");
+
+	bool success = true;
+	if (wire == "socket" || wire == "all")
+	{
+		success &= run("socket", create_socket_wires, messages, server_scheduler, client_scheduler);
+	}
+	if (wire == "socket_uring" || wire == "all")
+	{
+		SocketWire::set_io_uring_enabled(true);
+		if (SocketWire::is_io_uring_enabled())
+		{
+			success &= run("socket_uring", create_socket_wires, messages, server_scheduler, client_scheduler);
+		}
+		SocketWire::set_io_uring_enabled(false);
+	}
+	if ((wire == "shm" || wire == "all") && SharedMemoryWire::is_supported())
+	{
+		success &= run("shm", create_shared_memory_wires, messages, server_scheduler, client_scheduler);
+	}
+	scheduler_definition.terminate();
+	return success ? 0 : 1;
+}
@@ -4,6 +4,7 @@
 #include "IRdBindable.h"
 #include "scheduler/base/IScheduler.h"
 #include "IRdWireable.h"
+#include "Lane.h"
 
 #include <rd_framework_export.h>
 
@@ -21,6 +22,16 @@ public:
 	 * Otherwise, local changes can be performed only on the UI thread.
 	 */
 	bool async = false;
+	/**
+	 * \brief Lane the messages of this object are sent in. It may be changed after binding as well, only messages
+	 * sent afterwards are affected then.
+	 */
+	mutable Lane lane = Lane::Interactive;
+	/**
+	 * \brief Lets the wire drop messages of this object while its send queue is full, instead of blocking or failing
+	 * the sender. Only signals honor it, other objects would get out of sync with their counterparts.
+	 */
+	mutable bool lossy = false;
 	// region ctor/dtor
 
 	IRdReactive() = default;
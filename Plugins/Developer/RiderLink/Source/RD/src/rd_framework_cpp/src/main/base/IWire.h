@@ -20,6 +20,11 @@ namespace rd
 class RD_FRAMEWORK_API IWire
 {
 public:
+	/**
+	 * \brief Default limit of the size of a received message, and of a value received through a stream.
+	 */
+	static constexpr size_t DEFAULT_MAX_MESSAGE_SIZE = 64 * 1024 * 1024;
+
 	Property<bool> connected{false};
 	Property<bool> heartbeatAlive{false};
 
@@ -39,6 +44,26 @@ public:
 	 */
 	virtual void send(RdId const& id, std::function<void(Buffer& buffer)> writer) const = 0;
 
+	/**
+	 * \brief Sends a data block like [send] within the given [lane]. Wires without lanes send it in order with all
+	 * other data blocks.
+	 */
+	virtual void send(RdId const& id, std::function<void(Buffer& buffer)> writer, Lane lane) const
+	{
+		(void) lane;
+		send(id, std::move(writer));
+	}
+
+	/**
+	 * \brief Sends a data block like [send] within the given [lane]. A [lossy] one may be dropped while the send
+	 * queue is full, wires which never drop send it like any other.
+	 */
+	virtual void send(RdId const& id, std::function<void(Buffer& buffer)> writer, Lane lane, bool lossy) const
+	{
+		(void) lossy;
+		send(id, std::move(writer), lane);
+	}
+
 	/**
 	 * \brief Adds a [handler] for receiving updated values of the object with the given [id]. The handler is removed
 	 * when the given [lifetime] is terminated.
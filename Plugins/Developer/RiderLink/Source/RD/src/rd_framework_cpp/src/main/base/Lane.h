@@ -0,0 +1,30 @@
+#ifndef RD_CPP_LANE_H
+#define RD_CPP_LANE_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rd
+{
+/**
+ * \brief Send lane of the messages of an entity. Wires drain their lanes by weight, so a flood of bulk messages doesn't
+ * hold back control traffic. Messages keep their order within a lane, control messages may overtake the other lanes
+ * and interactive and bulk messages may overtake each other.
+ */
+enum class Lane : uint8_t
+{
+	/**
+	 * \brief Small latency sensitive messages like commands and call responses.
+	 */
+	Control,
+	Interactive,
+	/**
+	 * \brief High volume messages like logs, they give way to the other lanes.
+	 */
+	Bulk
+};
+
+constexpr size_t LANE_COUNT = 3;
+}	 // namespace rd
+
+#endif	  // RD_CPP_LANE_H
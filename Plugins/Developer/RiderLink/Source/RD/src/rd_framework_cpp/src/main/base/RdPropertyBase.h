@@ -83,7 +83,7 @@ public:
 				S::write(this->get_serialization_context(), buffer, v);
 				spdlog::get("logSend")->trace("SEND property {} + {}:: ver = {}, value = {}", to_string(location), to_string(rdid),
 					std::to_string(master_version), to_string(v));
-			});
+			}, lane);
 		});
 
 		get_wire()->advise(lifetime, this);
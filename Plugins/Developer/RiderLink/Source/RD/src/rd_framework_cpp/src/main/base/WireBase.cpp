@@ -2,6 +2,8 @@
 
 namespace rd
 {
+constexpr size_t IWire::DEFAULT_MAX_MESSAGE_SIZE;
+
 void WireBase::advise(Lifetime lifetime, const IRdReactive* entity) const
 {
 	message_broker.advise_on(lifetime, entity);
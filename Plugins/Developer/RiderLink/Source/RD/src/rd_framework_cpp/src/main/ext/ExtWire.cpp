@@ -21,7 +21,8 @@ ExtWire::ExtWire()
 					auto it = std::move(sendQ.front());
 					sendQ.pop();
 					realWire->send(
-						it.first, [payload = std::move(it.second)](Buffer& buffer) { buffer.write_byte_array_raw(payload); });
+						std::get<0>(it), [payload = std::move(std::get<1>(it))](Buffer& buffer) { buffer.write_byte_array_raw(payload); },
+						std::get<2>(it), std::get<3>(it));
 				}
 			}
 		}
@@ -34,6 +35,16 @@ void ExtWire::advise(Lifetime lifetime, IRdReactive const* entity) const
 }
 
 void ExtWire::send(RdId const& id, std::function<void(Buffer& buffer)> writer) const
+{
+	send(id, std::move(writer), Lane::Interactive);
+}
+
+void ExtWire::send(RdId const& id, std::function<void(Buffer& buffer)> writer, Lane lane) const
+{
+	send(id, std::move(writer), lane, false);
+}
+
+void ExtWire::send(RdId const& id, std::function<void(Buffer& buffer)> writer, Lane lane, bool lossy) const
 {
 	{
 		std::lock_guard<decltype(lock)> guard(lock);
@@ -41,10 +52,10 @@ void ExtWire::send(RdId const& id, std::function<void(Buffer& buffer)> writer) c
 		{
 			Buffer buffer;
 			writer(buffer);
-			sendQ.emplace(id, buffer.getRealArray());
+			sendQ.emplace(id, buffer.getRealArray(), lane, lossy);
 			return;
 		}
 	}
-	realWire->send(id, std::move(writer));
+	realWire->send(id, std::move(writer), lane, lossy);
 }
 }	 // namespace rd
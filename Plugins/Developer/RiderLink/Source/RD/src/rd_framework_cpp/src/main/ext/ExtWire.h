@@ -13,6 +13,7 @@
 #include <queue>
 #include <mutex>
 #include <functional>
+#include <tuple>
 
 #include <rd_framework_export.h>
 
@@ -22,7 +23,7 @@ class RD_FRAMEWORK_API ExtWire final : public IWire
 {
 	mutable std::mutex lock;
 
-	mutable std::queue<std::pair<RdId, Buffer::ByteArray> > sendQ;
+	mutable std::queue<std::tuple<RdId, Buffer::ByteArray, Lane, bool> > sendQ;
 
 public:
 	ExtWire();
@@ -32,6 +33,10 @@ public:
 	void advise(Lifetime lifetime, IRdReactive const* entity) const override;
 
 	void send(RdId const& id, std::function<void(Buffer& buffer)> writer) const override;
+
+	void send(RdId const& id, std::function<void(Buffer& buffer)> writer, Lane lane) const override;
+
+	void send(RdId const& id, std::function<void(Buffer& buffer)> writer, Lane lane, bool lossy) const override;
 };
 }	 // namespace rd
 #if defined(_MSC_VER)
@@ -105,7 +105,7 @@ public:
 						S::write(this->get_serialization_context(), buffer, *new_value);
 					}
 					spdlog::get("logSend")->trace(logmsg(op, next_version - 1, e.get_index(), new_value));
-				});
+				}, lane);
 			});
 		});
 
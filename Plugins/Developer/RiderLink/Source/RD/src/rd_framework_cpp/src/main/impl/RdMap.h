@@ -126,7 +126,7 @@ public:
 					}
 
 					spdlog::get("logSend")->trace("SEND{}", logmsg(op, next_version - 1, e.get_key(), new_value));
-				});
+				}, lane);
 			});
 		});
 
@@ -232,7 +232,7 @@ public:
 						innerBuffer.write_byte_array_raw(serialized_key.getArray());
 						// logSend.trace(logmsg(Op::ACK, version, serialized_key));
 					});
-				get_wire()->send(rdid, std::move(writer));
+				get_wire()->send(rdid, std::move(writer), lane);
 				if (is_master)
 				{
 					spdlog::get("logReceived")->error("Both ends are masters: {}", to_string(location));
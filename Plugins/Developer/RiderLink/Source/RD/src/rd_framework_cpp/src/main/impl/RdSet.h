@@ -74,7 +74,7 @@ public:
 					S::write(this->get_serialization_context(), buffer, v);
 
 					spdlog::get("logSend")->trace("SENDset {} {}:: {}:: {}", to_string(location), to_string(rdid), to_string(kind), to_string(v));
-				});
+				}, lane);
 			});
 		});
 
@@ -105,7 +105,7 @@ public:
 		get_wire()->send(rdid, [this, &value](Buffer& buffer) {
 			spdlog::get("logSend")->trace("SEND{}", logmsg(value));
 			S::write(get_serialization_context(), buffer, value);
-		});
+		}, lane, lossy);
 		signal.fire(value);
 	}
 
@@ -0,0 +1,234 @@
+#ifndef RD_CPP_RDSTREAM_H
+#define RD_CPP_RDSTREAM_H
+
+#include "lifetime/Lifetime.h"
+#include "scheduler/base/IScheduler.h"
+#include "reactive/base/SignalX.h"
+#include "base/RdReactiveBase.h"
+#include "protocol/ChunkReader.h"
+#include "protocol/ChunkWriter.h"
+#include "serialization/Polymorphic.h"
+#include "types/Void.h"
+
+#include <memory>
+#include <mutex>
+
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable : 4250)
+#endif
+
+namespace rd
+{
+/**
+ * \brief Reactive stream of values for connection through wire, for sequences too large to be sent as one message.
+ *
+ * The values written to a [Writer] are sent as one stream of chunks, see [ChunkWriter], so each side takes memory for
+ * about one chunk and the largest value however long the stream is. The handlers on the other side get every value as
+ * soon as the chunks holding it arrived. Messages are sent in [Lane::Bulk] unless [lane] is changed, and the wire
+ * scheduler has to run them in order. Chunks are never sent lossy, a lost one would corrupt every later value.
+ *
+ * \tparam T type of values
+ * \tparam S "SerDes" for values
+ */
+template <typename T, typename S = Polymorphic<T>>
+class RdStream final : public RdReactiveBase, public ISerializable
+{
+private:
+	mutable IScheduler* wire_scheduler{};
+
+	/**
+	 * \brief Held by the open [Writer], so the chunks of concurrent streams don't interleave.
+	 */
+	std::unique_ptr<std::mutex> send_lock = std::make_unique<std::mutex>();
+
+	mutable ChunkReader reader;
+
+	void set_wire_scheduler(IScheduler* scheduler) const
+	{
+		wire_scheduler = scheduler;
+	}
+
+protected:
+	Signal<T> signal;
+	Signal<Void> end_signal;
+
+public:
+	/**
+	 * \brief Sends one stream, it is finished by [close] or the destructor. The stream has to be closed before the
+	 * next one can be opened.
+	 */
+	class Writer
+	{
+		RdStream const* stream;
+		std::unique_lock<std::mutex> guard;
+		ChunkWriter chunks;
+
+	public:
+		// region ctor/dtor
+
+		explicit Writer(RdStream const* stream)
+			: stream(stream), guard(*stream->send_lock), chunks(stream->get_wire(), stream->rdid, stream->lane)
+		{
+		}
+
+		Writer(Writer&&) = default;
+
+		Writer& operator=(Writer&&) = delete;
+
+		~Writer()
+		{
+			close();
+		}
+		// endregion
+
+		void write(T const& value)
+		{
+			chunks.write([this, &value](Buffer& buffer) {
+				S::write(stream->get_serialization_context(), buffer, value);
+			});
+		}
+
+		/**
+		 * \brief Sends the values written so far without waiting for the current chunk to be filled.
+		 */
+		void flush()
+		{
+			chunks.flush();
+		}
+
+		void close()
+		{
+			if (guard.owns_lock())
+			{
+				chunks.finish();
+				guard.unlock();
+			}
+		}
+	};
+
+	// region ctor/dtor
+
+	RdStream(RdStream const&) = delete;
+
+	RdStream& operator=(RdStream const&) = delete;
+
+	RdStream()
+	{
+		lane = Lane::Bulk;
+	}
+
+	RdStream(RdStream&&) = default;
+
+	RdStream& operator=(RdStream&&) = default;
+
+	virtual ~RdStream() = default;
+	// endregion
+
+	static RdStream<T, S> read(SerializationCtx& /*ctx*/, Buffer& buffer)
+	{
+		RdStream<T, S> res;
+		const RdId& id = RdId::read(buffer);
+		withId(res, id);
+		return res;
+	}
+
+	void write(SerializationCtx& /*ctx*/, Buffer& buffer) const override
+	{
+		rdid.write(buffer);
+	}
+
+	void init(Lifetime lifetime) const override
+	{
+		RdReactiveBase::init(lifetime);
+		set_wire_scheduler(get_default_scheduler());
+		get_wire()->advise(lifetime, this);
+	}
+
+	void on_wire_received(Buffer buffer) const override
+	{
+		const bool last = reader.read(std::move(buffer), [this](Buffer& value_buffer) {
+			auto value = S::read(this->get_serialization_context(), value_buffer);
+			signal.fire(wrapper::get<T>(value));
+		});
+		if (last)
+		{
+			end_signal.fire(Void());
+		}
+	}
+
+	/**
+	 * \brief Limits the size of a received value, the stream fails on a larger one. Must be called before binding.
+	 */
+	void set_max_value_size(size_t max_size) const
+	{
+		reader.set_max_value_size(max_size);
+	}
+
+	/**
+	 * \brief Opens a stream to the counterpart, blocking while another one is open.
+	 */
+	Writer open() const
+	{
+		assert_bound();
+		if (!async)
+		{
+			assert_threading();
+		}
+		return Writer(this);
+	}
+
+	/**
+	 * \brief Adds a [handler] for the values received from the counterpart.
+	 */
+	void advise(Lifetime lifetime, std::function<void(T const&)> handler) const
+	{
+		if (is_bound())
+		{
+			assert_threading();
+		}
+		signal.advise(lifetime, std::move(handler));
+	}
+
+	/**
+	 * \brief Adds a [handler] called once a stream of the counterpart has been received completely.
+	 */
+	void advise_end(Lifetime lifetime, std::function<void()> handler) const
+	{
+		if (is_bound())
+		{
+			assert_threading();
+		}
+		end_signal.advise(lifetime, [handler = std::move(handler)](Void const&) { handler(); });
+	}
+
+	template <typename F>
+	void advise_on(Lifetime lifetime, IScheduler* scheduler, F&& handler)
+	{
+		if (is_bound())
+		{
+			assert_threading();
+		}
+		set_wire_scheduler(scheduler);
+		signal.advise(lifetime, std::forward<F>(handler));
+	}
+
+	IScheduler* get_wire_scheduler() const override
+	{
+		return wire_scheduler;
+	}
+
+	friend std::string to_string(RdStream const&)
+	{
+		return "";
+	}
+};
+}	 // namespace rd
+
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+static_assert(std::is_move_constructible<rd::RdStream<int>>::value, "Is not move constructible from RdStream<int>");
+
+#endif	  // RD_CPP_RDSTREAM_H
@@ -110,6 +110,7 @@ int32_t InternRoot::intern_value(Wrapper<T> value) const
 	int32_t index = 0;
 	if (it == inverse_map.end())
 	{
+		// interned values go first, so messages referring to them can be sent in any lane
 		get_protocol()->get_wire()->send(this->rdid, [this, &index, value, any](Buffer& buffer) {
 			InternedAnySerializer::write<T>(get_serialization_context(), buffer, wrapper::get<T>(value));
 			{
@@ -118,7 +119,7 @@ int32_t InternRoot::intern_value(Wrapper<T> value) const
 				my_items_lis.emplace_back(any);
 			}
 			buffer.write_integral<int32_t>(index);
-		});
+		}, Lane::Control);
 	}
 	else
 	{
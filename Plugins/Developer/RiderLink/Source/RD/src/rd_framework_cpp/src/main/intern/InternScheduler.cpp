@@ -17,6 +17,12 @@ void InternScheduler::queue(std::function<void()> action)
 	action();
 }
 
+void InternScheduler::queue(SchedulerTask task)
+{
+	util::increment_guard<int32_t> guard(active_counts);
+	task();
+}
+
 void InternScheduler::flush()
 {
 }
@@ -22,6 +22,8 @@ public:
 
 	void queue(std::function<void()> action) override;
 
+	void queue(SchedulerTask task) override;
+
 	void flush() override;
 
 	bool is_active() const override;
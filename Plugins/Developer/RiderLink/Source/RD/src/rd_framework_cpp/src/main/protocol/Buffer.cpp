@@ -20,6 +20,41 @@ Buffer::Buffer(ByteArray array, size_t offset) : data_(std::move(array)), offset
 {
 }
 
+Buffer::Buffer(std::shared_ptr<ByteArray const> block, size_t begin, size_t size)
+	: view_block_(std::move(block)), view_data_(view_block_->data() + begin), view_size_(size)
+{
+}
+
+void Buffer::detach()
+{
+	if (view_block_)
+	{
+		data_.assign(view_data_, view_data_ + view_size_);
+		view_block_.reset();
+		view_data_ = nullptr;
+		view_size_ = 0;
+	}
+}
+
+bool Buffer::is_view() const
+{
+	return view_block_ != nullptr;
+}
+
+Buffer Buffer::slice(size_t begin, size_t size) const
+{
+	if (begin + size > this->size())
+	{
+		throw std::out_of_range("Slice [" + std::to_string(begin) + ", " + std::to_string(begin + size) + ") exceeds buffer of " +
+								std::to_string(this->size()) + " bytes");
+	}
+	if (view_block_)
+	{
+		return Buffer(view_block_, static_cast<size_t>(view_data_ - view_block_->data()) + begin, size);
+	}
+	return Buffer(ByteArray(data_.begin() + begin, data_.begin() + begin + size));
+}
+
 size_t Buffer::get_position() const
 {
 	return offset;
@@ -44,7 +79,8 @@ void Buffer::read(word_t* dst, size_t size)
 	if (size == 0)
 		return;
 	check_available(size);
-	std::copy(&data_[offset], &data_[offset] + size, dst);
+	word_t const* src = static_cast<Buffer const&>(*this).data() + offset;
+	std::copy(src, src + size, dst);
 	offset += size;
 }
 
@@ -59,6 +95,7 @@ void Buffer::write(const word_t* src, size_t size)
 
 void Buffer::require_available(size_t moreSize)
 {
+	detach();
 	if (offset + moreSize >= size())
 	{
 		const size_t new_size = (std::max)(size() * 2, offset + moreSize);
@@ -73,11 +110,16 @@ void Buffer::rewind()
 
 Buffer::ByteArray Buffer::getArray() const&
 {
+	if (view_block_)
+	{
+		return ByteArray(view_data_, view_data_ + view_size_);
+	}
 	return data_;
 }
 
 Buffer::ByteArray Buffer::getArray() &&
 {
+	detach();
 	rewind();
 	return std::move(data_);
 }
@@ -91,6 +133,7 @@ Buffer::ByteArray Buffer::getRealArray() const&
 
 Buffer::ByteArray Buffer::getRealArray() &&
 {
+	detach();
 	auto res = std::move(data_);
 	res.resize(offset);
 	rewind();
@@ -99,11 +142,12 @@ Buffer::ByteArray Buffer::getRealArray() &&
 
 Buffer::word_t const* Buffer::data() const
 {
-	return data_.data();
+	return view_block_ ? view_data_ : data_.data();
 }
 
 Buffer::word_t* Buffer::data()
 {
+	detach();
 	return data_.data();
 }
 
@@ -119,7 +163,7 @@ Buffer::word_t* Buffer::current_pointer()
 
 size_t Buffer::size() const
 {
-	return data_.size();
+	return view_block_ ? view_size_ : data_.size();
 }
 
 /*std::string Buffer::readString() const {
@@ -257,6 +301,7 @@ void Buffer::write_byte_array_raw(const ByteArray& array)
 
 Buffer::ByteArray& Buffer::get_data()
 {
+	detach();
 	return data_;
 }
 }	 // namespace rd
@@ -27,7 +27,9 @@ namespace rd
 class RD_FRAMEWORK_API Buffer final
 {
 public:
-	friend class PkgInputStream;
+	friend class ChunkWriter;
+
+	friend class ChunkReader;
 
 	using word_t = uint8_t;
 
@@ -44,8 +46,20 @@ private:
 
 	ByteArray data_;
 
+	/**
+	 * \brief Block a view points into, null for buffers owning their data.
+	 */
+	std::shared_ptr<ByteArray const> view_block_;
+	word_t const* view_data_ = nullptr;
+	size_t view_size_ = 0;
+
 	size_t offset = 0;
 
+	/**
+	 * \brief Turns a view into a buffer owning a copy of the viewed bytes, called before anything may modify the data.
+	 */
+	void detach();
+
 	// read
 	void read(word_t* dst, size_t size);
 
@@ -63,6 +77,12 @@ public:
 
 	explicit Buffer(ByteArray array, size_t offset = 0);
 
+	/**
+	 * \brief Creates a read-only view of [size] bytes of [block] starting at [begin], nothing is copied.
+	 * The view keeps [block] alive and copies the bytes on the first modifying access.
+	 */
+	Buffer(std::shared_ptr<ByteArray const> block, size_t begin, size_t size);
+
 	Buffer(Buffer const&) = delete;
 
 	Buffer& operator=(Buffer const&) = delete;
@@ -83,6 +103,13 @@ public:
 
 	void rewind();
 
+	bool is_view() const;
+
+	/**
+	 * \brief Buffer over [size] bytes starting at [begin], it shares the block if this is a view and copies otherwise.
+	 */
+	Buffer slice(size_t begin, size_t size) const;
+
 	template <typename T, typename = typename std::enable_if_t<std::is_integral<T>::value, T>>
 	T read_integral()
 	{
@@ -0,0 +1,102 @@
+#include "protocol/ChunkReader.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace rd
+{
+namespace
+{
+constexpr size_t LENGTH_SIZE = sizeof(int32_t);
+}	 // namespace
+
+size_t ChunkReader::read_length(Buffer::word_t const* data)
+{
+	int32_t length = 0;
+	memcpy(&length, data, sizeof(length));
+	const bool valid = length >= 0 && static_cast<size_t>(length) <= max_value_size;
+	if (!valid)
+	{
+		failed = true;
+		pending_size = 0;
+	}
+	RD_ASSERT_THROW_MSG(valid, "invalid length of a chunked value: " + std::to_string(length));
+	return static_cast<size_t>(length);
+}
+
+void ChunkReader::set_max_value_size(size_t max_size)
+{
+	max_value_size = max_size;
+}
+
+bool ChunkReader::start(Buffer& chunk)
+{
+	const auto flags = chunk.read_integral<uint8_t>();
+	if ((flags & ChunkWriter::FIRST_CHUNK) != 0)
+	{
+		// a stream cut off before its last chunk leaves part of a value behind
+		pending_size = 0;
+		failed = false;
+	}
+	return (flags & ChunkWriter::LAST_CHUNK) != 0;
+}
+
+optional<Buffer> ChunkReader::next(Buffer& chunk)
+{
+	Buffer const& input = chunk;
+	if (failed)
+	{
+		return nullopt;
+	}
+	if (pending_size == 0)
+	{
+		const size_t position = chunk.get_position();
+		const size_t available = input.size() - position;
+		if (available == 0)
+		{
+			return nullopt;
+		}
+		if (available >= LENGTH_SIZE)
+		{
+			const size_t length = read_length(input.data() + position);
+			if (available - LENGTH_SIZE >= length)
+			{
+				chunk.set_position(position + LENGTH_SIZE + length);
+				return input.slice(position + LENGTH_SIZE, length);
+			}
+		}
+		if (!pending || pending.use_count() != 1)
+		{
+			pending = std::make_shared<Buffer::ByteArray>(ChunkWriter::CHUNK_SIZE);
+		}
+	}
+
+	// the value is split between chunks, gather its bytes until it is complete
+	while (true)
+	{
+		size_t wanted = LENGTH_SIZE;
+		if (pending_size >= LENGTH_SIZE)
+		{
+			wanted += read_length(pending->data());
+			if (pending_size == wanted)
+			{
+				pending_size = 0;
+				return Buffer(pending, LENGTH_SIZE, wanted - LENGTH_SIZE);
+			}
+		}
+		const size_t position = chunk.get_position();
+		const size_t n = (std::min)(wanted - pending_size, input.size() - position);
+		if (n == 0)
+		{
+			return nullopt;
+		}
+		if (pending->size() < wanted)
+		{
+			pending->resize(wanted);
+		}
+		memcpy(pending->data() + pending_size, input.data() + position, n);
+		pending_size += n;
+		chunk.set_position(position + n);
+	}
+}
+}	 // namespace rd
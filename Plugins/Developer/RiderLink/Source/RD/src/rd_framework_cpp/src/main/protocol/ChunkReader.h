@@ -0,0 +1,94 @@
+#ifndef RD_CPP_CHUNKREADER_H
+#define RD_CPP_CHUNKREADER_H
+
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable:4251)
+#endif
+
+#include "base/IWire.h"
+#include "protocol/Buffer.h"
+#include "protocol/ChunkWriter.h"
+
+#include <memory>
+
+#include <rd_framework_export.h>
+
+namespace rd
+{
+/**
+ * \brief Reads the values of a stream sent by [ChunkWriter] from its chunks as they are received.
+ *
+ * Values lying within a chunk are passed on as views of it. Only values split between chunks are gathered in a buffer
+ * of [ChunkWriter::CHUNK_SIZE] bytes, which grows for values larger than that up to [max_value_size].
+ */
+class RD_FRAMEWORK_API ChunkReader
+{
+	/**
+	 * \brief Bytes of the value split between chunks received so far, its length included. A block still referred to
+	 * by a passed on value is replaced instead of being overwritten.
+	 */
+	std::shared_ptr<Buffer::ByteArray> pending;
+	size_t pending_size = 0;
+	size_t max_value_size = IWire::DEFAULT_MAX_MESSAGE_SIZE;
+	/**
+	 * \brief Set by an invalid length, the rest of the stream is skipped as its values can't be told apart anymore.
+	 */
+	bool failed = false;
+
+	/**
+	 * \brief Reads the length prefix of a value at [data], fails the stream if it is negative or exceeds
+	 * [max_value_size].
+	 */
+	size_t read_length(Buffer::word_t const* data);
+
+	/**
+	 * \brief Reads the flags of [chunk].
+	 * \return whether it is the last chunk of its stream
+	 */
+	bool start(Buffer& chunk);
+
+	/**
+	 * \brief Takes the next value completed by [chunk].
+	 * \return the value, none once the rest of [chunk] belongs to a value continued in the next chunk
+	 */
+	optional<Buffer> next(Buffer& chunk);
+
+public:
+	// region ctor/dtor
+
+	ChunkReader() = default;
+
+	ChunkReader(ChunkReader const&) = delete;
+
+	ChunkReader& operator=(ChunkReader const&) = delete;
+
+	ChunkReader(ChunkReader&&) = default;
+
+	ChunkReader& operator=(ChunkReader&&) = default;
+	// endregion
+
+	void set_max_value_size(size_t max_size);
+
+	/**
+	 * \brief Passes every value completed by [chunk] to [reader], as a buffer holding exactly the value.
+	 * The first chunk of a stream discards whatever is left of the previous one.
+	 * \return whether [chunk] was the last chunk of its stream
+	 */
+	template <typename F>
+	bool read(Buffer chunk, F&& reader)
+	{
+		const bool last = start(chunk);
+		while (optional<Buffer> value = next(chunk))
+		{
+			reader(*value);
+		}
+		return last;
+	}
+};
+}	 // namespace rd
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+#endif	  // RD_CPP_CHUNKREADER_H
@@ -0,0 +1,67 @@
+#include "protocol/ChunkWriter.h"
+
+#include "base/IWire.h"
+
+#include <cstring>
+
+namespace rd
+{
+constexpr uint8_t ChunkWriter::FIRST_CHUNK;
+constexpr uint8_t ChunkWriter::LAST_CHUNK;
+constexpr size_t ChunkWriter::CHUNK_SIZE;
+
+ChunkWriter::ChunkWriter(IWire const* wire, RdId id, Lane lane) : wire(wire), id(std::move(id)), lane(lane)
+{
+	RD_ASSERT_MSG(!this->id.isNull(), "id mustn't be null");
+}
+
+void ChunkWriter::send_chunk(size_t begin, size_t size, uint8_t flags)
+{
+	Buffer::word_t const* data = static_cast<Buffer const&>(buffer).data() + begin;
+	// wires serialize messages right away, so the chunk is copied before the buffer changes
+	wire->send(
+		id,
+		[data, size, flags](Buffer& message) {
+			message.write_integral<uint8_t>(flags);
+			message.write(data, size);
+		},
+		lane);
+}
+
+void ChunkWriter::send_full_chunks()
+{
+	const size_t size = buffer.get_position();
+	size_t begin = 0;
+	for (; size - begin >= CHUNK_SIZE; begin += CHUNK_SIZE)
+	{
+		send_chunk(begin, CHUNK_SIZE, next_flags);
+		next_flags = 0;
+	}
+	memmove(buffer.data(), buffer.data() + begin, size - begin);
+	buffer.set_position(size - begin);
+}
+
+void ChunkWriter::flush()
+{
+	RD_ASSERT_MSG(!finished, "flush of a finished chunk stream");
+	if (buffer.get_position() == 0)
+	{
+		return;
+	}
+	send_chunk(0, buffer.get_position(), next_flags);
+	next_flags = 0;
+	buffer.rewind();
+}
+
+void ChunkWriter::finish()
+{
+	if (finished)
+	{
+		return;
+	}
+	finished = true;
+	// the buffer never holds a full chunk between writes, an empty stream consists of just this chunk
+	send_chunk(0, buffer.get_position(), next_flags | LAST_CHUNK);
+	buffer.rewind();
+}
+}	 // namespace rd
@@ -0,0 +1,107 @@
+#ifndef RD_CPP_CHUNKWRITER_H
+#define RD_CPP_CHUNKWRITER_H
+
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable:4251)
+#endif
+
+#include "protocol/Buffer.h"
+#include "protocol/RdId.h"
+#include "base/Lane.h"
+
+#include <rd_framework_export.h>
+
+namespace rd
+{
+// region predeclared
+
+class IWire;
+// endregion
+
+/**
+ * \brief Sends a stream of values to the entity with the given id as a sequence of messages of at most [CHUNK_SIZE]
+ * bytes each, so no side has to hold the whole stream at once.
+ *
+ * A chunk starts with its flags followed by the next bytes of the stream, in which every value is preceded by its
+ * length. Values are serialized into a buffer which is sent whenever it holds a full chunk, so a value may be split
+ * between chunks. The buffer takes about [CHUNK_SIZE] bytes, only values larger than that grow it. [ChunkReader] reads
+ * the values back.
+ */
+class RD_FRAMEWORK_API ChunkWriter
+{
+public:
+	static constexpr uint8_t FIRST_CHUNK = 1;
+	static constexpr uint8_t LAST_CHUNK = 2;
+	/**
+	 * \brief Keeps chunks below the size up to which wires dispatch received messages without copying them.
+	 */
+	static constexpr size_t CHUNK_SIZE = 16 * 1024;
+
+private:
+	IWire const* wire = nullptr;
+	RdId id;
+	Lane lane = Lane::Bulk;
+
+	Buffer buffer{CHUNK_SIZE};
+	uint8_t next_flags = FIRST_CHUNK;
+	bool finished = false;
+
+	void send_chunk(size_t begin, size_t size, uint8_t flags);
+
+	/**
+	 * \brief Sends all full chunks of the buffer and moves the rest to its start.
+	 */
+	void send_full_chunks();
+
+public:
+	// region ctor/dtor
+
+	ChunkWriter(IWire const* wire, RdId id, Lane lane);
+
+	ChunkWriter(ChunkWriter const&) = delete;
+
+	ChunkWriter& operator=(ChunkWriter const&) = delete;
+
+	ChunkWriter(ChunkWriter&&) = default;
+
+	ChunkWriter& operator=(ChunkWriter&&) = default;
+	// endregion
+
+	/**
+	 * \brief Writes one value by [writer] and sends the chunks it completed.
+	 */
+	template <typename F>
+	void write(F&& writer)
+	{
+		RD_ASSERT_MSG(!finished, "write to a finished chunk stream");
+		const size_t length_position = buffer.get_position();
+		buffer.write_integral<int32_t>(0);	  // placeholder for length
+		writer(buffer);
+		const size_t end = buffer.get_position();
+		buffer.set_position(length_position);
+		buffer.write_integral<int32_t>(static_cast<int32_t>(end - length_position - sizeof(int32_t)));
+		buffer.set_position(end);
+		if (end >= CHUNK_SIZE)
+		{
+			send_full_chunks();
+		}
+	}
+
+	/**
+	 * \brief Sends the buffered bytes right away as a short chunk, so the values written so far are received without
+	 * waiting for the chunk to be filled.
+	 */
+	void flush();
+
+	/**
+	 * \brief Sends the buffered bytes as the last chunk of the stream, nothing may be written afterwards.
+	 */
+	void finish();
+};
+}	 // namespace rd
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+#endif	  // RD_CPP_CHUNKWRITER_H
@@ -22,12 +22,7 @@ void MessageBroker::invoke(const IRdReactive* that, Buffer msg, bool sync) const
 	else
 	{
 		auto action = [this, that, message = std::move(msg)]() mutable {
-			bool exists_id = false;
-			{
-				std::lock_guard<decltype(lock)> guard(lock);
-				exists_id = subscriptions.count(that->rdid) > 0;
-			}
-			if (exists_id)
+			if (subscriptions.find(that->rdid) != nullptr)
 			{
 				execute(that, std::move(message));
 			}
@@ -36,8 +31,8 @@ void MessageBroker::invoke(const IRdReactive* that, Buffer msg, bool sync) const
 				logger->trace("Disappeared Handler for Reactive entities with id: {}", to_string(that->rdid));
 			}
 		};
-		std::function<void()> function = util::make_shared_function(std::move(action));
-		that->get_wire_scheduler()->queue(std::move(function));
+		IScheduler* scheduler = that->get_wire_scheduler();
+		scheduler->queue(scheduler->make_task(std::move(action)));
 	}
 }
 
@@ -49,9 +44,15 @@ void MessageBroker::dispatch(RdId id, Buffer message) const
 {
 	RD_ASSERT_MSG(!id.isNull(), "id mustn't be null")
 
+	IRdReactive const* s = subscriptions.find(id);
+	if (s != nullptr && (s->get_wire_scheduler() == default_scheduler || s->get_wire_scheduler()->out_of_order_execution))
+	{
+		invoke(s, std::move(message));
+		return;
+	}
+
 	{	 // synchronized recursively
 		std::lock_guard<decltype(lock)> guard(lock);
-		IRdReactive const* s = subscriptions[id];
 		if (s == nullptr)
 		{
 			auto it = broker.find(id);
@@ -60,19 +61,19 @@ void MessageBroker::dispatch(RdId id, Buffer message) const
 				it = broker.emplace(id, Mq{}).first;
 			}
 
-			broker[id].default_scheduler_messages.emplace(std::move(message));
+			it->second.default_scheduler_messages.emplace(std::move(message));
 
-			auto action = [this, it, id]() mutable {
-				auto& current = it->second;
-				IRdReactive const* subscription = subscriptions[id];
+			auto action = [this, id]() mutable {
+				IRdReactive const* subscription = subscriptions.find(id);
 
 				optional<Buffer> message;
 				{
 					std::lock_guard<decltype(lock)> guard(lock);
-					if (!current.default_scheduler_messages.empty())
+					auto it = broker.find(id);
+					if (it != broker.end() && !it->second.default_scheduler_messages.empty())
 					{
-						message = make_optional<Buffer>(std::move(current.default_scheduler_messages.front()));
-						current.default_scheduler_messages.pop();
+						message = make_optional<Buffer>(std::move(it->second.default_scheduler_messages.front()));
+						it->second.default_scheduler_messages.pop();
 					}
 				}
 				if (subscription != nullptr)
@@ -87,44 +88,40 @@ void MessageBroker::dispatch(RdId id, Buffer message) const
 					logger->trace("No handler for id: {}", to_string(id));
 				}
 
-				if (current.default_scheduler_messages.empty())
+				// drained under the lock, so messages dispatched meanwhile are queued after these
+				std::lock_guard<decltype(lock)> guard(lock);
+				auto it = broker.find(id);
+				if (it != broker.end() && it->second.default_scheduler_messages.empty())
 				{
-					auto t = std::move(broker[id]);
-					broker.erase(id);
-					for (auto& it : t.custom_scheduler_messages)
+					auto t = std::move(it->second);
+					broker.erase(it);
+					if (subscription != nullptr)
 					{
-						RD_ASSERT_MSG(subscription->get_wire_scheduler() != default_scheduler,
-							"require equals of wire and default schedulers")
-						invoke(subscription, std::move(it));
+						for (auto& custom_message : t.custom_scheduler_messages)
+						{
+							RD_ASSERT_MSG(subscription->get_wire_scheduler() != default_scheduler,
+								"require equals of wire and default schedulers")
+							invoke(subscription, std::move(custom_message));
+						}
 					}
 				}
 			};
-			std::function<void()> function = util::make_shared_function(std::move(action));
-			default_scheduler->queue(std::move(function));
+			default_scheduler->queue(default_scheduler->make_task(std::move(action)));
 		}
 		else
 		{
-			if (s->get_wire_scheduler() == default_scheduler || s->get_wire_scheduler()->out_of_order_execution)
+			auto it = broker.find(id);
+			if (it == broker.end())
 			{
 				invoke(s, std::move(message));
 			}
 			else
 			{
-				auto it = broker.find(id);
-				if (it == broker.end())
-				{
-					invoke(s, std::move(message));
-				}
-				else
-				{
-					Mq& mq = it->second;
-					mq.custom_scheduler_messages.push_back(std::move(message));
-				}
+				Mq& mq = it->second;
+				mq.custom_scheduler_messages.push_back(std::move(message));
 			}
 		}
 	}
-
-	//        }
 }
 
 void MessageBroker::advise_on(Lifetime lifetime, IRdReactive const* entity) const
@@ -134,12 +131,10 @@ void MessageBroker::advise_on(Lifetime lifetime, IRdReactive const* entity) cons
 	// advise MUST happen under default scheduler, not custom
 	default_scheduler->assert_thread();
 
-	std::lock_guard<decltype(lock)> guard(lock);
 	if (!lifetime->is_terminated())
 	{
 		auto key = entity->rdid;
-		IRdReactive const* value = entity;
-		subscriptions[key] = value;
+		subscriptions.insert(key, entity);
 		lifetime->add_action([this, key]() { subscriptions.erase(key); });
 	}
 }
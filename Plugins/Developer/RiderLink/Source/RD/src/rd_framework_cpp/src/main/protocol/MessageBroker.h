@@ -7,6 +7,7 @@
 #endif
 
 #include "base/IRdReactive.h"
+#include "protocol/SubscriptionRegistry.h"
 
 #include "std/unordered_map.h"
 
@@ -42,9 +43,13 @@ class RD_FRAMEWORK_API MessageBroker final
 {
 private:
 	IScheduler* default_scheduler = nullptr;
-	mutable rd::unordered_map<RdId, IRdReactive const*> subscriptions;
+	mutable SubscriptionRegistry subscriptions;
 	mutable rd::unordered_map<RdId, Mq> broker;
 
+	/**
+	 * \brief Guards [broker], messages for subscribed entities are dispatched without it unless they have to be
+	 * ordered after messages still queued there.
+	 */
 	mutable std::recursive_mutex lock;
 
 	static std::shared_ptr<spdlog::logger> logger;
@@ -0,0 +1,177 @@
+#include "protocol/SubscriptionRegistry.h"
+
+namespace rd
+{
+constexpr RdId::hash_t SubscriptionRegistry::NO_ID;
+constexpr size_t SubscriptionRegistry::MIN_CAPACITY;
+
+SubscriptionRegistry::Table::Table(size_t capacity) : mask(capacity - 1), slots(new Slot[capacity])
+{
+}
+
+SubscriptionRegistry::SubscriptionRegistry() : current(new Table(MIN_CAPACITY)), table(current.get())
+{
+}
+
+SubscriptionRegistry::~SubscriptionRegistry() = default;
+
+size_t SubscriptionRegistry::index_of(RdId::hash_t id, size_t mask)
+{
+	// ids of statics are small consecutive numbers, spread them over the table
+	return static_cast<size_t>((static_cast<uint64_t>(id) * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+}
+
+IRdReactive const* SubscriptionRegistry::find(RdId const& id) const
+{
+	const RdId::hash_t key = id.get_hash();
+	readers.fetch_add(1);
+	Table const* t = table.load();
+	IRdReactive const* result = nullptr;
+	for (size_t i = index_of(key, t->mask);; i = (i + 1) & t->mask)
+	{
+		Slot const& slot = t->slots[i];
+		const RdId::hash_t slot_id = slot.id.load(std::memory_order_acquire);
+		if (slot_id == key)
+		{
+			IRdReactive const* entity = slot.entity.load(std::memory_order_acquire);
+			// the slot may have been taken over by another id meanwhile
+			if (slot.id.load(std::memory_order_acquire) == key)
+			{
+				result = entity;
+			}
+			break;
+		}
+		if (slot_id == NO_ID)
+		{
+			break;
+		}
+	}
+	readers.fetch_sub(1);
+	return result;
+}
+
+void SubscriptionRegistry::insert(RdId const& id, IRdReactive const* entity)
+{
+	const RdId::hash_t key = id.get_hash();
+	std::lock_guard<std::mutex> guard(write_lock);
+	while (true)
+	{
+		Table& t = *current;
+		Slot* removed = nullptr;
+		size_t i = index_of(key, t.mask);
+		for (;; i = (i + 1) & t.mask)
+		{
+			Slot& slot = t.slots[i];
+			const RdId::hash_t slot_id = slot.id.load(std::memory_order_relaxed);
+			if (slot_id == key)
+			{
+				if (slot.entity.load(std::memory_order_relaxed) == nullptr)
+				{
+					++live;
+				}
+				slot.entity.store(entity, std::memory_order_release);
+				free_retired();
+				return;
+			}
+			if (slot_id == NO_ID)
+			{
+				break;
+			}
+			if (removed == nullptr && slot.entity.load(std::memory_order_relaxed) == nullptr)
+			{
+				removed = &slot;
+			}
+		}
+
+		if (removed != nullptr)
+		{
+			// the id goes first, so lookups of the previous one see the change once they see the new entity
+			removed->id.store(key, std::memory_order_release);
+			removed->entity.store(entity, std::memory_order_release);
+		}
+		else if ((t.taken + 1) * 2 > t.mask + 1)
+		{
+			rebuild(live + 1);
+			continue;
+		}
+		else
+		{
+			Slot& slot = t.slots[i];
+			slot.entity.store(entity, std::memory_order_relaxed);
+			slot.id.store(key, std::memory_order_release);
+			++t.taken;
+		}
+		++live;
+		free_retired();
+		return;
+	}
+}
+
+void SubscriptionRegistry::erase(RdId const& id)
+{
+	const RdId::hash_t key = id.get_hash();
+	std::lock_guard<std::mutex> guard(write_lock);
+	Table& t = *current;
+	for (size_t i = index_of(key, t.mask);; i = (i + 1) & t.mask)
+	{
+		Slot& slot = t.slots[i];
+		const RdId::hash_t slot_id = slot.id.load(std::memory_order_relaxed);
+		if (slot_id == key)
+		{
+			if (slot.entity.load(std::memory_order_relaxed) != nullptr)
+			{
+				slot.entity.store(nullptr, std::memory_order_release);
+				--live;
+			}
+			break;
+		}
+		if (slot_id == NO_ID)
+		{
+			break;
+		}
+	}
+	free_retired();
+}
+
+void SubscriptionRegistry::rebuild(size_t expected)
+{
+	size_t capacity = MIN_CAPACITY;
+	while (capacity < expected * 4)
+	{
+		capacity *= 2;
+	}
+
+	std::unique_ptr<Table> next(new Table(capacity));
+	for (size_t i = 0; i <= current->mask; ++i)
+	{
+		Slot const& slot = current->slots[i];
+		IRdReactive const* entity = slot.entity.load(std::memory_order_relaxed);
+		if (entity == nullptr)
+		{
+			continue;
+		}
+		const RdId::hash_t key = slot.id.load(std::memory_order_relaxed);
+		size_t j = index_of(key, next->mask);
+		while (next->slots[j].id.load(std::memory_order_relaxed) != NO_ID)
+		{
+			j = (j + 1) & next->mask;
+		}
+		next->slots[j].id.store(key, std::memory_order_relaxed);
+		next->slots[j].entity.store(entity, std::memory_order_relaxed);
+		++next->taken;
+	}
+
+	table.store(next.get());
+	retired.push_back(std::move(current));
+	current = std::move(next);
+}
+
+void SubscriptionRegistry::free_retired()
+{
+	// lookups count themselves in before loading the table, none running means none can see a retired one anymore
+	if (!retired.empty() && readers.load() == 0)
+	{
+		retired.clear();
+	}
+}
+}	 // namespace rd
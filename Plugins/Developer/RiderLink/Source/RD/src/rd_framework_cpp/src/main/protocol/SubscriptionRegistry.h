@@ -0,0 +1,108 @@
+#ifndef RD_CPP_SUBSCRIPTIONREGISTRY_H
+#define RD_CPP_SUBSCRIPTIONREGISTRY_H
+
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable:4251)
+#endif
+
+#include "protocol/RdId.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <rd_framework_export.h>
+
+namespace rd
+{
+// region predeclared
+
+class IRdReactive;
+// endregion
+
+/**
+ * \brief Entities subscribed to messages by their ids, looked up by every received message while entities come and go.
+ *
+ * An open addressing table of atomic slots probed linearly. Lookups take no lock and never modify the table, changes
+ * are serialized by a mutex. A removed entity leaves its id behind, the slot is taken over by a later id probing past
+ * it. Once the taken slots fill half of the table it is rebuilt from the live entries, the previous table is freed as
+ * soon as no lookup is running.
+ */
+class RD_FRAMEWORK_API SubscriptionRegistry final
+{
+	/**
+	 * \brief Id of the slots never taken, ids of entities are never null.
+	 */
+	static constexpr RdId::hash_t NO_ID = RdId::Null().get_hash();
+
+	struct Slot
+	{
+		std::atomic<RdId::hash_t> id{NO_ID};
+		std::atomic<IRdReactive const*> entity{nullptr};
+	};
+
+	struct Table
+	{
+		explicit Table(size_t capacity);
+
+		const size_t mask;
+		std::unique_ptr<Slot[]> slots;
+		/**
+		 * \brief Slots holding an id, live or removed, changed under [write_lock] only.
+		 */
+		size_t taken = 0;
+	};
+
+	static constexpr size_t MIN_CAPACITY = 64;
+
+	std::unique_ptr<Table> current;
+	std::atomic<Table*> table;
+	std::vector<std::unique_ptr<Table>> retired;
+	size_t live = 0;
+
+	mutable std::atomic<int32_t> readers{0};
+	std::mutex write_lock;
+
+	static size_t index_of(RdId::hash_t id, size_t mask);
+
+	/**
+	 * \brief Replaces the table by one holding the live entries with room for [expected] of them.
+	 */
+	void rebuild(size_t expected);
+
+	void free_retired();
+
+public:
+	// region ctor/dtor
+
+	SubscriptionRegistry();
+
+	SubscriptionRegistry(SubscriptionRegistry const&) = delete;
+
+	SubscriptionRegistry& operator=(SubscriptionRegistry const&) = delete;
+
+	~SubscriptionRegistry();
+	// endregion
+
+	/**
+	 * \brief Lock-free lookup of the entity subscribed with [id].
+	 * \return the entity, nullptr if there is none
+	 */
+	IRdReactive const* find(RdId const& id) const;
+
+	/**
+	 * \brief Subscribes [entity] with [id], replacing the entity subscribed with it before.
+	 */
+	void insert(RdId const& id, IRdReactive const* entity);
+
+	void erase(RdId const& id);
+};
+}	 // namespace rd
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+#endif	  // RD_CPP_SUBSCRIPTIONREGISTRY_H
@@ -11,6 +11,11 @@ void SimpleScheduler::queue(std::function<void()> action)
 	action();
 }
 
+void SimpleScheduler::queue(SchedulerTask task)
+{
+	task();
+}
+
 bool SimpleScheduler::is_active() const
 {
 	return true;
@@ -23,6 +23,8 @@ public:
 
 	void queue(std::function<void()> action) override;
 
+	void queue(SchedulerTask task) override;
+
 	bool is_active() const override;
 };
 }	 // namespace rd
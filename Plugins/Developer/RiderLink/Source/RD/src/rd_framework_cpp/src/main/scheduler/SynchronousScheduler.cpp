@@ -12,6 +12,12 @@ void SynchronousScheduler::queue(std::function<void()> action)
 	action();
 }
 
+void SynchronousScheduler::queue(SchedulerTask task)
+{
+	util::increment_guard<int32_t> guard(SynchronousScheduler_active_count);
+	task();
+}
+
 void SynchronousScheduler::flush()
 {
 }
@@ -1,5 +1,7 @@
 #include "IScheduler.h"
 
+#include "util/shared_function.h"
+
 #include "spdlog/spdlog.h"
 
 #include <functional>
@@ -17,6 +19,11 @@ void IScheduler::assert_thread() const
 	}
 }
 
+void IScheduler::queue(SchedulerTask task)
+{
+	queue(std::function<void()>(util::make_shared_function(std::move(task))));
+}
+
 void IScheduler::invoke_or_queue(std::function<void()> action)
 {
 	if (is_active())
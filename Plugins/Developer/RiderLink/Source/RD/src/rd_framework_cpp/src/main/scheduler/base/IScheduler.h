@@ -6,6 +6,8 @@
 #pragma warning(disable:4251)
 #endif
 
+#include "scheduler/base/SchedulerTask.h"
+
 #include <functional>
 #include <thread>
 
@@ -21,6 +23,9 @@ class RD_FRAMEWORK_API IScheduler
 protected:
 	std::thread::id thread_id;
 
+private:
+	SchedulerTaskPool task_pool;
+
 public:
 	// region ctor/dtor
 
@@ -36,6 +41,23 @@ public:
 	 */
 	virtual void queue(std::function<void()> action) = 0;
 
+	/**
+	 * \brief Queues the execution of [task], see [make_task]. Schedulers running the tasks themselves do it without
+	 * allocating, the others run it as a function.
+	 *
+	 * \param task to be queued.
+	 */
+	virtual void queue(SchedulerTask task);
+
+	/**
+	 * \brief Makes a task of [action] with a node of this scheduler's freelist.
+	 */
+	template <typename F>
+	SchedulerTask make_task(F&& action)
+	{
+		return task_pool.make(std::forward<F>(action));
+	}
+
 	// todo
 	bool out_of_order_execution = false;
 
@@ -0,0 +1,104 @@
+#include "SchedulerTask.h"
+
+namespace rd
+{
+constexpr size_t SchedulerTask::STORAGE_SIZE;
+constexpr size_t SchedulerTaskPool::MAX_FREE;
+
+SchedulerTask::SchedulerTask(Node* node) : node(node)
+{
+}
+
+SchedulerTask::SchedulerTask(SchedulerTask&& other) noexcept : node(other.node)
+{
+	other.node = nullptr;
+}
+
+SchedulerTask& SchedulerTask::operator=(SchedulerTask&& other) noexcept
+{
+	if (this != &other)
+	{
+		reset();
+		node = other.node;
+		other.node = nullptr;
+	}
+	return *this;
+}
+
+SchedulerTask::~SchedulerTask()
+{
+	reset();
+}
+
+SchedulerTask::operator bool() const
+{
+	return node != nullptr;
+}
+
+void SchedulerTask::operator()()
+{
+	node->invoke(*node);
+}
+
+SchedulerTask::Node* SchedulerTask::release()
+{
+	Node* result = node;
+	node = nullptr;
+	return result;
+}
+
+void SchedulerTask::reset()
+{
+	if (node != nullptr)
+	{
+		node->destroy(*node);
+		node->pool->release(node);
+		node = nullptr;
+	}
+}
+
+SchedulerTaskPool::~SchedulerTaskPool()
+{
+	while (free != nullptr)
+	{
+		SchedulerTask::Node* next = free->next;
+		delete free;
+		free = next;
+	}
+}
+
+SchedulerTask::Node* SchedulerTaskPool::acquire()
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		if (free != nullptr)
+		{
+			SchedulerTask::Node* node = free;
+			free = node->next;
+			--free_count;
+			node->next = nullptr;
+			return node;
+		}
+	}
+	auto* node = new SchedulerTask::Node;
+	node->pool = this;
+	return node;
+}
+
+void SchedulerTaskPool::release(SchedulerTask::Node* node)
+{
+	node->invoke = nullptr;
+	node->destroy = nullptr;
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		if (free_count < MAX_FREE)
+		{
+			node->next = free;
+			free = node;
+			++free_count;
+			return;
+		}
+	}
+	delete node;
+}
+}	 // namespace rd
@@ -0,0 +1,146 @@
+#ifndef RD_CPP_SCHEDULERTASK_H
+#define RD_CPP_SCHEDULERTASK_H
+
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable:4251)
+#endif
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <rd_framework_export.h>
+
+namespace rd
+{
+// region predeclared
+
+class SchedulerTaskPool;
+// endregion
+
+/**
+ * \brief Move-only action to be queued to a scheduler, owning an intrusive node drawn from a [SchedulerTaskPool].
+ *
+ * Actions of up to [STORAGE_SIZE] bytes are stored within the node, only larger ones are allocated. Dropping the task
+ * returns its node to the pool it was drawn from, so a task must not outlive the scheduler that made it.
+ */
+class RD_FRAMEWORK_API SchedulerTask
+{
+public:
+	static constexpr size_t STORAGE_SIZE = 96;
+
+	struct Node
+	{
+		alignas(std::max_align_t) unsigned char storage[STORAGE_SIZE];
+		void (*invoke)(Node& node) = nullptr;
+		void (*destroy)(Node& node) = nullptr;
+		/**
+		 * \brief Link within the freelist of [pool] or within the queue of a scheduler.
+		 */
+		Node* next = nullptr;
+		SchedulerTaskPool* pool = nullptr;
+	};
+
+private:
+	Node* node = nullptr;
+
+public:
+	// region ctor/dtor
+
+	SchedulerTask() = default;
+
+	/**
+	 * \brief Takes the ownership of [node], which holds an action.
+	 */
+	explicit SchedulerTask(Node* node);
+
+	SchedulerTask(SchedulerTask const&) = delete;
+
+	SchedulerTask& operator=(SchedulerTask const&) = delete;
+
+	SchedulerTask(SchedulerTask&& other) noexcept;
+
+	SchedulerTask& operator=(SchedulerTask&& other) noexcept;
+
+	~SchedulerTask();
+	// endregion
+
+	explicit operator bool() const;
+
+	void operator()();
+
+	/**
+	 * \brief Gives up the ownership of the node, e.g. to link it into the queue of a scheduler.
+	 */
+	Node* release();
+
+	void reset();
+};
+
+/**
+ * \brief Freelist of the nodes of [SchedulerTask], a node is allocated only while none is free. At most [MAX_FREE]
+ * nodes are kept, the ones returned beyond are freed.
+ */
+class RD_FRAMEWORK_API SchedulerTaskPool
+{
+	static constexpr size_t MAX_FREE = 1024;
+
+	std::mutex lock;
+	SchedulerTask::Node* free = nullptr;
+	size_t free_count = 0;
+
+	SchedulerTask::Node* acquire();
+
+	void release(SchedulerTask::Node* node);
+
+	friend class SchedulerTask;
+
+public:
+	// region ctor/dtor
+
+	SchedulerTaskPool() = default;
+
+	SchedulerTaskPool(SchedulerTaskPool const&) = delete;
+
+	SchedulerTaskPool& operator=(SchedulerTaskPool const&) = delete;
+
+	~SchedulerTaskPool();
+	// endregion
+
+	template <typename F>
+	SchedulerTask make(F&& action)
+	{
+		using T = std::decay_t<F>;
+		SchedulerTask::Node* node = acquire();
+		try
+		{
+			if constexpr (sizeof(T) <= SchedulerTask::STORAGE_SIZE && alignof(T) <= alignof(std::max_align_t))
+			{
+				new (node->storage) T(std::forward<F>(action));
+				node->invoke = [](SchedulerTask::Node& n) { (*std::launder(reinterpret_cast<T*>(n.storage)))(); };
+				node->destroy = [](SchedulerTask::Node& n) { std::launder(reinterpret_cast<T*>(n.storage))->~T(); };
+			}
+			else
+			{
+				new (node->storage) T*(new T(std::forward<F>(action)));
+				node->invoke = [](SchedulerTask::Node& n) { (**std::launder(reinterpret_cast<T**>(n.storage)))(); };
+				node->destroy = [](SchedulerTask::Node& n) { delete *std::launder(reinterpret_cast<T**>(n.storage)); };
+			}
+		}
+		catch (...)
+		{
+			release(node);
+			throw;
+		}
+		return SchedulerTask(node);
+	}
+};
+}	 // namespace rd
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+#endif	  // RD_CPP_SCHEDULERTASK_H
@@ -2,37 +2,74 @@
 
 #include "util/core_util.h"
 
-#include "ctpl_stl.h"
 #include "spdlog/include/spdlog/sinks/stdout_color_sinks.h"
 
 namespace rd
 {
-SingleThreadSchedulerBase::PoolTask::PoolTask(std::function<void()> f, SingleThreadSchedulerBase* scheduler)
-	: f(std::move(f)), scheduler(scheduler)
+std::shared_ptr<spdlog::logger> SingleThreadSchedulerBase::log =
+	spdlog::stderr_color_mt<spdlog::synchronous_factory>("log", spdlog::color_mode::automatic);
+
+SingleThreadSchedulerBase::SingleThreadSchedulerBase(std::string name) : name(std::move(name))
 {
+	worker = std::thread([this] { run(); });
+	thread_id = worker.get_id();
 }
 
-void SingleThreadSchedulerBase::PoolTask::operator()(int id) const
+void SingleThreadSchedulerBase::run()
 {
-	try
-	{
-		f();
-		--scheduler->tasks_executing;
-	}
-	catch (std::exception const& e)
+	while (true)
 	{
-		scheduler->log->error("Background task failed, scheduler={}, thread_id={} | {}", scheduler->name, id, e.what());
-		--scheduler->tasks_executing;
+		SchedulerTask::Node* node = nullptr;
+		{
+			std::unique_lock<std::mutex> guard(queue_lock);
+			queue_cv.wait(guard, [this] { return head != nullptr || stopping; });
+			if (head == nullptr)
+			{
+				return;
+			}
+			// takes all the queued tasks at once
+			node = head;
+			head = tail = nullptr;
+		}
+		while (node != nullptr)
+		{
+			SchedulerTask::Node* next = node->next;
+			{
+				SchedulerTask task(node);
+				try
+				{
+					task();
+				}
+				catch (std::exception const& e)
+				{
+					log->error("Background task failed, scheduler={} | {}", name, e.what());
+				}
+			}
+			--tasks_executing;
+			node = next;
+		}
 	}
 }
 
-SingleThreadSchedulerBase::SingleThreadSchedulerBase(std::string name)
-	: log(spdlog::stderr_color_mt<spdlog::synchronous_factory>("log", spdlog::color_mode::automatic))
-	, name(std::move(name))
-	, pool(std::make_unique<ctpl::thread_pool>(1))
+void SingleThreadSchedulerBase::stop()
 {
-	RD_ASSERT_THROW_MSG(pool->size() == 1, "Thread pool wasn't properly initalized");
-	thread_id = pool->get_thread(0).get_id();
+	{
+		std::lock_guard<std::mutex> guard(queue_lock);
+		stopping = true;
+	}
+	queue_cv.notify_all();
+	if (worker.joinable())
+	{
+		if (worker.get_id() == std::this_thread::get_id())
+		{
+			// stopped by one of its tasks, the thread ends after it
+			worker.detach();
+		}
+		else
+		{
+			worker.join();
+		}
+	}
 }
 
 void SingleThreadSchedulerBase::flush()
@@ -47,9 +84,28 @@ void SingleThreadSchedulerBase::flush()
 
 void SingleThreadSchedulerBase::queue(std::function<void()> action)
 {
-	++tasks_executing;
-	PoolTask task(action, this);
-	pool->push(std::move(task));
+	queue(make_task(std::move(action)));
+}
+
+void SingleThreadSchedulerBase::queue(SchedulerTask task)
+{
+	{
+		std::lock_guard<std::mutex> guard(queue_lock);
+		if (!stopping)
+		{
+			++tasks_executing;
+			SchedulerTask::Node* node = task.release();
+			node->next = nullptr;
+			(tail != nullptr ? tail->next : head) = node;
+			tail = node;
+		}
+	}
+	if (task)
+	{
+		log->trace("Task dropped, scheduler={} is stopped", name);
+		return;
+	}
+	queue_cv.notify_one();
 }
 
 bool SingleThreadSchedulerBase::is_active() const
@@ -57,5 +113,8 @@ bool SingleThreadSchedulerBase::is_active() const
 	return thread_id == std::this_thread::get_id();
 }
 
-SingleThreadSchedulerBase::~SingleThreadSchedulerBase() = default;
+SingleThreadSchedulerBase::~SingleThreadSchedulerBase()
+{
+	stop();
+}
 }	 // namespace rd
\ No newline at end of file
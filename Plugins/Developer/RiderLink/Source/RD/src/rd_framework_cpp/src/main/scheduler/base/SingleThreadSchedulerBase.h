@@ -10,37 +10,42 @@
 #include "lifetime/Lifetime.h"
 #include "spdlog/spdlog.h"
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <utility>
 
 #include <rd_framework_export.h>
 
-namespace ctpl
-{
-class thread_pool;
-}
-
 namespace rd
 {
+/**
+ * \brief Runs the queued actions on a thread of its own in their order. Every action is queued as an intrusive
+ * [SchedulerTask] node, so queueing a task allocates nothing.
+ */
 class RD_FRAMEWORK_API SingleThreadSchedulerBase : public IScheduler
 {
 protected:
-	std::shared_ptr<spdlog::logger> log;
+	static std::shared_ptr<spdlog::logger> log;
 	std::string name;
 
 	std::atomic_uint32_t tasks_executing{0};
 	std::atomic_uint32_t active{0};
-	std::unique_ptr<ctpl::thread_pool> pool;
 
-	class PoolTask
-	{
-		std::function<void()> f;
-		SingleThreadSchedulerBase* scheduler;
+	/**
+	 * \brief Stops the thread once the actions queued so far are executed, the ones queued afterwards are dropped.
+	 */
+	void stop();
 
-	public:
-		explicit PoolTask(std::function<void()> f, SingleThreadSchedulerBase* scheduler);
+private:
+	std::mutex queue_lock;
+	std::condition_variable queue_cv;
+	SchedulerTask::Node* head = nullptr;
+	SchedulerTask::Node* tail = nullptr;
+	bool stopping = false;
+	std::thread worker;
 
-		void operator()(int id) const;
-	};
+	void run();
 
 public:
 	// region ctor/dtor
@@ -53,6 +58,8 @@ public:
 
 	void queue(std::function<void()> action) override;
 
+	void queue(SchedulerTask task) override;
+
 	bool is_active() const override;
 };
 }	 // namespace rd
@@ -134,7 +134,7 @@ private:
 				to_string(task_id), to_string(request));
 			task_id.write(buffer);
 			ReqSer::write(get_serialization_context(), buffer, request);
-		});
+		}, lane);
 
 		return task;
 	}
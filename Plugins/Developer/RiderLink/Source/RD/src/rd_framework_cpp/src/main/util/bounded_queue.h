@@ -0,0 +1,147 @@
+#ifndef RD_CPP_BOUNDED_QUEUE_H
+#define RD_CPP_BOUNDED_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace rd
+{
+namespace util
+{
+/**
+ * \brief Lock-free bounded multi-producer multi-consumer queue (Dmitry Vyukov's array based design).
+ * Every slot carries a sequence number, so producers and consumers only contend on the head/tail counters.
+ * \tparam T element type, moved in and out of the slots
+ */
+template <typename T>
+class bounded_queue
+{
+	struct alignas(64) cell
+	{
+		std::atomic<size_t> sequence;
+		T value;
+	};
+
+	std::unique_ptr<cell[]> cells;
+	size_t mask;
+
+	alignas(64) std::atomic<size_t> enqueue_pos{0};
+	alignas(64) std::atomic<size_t> dequeue_pos{0};
+
+public:
+	// region ctor/dtor
+
+	/**
+	 * \param capacity maximum number of elements, rounded up to a power of two
+	 */
+	explicit bounded_queue(size_t capacity)
+	{
+		size_t size = 2;
+		while (size < capacity)
+		{
+			size <<= 1;
+		}
+		cells = std::make_unique<cell[]>(size);
+		mask = size - 1;
+		for (size_t i = 0; i < size; ++i)
+		{
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	bounded_queue(bounded_queue const&) = delete;
+
+	bounded_queue& operator=(bounded_queue const&) = delete;
+
+	// endregion
+
+	size_t capacity() const
+	{
+		return mask + 1;
+	}
+
+	/**
+	 * \brief Approximate number of elements, exact only while no other thread touches the queue.
+	 */
+	size_t size_approx() const
+	{
+		const size_t tail = enqueue_pos.load(std::memory_order_relaxed);
+		const size_t head = dequeue_pos.load(std::memory_order_relaxed);
+		return tail >= head ? tail - head : 0;
+	}
+
+	/**
+	 * \brief Moves [value] into the queue.
+	 * \return false if the queue is full, [value] is left untouched then
+	 */
+	bool try_push(T& value)
+	{
+		cell* target;
+		size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+		while (true)
+		{
+			target = &cells[pos & mask];
+			const size_t seq = target->sequence.load(std::memory_order_acquire);
+			const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+			if (diff == 0)
+			{
+				if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (diff < 0)
+			{
+				return false;
+			}
+			else
+			{
+				pos = enqueue_pos.load(std::memory_order_relaxed);
+			}
+		}
+		target->value = std::move(value);
+		target->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * \brief Moves the oldest element out of the queue into [result].
+	 * \return false if the queue is empty
+	 */
+	bool try_pop(T& result)
+	{
+		cell* target;
+		size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+		while (true)
+		{
+			target = &cells[pos & mask];
+			const size_t seq = target->sequence.load(std::memory_order_acquire);
+			const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+			if (diff == 0)
+			{
+				if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (diff < 0)
+			{
+				return false;
+			}
+			else
+			{
+				pos = dequeue_pos.load(std::memory_order_relaxed);
+			}
+		}
+		result = std::move(target->value);
+		target->value = T();
+		target->sequence.store(pos + mask + 1, std::memory_order_release);
+		return true;
+	}
+};
+}	 // namespace util
+}	 // namespace rd
+
+#endif	  // RD_CPP_BOUNDED_QUEUE_H
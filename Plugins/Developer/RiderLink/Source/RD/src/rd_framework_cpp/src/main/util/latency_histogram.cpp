@@ -0,0 +1,77 @@
+#include "latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace rd
+{
+namespace util
+{
+constexpr size_t latency_histogram::BUCKET_COUNT;
+
+uint64_t latency_histogram::snapshot::count() const
+{
+	uint64_t result = 0;
+	for (uint64_t bucket : buckets)
+	{
+		result += bucket;
+	}
+	return result;
+}
+
+std::chrono::microseconds latency_histogram::snapshot::percentile(double p) const
+{
+	const uint64_t total = count();
+	if (total == 0)
+	{
+		return std::chrono::microseconds(0);
+	}
+	const auto rank = (std::max)(uint64_t{1}, static_cast<uint64_t>(std::ceil(p * total)));
+	uint64_t seen = 0;
+	for (size_t i = 0; i < BUCKET_COUNT; ++i)
+	{
+		seen += buckets[i];
+		if (seen >= rank)
+		{
+			return bucket_upper_bound(i);
+		}
+	}
+	return bucket_upper_bound(BUCKET_COUNT - 1);
+}
+
+std::chrono::microseconds latency_histogram::bucket_upper_bound(size_t index)
+{
+	return std::chrono::microseconds(int64_t{1} << index);
+}
+
+void latency_histogram::record(std::chrono::nanoseconds duration)
+{
+	auto micros = static_cast<uint64_t>((std::max)(int64_t{0}, static_cast<int64_t>(duration.count() / 1000)));
+	size_t index = 0;
+	while (micros > 0 && index < BUCKET_COUNT - 1)
+	{
+		micros >>= 1;
+		++index;
+	}
+	buckets[index].fetch_add(1, std::memory_order_relaxed);
+}
+
+latency_histogram::snapshot latency_histogram::get_snapshot() const
+{
+	snapshot result;
+	for (size_t i = 0; i < BUCKET_COUNT; ++i)
+	{
+		result.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+	}
+	return result;
+}
+
+void latency_histogram::reset()
+{
+	for (auto& bucket : buckets)
+	{
+		bucket.store(0, std::memory_order_relaxed);
+	}
+}
+}	 // namespace util
+}	 // namespace rd
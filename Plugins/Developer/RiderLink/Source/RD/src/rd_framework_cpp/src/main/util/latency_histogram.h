@@ -0,0 +1,55 @@
+#ifndef RD_CPP_LATENCY_HISTOGRAM_H
+#define RD_CPP_LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include <rd_framework_export.h>
+
+namespace rd
+{
+namespace util
+{
+/**
+ * \brief Histogram of durations with power-of-two microsecond buckets, recorded from any thread without locks.
+ * Bucket 0 holds durations below 1us, bucket i durations from 2^(i-1)us up to 2^i us, the last one everything longer.
+ */
+class RD_FRAMEWORK_API latency_histogram
+{
+public:
+	static constexpr size_t BUCKET_COUNT = 26;
+
+	struct snapshot
+	{
+		std::array<uint64_t, BUCKET_COUNT> buckets{};
+
+		uint64_t count() const;
+
+		/**
+		 * \brief Upper bound of the bucket holding the [p] quantile, zero if nothing was recorded.
+		 * \param p quantile within [0, 1]
+		 */
+		std::chrono::microseconds percentile(double p) const;
+	};
+
+	/**
+	 * \brief Exclusive upper bound of the durations in bucket [index], the last bucket is open-ended though.
+	 */
+	static std::chrono::microseconds bucket_upper_bound(size_t index);
+
+	void record(std::chrono::nanoseconds duration);
+
+	snapshot get_snapshot() const;
+
+	void reset();
+
+private:
+	std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets{};
+};
+}	 // namespace util
+}	 // namespace rd
+
+#endif	  // RD_CPP_LATENCY_HISTOGRAM_H
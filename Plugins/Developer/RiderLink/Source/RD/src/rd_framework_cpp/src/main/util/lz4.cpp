@@ -0,0 +1,223 @@
+#include "lz4.h"
+
+#include <array>
+#include <cstring>
+
+namespace rd
+{
+namespace util
+{
+namespace lz4
+{
+namespace
+{
+constexpr size_t MIN_MATCH = 4;
+/**
+ * \brief A match must start at least this many bytes before the end of the input.
+ */
+constexpr size_t MF_LIMIT = 12;
+/**
+ * \brief The last bytes of the input are always literals.
+ */
+constexpr size_t LAST_LITERALS = 5;
+constexpr size_t MAX_DISTANCE = 65535;
+constexpr uint32_t HASH_LOG = 14;
+
+uint32_t read32(uint8_t const* p)
+{
+	uint32_t value;
+	memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+uint32_t hash(uint32_t sequence)
+{
+	return (sequence * 2654435761u) >> (32 - HASH_LOG);
+}
+
+uint8_t* write_length(uint8_t* op, size_t length)
+{
+	while (length >= 255)
+	{
+		*op++ = 255;
+		length -= 255;
+	}
+	*op++ = static_cast<uint8_t>(length);
+	return op;
+}
+
+uint8_t* write_literals(uint8_t* op, uint8_t*& token, uint8_t const* literals, size_t length)
+{
+	token = op++;
+	if (length >= 15)
+	{
+		*token = 15 << 4;
+		op = write_length(op, length - 15);
+	}
+	else
+	{
+		*token = static_cast<uint8_t>(length << 4);
+	}
+	memcpy(op, literals, length);
+	return op + length;
+}
+
+/**
+ * \return false if [ip] would pass [end]
+ */
+bool read_length(uint8_t const*& ip, uint8_t const* end, size_t& length)
+{
+	uint8_t byte;
+	do
+	{
+		if (ip >= end)
+		{
+			return false;
+		}
+		byte = *ip++;
+		length += byte;
+	} while (byte == 255);
+	return true;
+}
+}	 // namespace
+
+size_t compress(uint8_t const* src, size_t size, uint8_t* dst, size_t capacity)
+{
+	if (capacity < compress_bound(size))
+	{
+		return 0;
+	}
+
+	// positions of the latest occurrence of each hashed 4 byte sequence, stale entries are rejected by comparison
+	thread_local std::array<uint32_t, 1u << HASH_LOG> table;
+	table.fill(0);
+
+	uint8_t* op = dst;
+	uint8_t* token = nullptr;
+	uint8_t const* anchor = src;
+	uint8_t const* const end = src + size;
+
+	if (size > MF_LIMIT)
+	{
+		uint8_t const* const match_limit = end - MF_LIMIT;
+		uint8_t const* const match_end_limit = end - LAST_LITERALS;
+		uint8_t const* ip = src + 1;
+		while (ip < match_limit)
+		{
+			const uint32_t sequence = read32(ip);
+			uint32_t& entry = table[hash(sequence)];
+			uint8_t const* candidate = src + entry;
+			entry = static_cast<uint32_t>(ip - src);
+			if (static_cast<size_t>(ip - candidate) > MAX_DISTANCE || read32(candidate) != sequence)
+			{
+				++ip;
+				continue;
+			}
+
+			while (ip > anchor && candidate > src && ip[-1] == candidate[-1])
+			{
+				--ip;
+				--candidate;
+			}
+			uint8_t const* match_end = ip + MIN_MATCH;
+			uint8_t const* reference = candidate + MIN_MATCH;
+			while (match_end < match_end_limit && *match_end == *reference)
+			{
+				++match_end;
+				++reference;
+			}
+
+			op = write_literals(op, token, anchor, static_cast<size_t>(ip - anchor));
+			const uint16_t offset = static_cast<uint16_t>(ip - candidate);
+			*op++ = static_cast<uint8_t>(offset);
+			*op++ = static_cast<uint8_t>(offset >> 8);
+			const size_t match_length = static_cast<size_t>(match_end - ip) - MIN_MATCH;
+			if (match_length >= 15)
+			{
+				*token |= 15;
+				op = write_length(op, match_length - 15);
+			}
+			else
+			{
+				*token |= static_cast<uint8_t>(match_length);
+			}
+
+			ip = anchor = match_end;
+		}
+	}
+
+	op = write_literals(op, token, anchor, static_cast<size_t>(end - anchor));
+	return static_cast<size_t>(op - dst);
+}
+
+int64_t decompress(uint8_t const* src, size_t size, uint8_t* dst, size_t capacity)
+{
+	uint8_t const* ip = src;
+	uint8_t const* const end = src + size;
+	uint8_t* op = dst;
+	uint8_t* const out_end = dst + capacity;
+
+	while (ip < end)
+	{
+		const uint8_t token = *ip++;
+
+		size_t literals = token >> 4;
+		if (literals == 15 && !read_length(ip, end, literals))
+		{
+			return -1;
+		}
+		if (literals > static_cast<size_t>(end - ip) || literals > static_cast<size_t>(out_end - op))
+		{
+			return -1;
+		}
+		memcpy(op, ip, literals);
+		op += literals;
+		ip += literals;
+		if (ip == end)
+		{
+			// the last sequence consists of literals only
+			break;
+		}
+
+		if (end - ip < 2)
+		{
+			return -1;
+		}
+		const size_t offset = static_cast<size_t>(ip[0]) | (static_cast<size_t>(ip[1]) << 8);
+		ip += 2;
+		if (offset == 0 || offset > static_cast<size_t>(op - dst))
+		{
+			return -1;
+		}
+
+		size_t length = token & 15;
+		if (length == 15 && !read_length(ip, end, length))
+		{
+			return -1;
+		}
+		length += MIN_MATCH;
+		if (length > static_cast<size_t>(out_end - op))
+		{
+			return -1;
+		}
+
+		uint8_t const* match = op - offset;
+		if (offset >= length)
+		{
+			memcpy(op, match, length);
+			op += length;
+		}
+		else
+		{
+			// overlapping copy repeats the last [offset] bytes
+			for (size_t i = 0; i < length; ++i)
+			{
+				*op++ = *match++;
+			}
+		}
+	}
+	return op - dst;
+}
+}	 // namespace lz4
+}	 // namespace util
+}	 // namespace rd
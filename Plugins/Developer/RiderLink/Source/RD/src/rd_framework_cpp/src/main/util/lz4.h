@@ -0,0 +1,44 @@
+#ifndef RD_CPP_LZ4_H
+#define RD_CPP_LZ4_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <rd_framework_export.h>
+
+namespace rd
+{
+namespace util
+{
+/**
+ * \brief Compressor and decompressor for the LZ4 block format, compatible with the reference implementation's
+ * LZ4_compress_default/LZ4_decompress_safe. Only the fast greedy mode is implemented.
+ */
+namespace lz4
+{
+/**
+ * \brief Worst case size of the compressed form of [size] bytes.
+ */
+constexpr size_t compress_bound(size_t size)
+{
+	return size + size / 255 + 16;
+}
+
+/**
+ * \brief Compresses [size] bytes of [src] into [dst].
+ * \param capacity size of [dst], must be at least [compress_bound] of [size]
+ * \return compressed size, 0 if [capacity] is too small
+ */
+RD_FRAMEWORK_API size_t compress(uint8_t const* src, size_t size, uint8_t* dst, size_t capacity);
+
+/**
+ * \brief Decompresses a block of [size] bytes of [src] into [dst], never reading or writing out of bounds.
+ * \param capacity size of [dst]
+ * \return decompressed size, -1 if the block is malformed or doesn't fit into [dst]
+ */
+RD_FRAMEWORK_API int64_t decompress(uint8_t const* src, size_t size, uint8_t* dst, size_t capacity);
+}	 // namespace lz4
+}	 // namespace util
+}	 // namespace rd
+
+#endif	  // RD_CPP_LZ4_H
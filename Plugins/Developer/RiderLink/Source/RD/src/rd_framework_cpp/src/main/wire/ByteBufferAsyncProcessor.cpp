@@ -1,22 +1,36 @@
 #include "ByteBufferAsyncProcessor.h"
+#include "SendBufferPool.h"
 
 #include "util/guards.h"
 #include <util/thread_util.h>
 
 #include "spdlog/sinks/stdout_color_sinks.h"
 
+#include <algorithm>
+#include <stdexcept>
+
 namespace rd
 {
-size_t ByteBufferAsyncProcessor::INITIAL_CAPACITY = 1024 * 1024;
-
 std::shared_ptr<spdlog::logger> ByteBufferAsyncProcessor::logger =
 	spdlog::stderr_color_mt<spdlog::synchronous_factory>("byteBufferLog", spdlog::color_mode::automatic);
 
-ByteBufferAsyncProcessor::ByteBufferAsyncProcessor(
-	std::string id, std::function<bool(Buffer::ByteArray const&, sequence_number_t)> processor)
+constexpr size_t ByteBufferAsyncProcessor::MAX_BATCH_BYTES;
+constexpr size_t ByteBufferAsyncProcessor::MAX_BATCH_SIZE;
+constexpr size_t ByteBufferAsyncProcessor::MAX_QUEUED_PACKAGES;
+constexpr size_t ByteBufferAsyncProcessor::DEFAULT_MAX_BYTES;
+constexpr size_t ByteBufferAsyncProcessor::RESEND_WINDOW_BYTES;
+constexpr size_t ByteBufferAsyncProcessor::LANE_WEIGHTS[LANE_COUNT];
+constexpr ByteBufferAsyncProcessor::OverflowPolicy ByteBufferAsyncProcessor::DEFAULT_OVERFLOW_POLICY;
+
+ByteBufferAsyncProcessor::ByteBufferAsyncProcessor(std::string id, processor_t processor)
 	: id(std::move(id)), processor(std::move(processor))
 {
-	data.reserve(INITIAL_CAPACITY);
+	batch.reserve(MAX_BATCH_SIZE);
+	batch_lanes.reserve(MAX_BATCH_SIZE);
+	for (auto& lane_policy : overflow_policies)
+	{
+		lane_policy = DEFAULT_OVERFLOW_POLICY;
+	}
 }
 
 void ByteBufferAsyncProcessor::cleanup0()
@@ -29,6 +43,7 @@ void ByteBufferAsyncProcessor::cleanup0()
 	// todo clean data
 
 	cv.notify_all();
+	on_bytes_released();
 }
 
 bool ByteBufferAsyncProcessor::terminate0(time_t timeout, StateKind state_to_set, string_view action)
@@ -44,13 +59,17 @@ bool ByteBufferAsyncProcessor::terminate0(time_t timeout, StateKind state_to_set
 
 		if (state >= state_to_set)
 		{
-			logger->debug("Trying to {} async processor \'{}' but it's in state {}", std::string(action), id, to_string(state));
+			logger->debug("Trying to {} async processor \'{}' but it's in state {}", std::string(action), id, to_string(state.load()));
 			return true;
 		}
 
 		state = state_to_set;
 	}
 	cv.notify_all();
+	{
+		std::lock_guard<decltype(overflow_lock)> guard(overflow_lock);
+		overflow_cv.notify_all();
+	}
 
 	std::future_status status = async_future.wait_for(timeout);
 
@@ -67,41 +86,182 @@ bool ByteBufferAsyncProcessor::terminate0(time_t timeout, StateKind state_to_set
 	return success;
 }
 
-void ByteBufferAsyncProcessor::add_data(std::vector<Buffer::ByteArray>&& new_data)
+bool ByteBufferAsyncProcessor::add_data()
 {
 	std::lock_guard<decltype(queue_lock)> guard(queue_lock);
-	std::move(new_data.begin(), new_data.end(), std::back_inserter(queue));
-	//		for (auto &&item : new_data) {
-	//			queue.emplace(std::move(item));
-	//		}
+	return add_data0();
 }
 
-bool ByteBufferAsyncProcessor::reprocess()
+bool ByteBufferAsyncProcessor::add_data0()
 {
+	QueuedPackage item;
+	while (data.try_pop(item))
 	{
-		std::lock_guard<decltype(queue_lock)> guard(queue_lock);
+		queues[static_cast<size_t>(item.lane)].push_back(std::move(item));
+	}
+	for (auto const& queue : queues)
+	{
+		if (!queue.empty())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void ByteBufferAsyncProcessor::wake()
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (sleeping.load())
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		cv.notify_all();
+	}
+}
 
-		logger->debug("{}: reprocessing started", id);
+bool ByteBufferAsyncProcessor::has_room(size_t size) const
+{
+	const size_t used = queued_bytes.load() + pending_bytes.load();
+	return used == 0 || used + size <= max_bytes.load();
+}
 
-		std::unique_lock<decltype(processing_lock)> ul(processing_lock);
-		processing_cv.wait(ul, [this]() -> bool { return !in_processing; });
+void ByteBufferAsyncProcessor::on_bytes_released()
+{
+	if (blocked_producers.load() > 0)
+	{
+		std::lock_guard<decltype(overflow_lock)> guard(overflow_lock);
+		overflow_cv.notify_all();
+	}
+}
+
+bool ByteBufferAsyncProcessor::drop_oldest_lossy(Lane lane)
+{
+	Buffer::ByteArray dropped;
+	{
+		// the processing thread holds the lock while it sends, producers must not wait for a stalled counterpart
+		std::unique_lock<decltype(queue_lock)> guard(queue_lock, std::try_to_lock);
+		if (!guard.owns_lock())
+		{
+			return false;
+		}
+		add_data0();
+		auto& queue = queues[static_cast<size_t>(lane)];
+		const auto oldest = std::find_if(queue.begin(), queue.end(), [](QueuedPackage const& package) { return package.lossy; });
+		if (oldest == queue.end())
+		{
+			return false;
+		}
+		dropped = std::move(oldest->bytes);
+		queue.erase(oldest);
+	}
+	queued_bytes -= dropped.size();
+	--queued_packages;
+	++dropped_packages;
+	SendBufferPool::instance().release(std::move(dropped));
+	return true;
+}
 
-		logger->debug("{}: reprocessing waited for main processing", id);
+void ByteBufferAsyncProcessor::release_acknowledged()
+{
+	auto& pool = SendBufferPool::instance();
+	const sequence_number_t acknowledged = acknowledged_seqn.load(std::memory_order_acquire);
+	size_t released_bytes = 0;
+	size_t released_packages = 0;
+	while (current_seqn <= acknowledged && !pending_queue.empty())
+	{
+		if (resending && current_seqn < resend_seqn)
+		{
+			resent_bytes -= (std::min)(resent_bytes, pending_queue.front().size());
+		}
+		released_bytes += pending_queue.front().size();
+		++released_packages;
+		pool.release(std::move(pending_queue.front()));
+		pending_queue.pop_front();
+		++current_seqn;
+	}
+	if (released_packages > 0)
+	{
+		pending_bytes -= released_bytes;
+		pending_packages -= released_packages;
+		on_bytes_released();
+	}
+}
 
-		while (current_seqn <= acknowledged_seqn)
+size_t ByteBufferAsyncProcessor::fill_batch(
+	std::deque<Buffer::ByteArray>::const_iterator begin, std::deque<Buffer::ByteArray>::const_iterator end)
+{
+	batch.clear();
+	size_t bytes = 0;
+	for (auto it = begin; it != end && batch.size() < MAX_BATCH_SIZE; ++it)
+	{
+		if (!batch.empty() && bytes + it->size() > MAX_BATCH_BYTES)
 		{
-			pending_queue.pop_front();
-			++current_seqn;
+			break;
 		}
-		for (int i = 0; i < pending_queue.size(); ++i)
+		bytes += it->size();
+		batch.push_back(&*it);
+	}
+	return batch.size();
+}
+
+size_t ByteBufferAsyncProcessor::fill_lane_batch()
+{
+	batch.clear();
+	batch_lanes.clear();
+	std::array<size_t, LANE_COUNT> taken{};
+	size_t bytes = 0;
+	bool added = true;
+	while (added)
+	{
+		added = false;
+		for (size_t lane = 0; lane < LANE_COUNT; ++lane)
 		{
-			auto const& item = pending_queue[i];
-			if (!processor(item, current_seqn + i))
+			auto const& queue = queues[lane];
+			for (size_t i = 0; i < LANE_WEIGHTS[lane] && taken[lane] < queue.size(); ++i)
 			{
-				return false;
+				auto const& package = queue[taken[lane]].bytes;
+				if (batch.size() == MAX_BATCH_SIZE || (!batch.empty() && bytes + package.size() > MAX_BATCH_BYTES))
+				{
+					return batch.size();
+				}
+				bytes += package.size();
+				batch.push_back(&package);
+				batch_lanes.push_back(static_cast<Lane>(lane));
+				++taken[lane];
+				added = true;
 			}
 		}
 	}
+	return batch.size();
+}
+
+bool ByteBufferAsyncProcessor::resend()
+{
+	// the counterpart may have acknowledged packages it received before the connection was lost
+	resend_seqn = (std::max)(resend_seqn, current_seqn);
+	while (resend_seqn <= max_sent_seqn)
+	{
+		if (resent_bytes >= RESEND_WINDOW_BYTES)
+		{
+			logger->debug("{}: resending waits for acknowledgements at seqn {}", id, resend_seqn);
+			resend_blocked = true;
+			return false;
+		}
+		const auto begin = pending_queue.cbegin() + static_cast<std::ptrdiff_t>(resend_seqn - current_seqn);
+		const size_t count = fill_batch(begin, pending_queue.cend());
+		if (!processor(batch, resend_seqn))
+		{
+			return false;
+		}
+		for (auto const* package : batch)
+		{
+			resent_bytes += package->size();
+		}
+		resend_seqn += count;
+		release_acknowledged();
+	}
+	logger->debug("{}: resending finished", id);
+	resending = false;
 	return true;
 }
 
@@ -114,11 +274,40 @@ void ByteBufferAsyncProcessor::process()
 
 		logger->debug("{}: processing started", id);
 
-		while (!queue.empty() && processor(queue.front(), max_sent_seqn + 1))
+		release_acknowledged();
+		if (resend_pending.exchange(false))
+		{
+			logger->debug("{}: resending from seqn {}", id, current_seqn);
+			resending = true;
+			resend_seqn = current_seqn;
+			resent_bytes = 0;
+		}
+		resend_blocked = false;
+		// resent packages precede new ones, the counterpart skips every seqn not above the highest one it received
+		const bool resent = !resending || resend();
+		// packages put meanwhile are taken before each batch, so urgent lanes don't wait for a backlog of bulk ones
+		while (resent && add_data0())
 		{
-			++max_sent_seqn;
-			pending_queue.push_back(std::move(queue.front()));
-			queue.pop_front();
+			const size_t count = fill_lane_batch();
+			if (!processor(batch, max_sent_seqn + 1))
+			{
+				break;
+			}
+			max_sent_seqn += count;
+			size_t bytes = 0;
+			for (size_t i = 0; i < count; ++i)
+			{
+				// the batch took each lane's packages from its front, so they leave in the same order
+				auto& queue = queues[static_cast<size_t>(batch_lanes[i])];
+				bytes += queue.front().bytes.size();
+				pending_queue.push_back(std::move(queue.front().bytes));
+				queue.pop_front();
+			}
+			pending_bytes += bytes;
+			pending_packages += count;
+			queued_bytes -= bytes;
+			queued_packages -= count;
+			release_acknowledged();
 		}
 	}
 	processing_cv.notify_all();
@@ -141,10 +330,24 @@ void ByteBufferAsyncProcessor::ThreadProc()
 				return;
 			}
 
-			while (data.empty() || interrupt_balance != 0)
+			while (true)
 			{
+				// producers check the flag after publishing their package, either side sees the other
+				sleeping.store(true);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+
+				// data is taken even while paused, so [data] doesn't fill up during a reconnect;
+				// acknowledged packages wake the thread as well, so their buffers get recycled without new data
+				const bool has_data = add_data();
+				const bool can_send = (has_data || resending) && !resend_blocked;
+				if (interrupt_balance == 0 &&
+					(can_send || resend_pending.load() || acknowledged_seqn.load(std::memory_order_relaxed) >= current_seqn))
+				{
+					break;
+				}
 				if (state >= StateKind::Stopping)
 				{
+					sleeping.store(false);
 					return;
 				}
 				cv.wait(lock);
@@ -153,11 +356,11 @@ void ByteBufferAsyncProcessor::ThreadProc()
 
 				if (state >= StateKind::Terminating)
 				{
+					sleeping.store(false);
 					return;
 				}
 			}
-			add_data(std::move(data));
-			data.clear();
+			sleeping.store(false);
 		}
 
 		try
@@ -178,7 +381,7 @@ void ByteBufferAsyncProcessor::start()
 
 		if (state != StateKind::Initialized)
 		{
-			logger->debug("Trying to START async processor {} but it's in state {}", id, to_string(state));
+			logger->debug("Trying to START async processor {} but it's in state {}", id, to_string(state.load()));
 			return;
 		}
 
@@ -198,18 +401,94 @@ bool ByteBufferAsyncProcessor::terminate(time_t timeout)
 	return terminate0(timeout, StateKind::Terminating, "TERMINATE");
 }
 
-void ByteBufferAsyncProcessor::put(Buffer::ByteArray new_data)
+void ByteBufferAsyncProcessor::set_limits(size_t new_max_bytes, OverflowPolicy policy)
 {
+	max_bytes = new_max_bytes;
+	for (auto& lane_policy : overflow_policies)
 	{
-		std::lock_guard<decltype(lock)> guard(lock);
+		lane_policy = policy;
+	}
+	on_bytes_released();
+}
+
+void ByteBufferAsyncProcessor::set_overflow_policy(Lane lane, OverflowPolicy policy)
+{
+	overflow_policies[static_cast<size_t>(lane)] = policy;
+	on_bytes_released();
+}
+
+bool ByteBufferAsyncProcessor::put(Buffer::ByteArray new_data, Lane lane, bool lossy)
+{
+	if (state >= StateKind::Stopping)
+	{
+		return false;
+	}
 
-		if (state >= StateKind::Stopping)
+	const size_t size = new_data.size();
+	if (!has_room(size) && lossy)
+	{
+		while (!has_room(size) && drop_oldest_lossy(lane))
 		{
-			return;
 		}
-		data.emplace_back(std::move(new_data));
+		if (!has_room(size))
+		{
+			++dropped_packages;
+			return false;
+		}
 	}
-	cv.notify_all();
+	else if (!has_room(size))
+	{
+		switch (overflow_policies[static_cast<size_t>(lane)].load())
+		{
+			case OverflowPolicy::Block:
+			{
+				++blocked_puts;
+				std::unique_lock<decltype(overflow_lock)> ul(overflow_lock);
+				++blocked_producers;
+				logger->debug("{}: put blocked, {} bytes queued, {} bytes pending", id, queued_bytes.load(), pending_bytes.load());
+				overflow_cv.wait(ul, [this, size]() -> bool { return has_room(size) || state >= StateKind::Stopping; });
+				--blocked_producers;
+				if (state >= StateKind::Stopping)
+				{
+					return false;
+				}
+				break;
+			}
+			case OverflowPolicy::Fail:
+			{
+				++rejected_packages;
+				const std::string message = fmt::format("{}: send queue full, {} bytes queued, {} bytes pending", id,
+					queued_bytes.load(), pending_bytes.load());
+				logger->error(message);
+				throw std::runtime_error(message);
+			}
+		}
+	}
+
+	queued_bytes += size;
+	++queued_packages;
+	QueuedPackage package{std::move(new_data), lane, lossy};
+	while (!data.try_push(package))
+	{
+		// the processing thread drains [data] even while paused, a full ring is only transient
+		wake();
+		std::this_thread::yield();
+	}
+	wake();
+	return true;
+}
+
+ByteBufferAsyncProcessor::Gauges ByteBufferAsyncProcessor::get_gauges() const
+{
+	Gauges result;
+	result.queued_packages = queued_packages.load();
+	result.queued_bytes = queued_bytes.load();
+	result.pending_packages = pending_packages.load();
+	result.pending_bytes = pending_bytes.load();
+	result.dropped_packages = dropped_packages.load();
+	result.rejected_packages = rejected_packages.load();
+	result.blocked_puts = blocked_puts.load();
+	return result;
 }
 
 void ByteBufferAsyncProcessor::pause(const std::string& reason)
@@ -218,7 +497,7 @@ void ByteBufferAsyncProcessor::pause(const std::string& reason)
 
 	++interrupt_balance;
 
-	logger->debug("{} paused with reason={},state={}", id, reason, to_string(state));
+	logger->debug("{} paused with reason={},state={}", id, reason, to_string(state.load()));
 
 	auto current_thread_id = std::this_thread::get_id();
 	if (current_thread_id != async_thread_id)
@@ -235,8 +514,7 @@ void ByteBufferAsyncProcessor::resume()
 	{
 		std::lock_guard<decltype(lock)> guard(lock);
 
-		reprocess();
-
+		resend_pending = true;
 		--interrupt_balance;
 
 		logger->debug("{} resumed", id);
@@ -247,17 +525,22 @@ void ByteBufferAsyncProcessor::resume()
 
 void ByteBufferAsyncProcessor::acknowledge(sequence_number_t seqn)
 {
-	std::lock_guard<decltype(lock)> guard(lock);
-
-	if (seqn > acknowledged_seqn)
 	{
-		logger->trace("{}: new acknowledged seqn: {}", this->id, seqn);
-		acknowledged_seqn = seqn;
-	}
-	else
-	{
-		logger->error("Acknowledge {} called, while next seqn MUST BE greater than {}", seqn, acknowledged_seqn);
+		std::lock_guard<decltype(lock)> guard(lock);
+
+		if (seqn > acknowledged_seqn)
+		{
+			logger->trace("{}: new acknowledged seqn: {}", this->id, seqn);
+			acknowledged_seqn.store(seqn, std::memory_order_release);
+		}
+		else
+		{
+			logger->error("Acknowledge {} called, while next seqn MUST BE greater than {}", seqn, acknowledged_seqn.load());
+			return;
+		}
 	}
+	// pending_queue is trimmed by the processing thread, acknowledge never waits for a blocked send
+	cv.notify_all();
 }
 
 std::string to_string(ByteBufferAsyncProcessor::StateKind state)
@@ -277,4 +560,16 @@ std::string to_string(ByteBufferAsyncProcessor::StateKind state)
 	}
 	return {};
 }
+
+std::string to_string(ByteBufferAsyncProcessor::OverflowPolicy policy)
+{
+	switch (policy)
+	{
+		case ByteBufferAsyncProcessor::OverflowPolicy::Block:
+			return "Block";
+		case ByteBufferAsyncProcessor::OverflowPolicy::Fail:
+			return "Fail";
+	}
+	return {};
+}
 }	 // namespace rd
@@ -6,15 +6,21 @@
 #pragma warning(disable:4251)
 #endif
 
+#include "base/Lane.h"
 #include "protocol/Buffer.h"
 #include "spdlog/spdlog.h"
+#include "util/bounded_queue.h"
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <string>
 #include <mutex>
 #include <condition_variable>
 #include <future>
 #include <list>
+#include <deque>
+#include <vector>
 
 #include <rd_framework_export.h>
 
@@ -25,6 +31,40 @@ using sequence_number_t = int64_t;
 class RD_FRAMEWORK_API ByteBufferAsyncProcessor
 {
 public:
+	/**
+	 * \brief Consecutive packages handed to the processor at once, they have consecutive sequence numbers.
+	 */
+	using batch_t = std::vector<Buffer::ByteArray const*>;
+	using processor_t = std::function<bool(batch_t const& batch, sequence_number_t first_seqn)>;
+
+	/**
+	 * \brief Byte budget of a single batch, a package exceeding it on its own is still sent as a batch of one.
+	 */
+	static constexpr size_t MAX_BATCH_BYTES = 256 * 1024;
+	/**
+	 * \brief Package count limit of a single batch, keeps a vectored write of header and payload below IOV_MAX.
+	 */
+	static constexpr size_t MAX_BATCH_SIZE = 256;
+
+	/**
+	 * \brief Number of packages [put] may queue before the processing thread picks them up.
+	 */
+	static constexpr size_t MAX_QUEUED_PACKAGES = 16 * 1024;
+	/**
+	 * \brief Default limit for queued plus not yet acknowledged bytes.
+	 */
+	static constexpr size_t DEFAULT_MAX_BYTES = 64 * 1024 * 1024;
+	/**
+	 * \brief Bytes resent after a reconnect which may be unacknowledged at once, the rest follows as acknowledgements
+	 * arrive.
+	 */
+	static constexpr size_t RESEND_WINDOW_BYTES = 4 * 1024 * 1024;
+	/**
+	 * \brief Packages each lane, indexed by [Lane], may add to a batch per round while several lanes have packages
+	 * queued. [Lane::Control] may fill a whole batch, so no package overtakes an earlier control package.
+	 */
+	static constexpr size_t LANE_WEIGHTS[LANE_COUNT] = {MAX_BATCH_SIZE, 4, 1};
+
 	enum class StateKind
 	{
 		Initialized,
@@ -34,32 +74,131 @@ public:
 		Terminated
 	};
 
+	/**
+	 * \brief What [put] does with a package that isn't lossy while the byte limit is exceeded. Lossy packages never
+	 * wait, they drop the oldest lossy packages of their lane that haven't been sent yet, or themselves.
+	 */
+	enum class OverflowPolicy
+	{
+		/**
+		 * \brief Waits until the counterpart acknowledged enough packages or the processor stops.
+		 */
+		Block,
+		/**
+		 * \brief Rejects the new package by throwing, so the sender learns its message wasn't sent.
+		 */
+		Fail
+	};
+
+	/**
+	 * \brief Overflow policy of every lane until set otherwise, reliable messages are never lost.
+	 */
+	static constexpr OverflowPolicy DEFAULT_OVERFLOW_POLICY = OverflowPolicy::Block;
+
+	/**
+	 * \brief Snapshot of the queue depths of a processor.
+	 */
+	struct Gauges
+	{
+		size_t queued_packages = 0;
+		size_t queued_bytes = 0;
+		size_t pending_packages = 0;
+		size_t pending_bytes = 0;
+		uint64_t dropped_packages = 0;
+		uint64_t rejected_packages = 0;
+		uint64_t blocked_puts = 0;
+	};
+
 private:
 	using time_t = std::chrono::milliseconds;
 
-	static size_t INITIAL_CAPACITY;
+	struct QueuedPackage
+	{
+		Buffer::ByteArray bytes;
+		Lane lane;
+		bool lossy;
+	};
 
 	std::recursive_mutex lock;
 	std::condition_variable_any cv;
 
 	std::string id;
 
-	std::function<bool(Buffer::ByteArray const&, sequence_number_t seqn)> processor;
+	processor_t processor;
 
-	StateKind state{StateKind::Initialized};
+	std::atomic<StateKind> state{StateKind::Initialized};
 	static std::shared_ptr<spdlog::logger> logger;
 
 	std::thread::id async_thread_id;
 	std::future<void> async_future;
 
-	std::vector<Buffer::ByteArray> data;
+	/**
+	 * \brief Packages put by any thread, moved to [queues] under [queue_lock] by the processing thread, or by a
+	 * producer looking for a lossy package to drop.
+	 */
+	util::bounded_queue<QueuedPackage> data{MAX_QUEUED_PACKAGES};
+	/**
+	 * \brief Set while the processing thread waits on [cv], producers only take [lock] to wake it then.
+	 */
+	std::atomic<bool> sleeping{false};
+
+	std::atomic<size_t> max_bytes{DEFAULT_MAX_BYTES};
+	/**
+	 * \brief Overflow policy of each lane, indexed by [Lane].
+	 */
+	std::array<std::atomic<OverflowPolicy>, LANE_COUNT> overflow_policies;
+	std::mutex overflow_lock;
+	std::condition_variable overflow_cv;
+	std::atomic<int32_t> blocked_producers{0};
+
+	std::atomic<size_t> queued_packages{0};
+	std::atomic<size_t> queued_bytes{0};
+	std::atomic<size_t> pending_packages{0};
+	std::atomic<size_t> pending_bytes{0};
+	std::atomic<uint64_t> dropped_packages{0};
+	std::atomic<uint64_t> rejected_packages{0};
+	std::atomic<uint64_t> blocked_puts{0};
+
 	std::mutex queue_lock;
-	std::deque<Buffer::ByteArray> queue{};
+	/**
+	 * \brief Packages not sent yet, one queue per [Lane].
+	 */
+	std::array<std::deque<QueuedPackage>, LANE_COUNT> queues{};
+	/**
+	 * \brief Sent packages in the order of their sequence numbers, kept until they are acknowledged.
+	 */
 	std::deque<Buffer::ByteArray> pending_queue{};
 
+	batch_t batch;
+	/**
+	 * \brief Lane of each package of [batch] filled by [fill_lane_batch].
+	 */
+	std::vector<Lane> batch_lanes;
+
 	sequence_number_t max_sent_seqn = 0;
 	sequence_number_t current_seqn = 1;
-	sequence_number_t acknowledged_seqn = 0;
+	std::atomic<sequence_number_t> acknowledged_seqn{0};
+
+	/**
+	 * \brief Set by [resume], the processing thread starts resending [pending_queue] then.
+	 */
+	std::atomic<bool> resend_pending{false};
+	/**
+	 * \brief Whether the processing thread resends [pending_queue], new packages wait until it's done.
+	 */
+	bool resending = false;
+	/**
+	 * \brief Whether resending waits for acknowledgements, because [RESEND_WINDOW_BYTES] are unacknowledged.
+	 */
+	bool resend_blocked = false;
+	/**
+	 * \brief Next seqn to resend.
+	 */
+	sequence_number_t resend_seqn = 0;
+	/**
+	 * \brief Resent bytes not acknowledged yet.
+	 */
+	size_t resent_bytes = 0;
 
 	int32_t interrupt_balance = 0;
 	bool in_processing = false;
@@ -69,7 +208,7 @@ private:
 public:
 	// region ctor/dtor
 
-	explicit ByteBufferAsyncProcessor(std::string id, std::function<bool(Buffer::ByteArray const&, sequence_number_t)> processor);
+	explicit ByteBufferAsyncProcessor(std::string id, processor_t processor);
 
 	// endregion
 private:
@@ -77,9 +216,61 @@ private:
 
 	bool terminate0(time_t timeout, StateKind state_to_set, string_view action);
 
-	void add_data(std::vector<Buffer::ByteArray>&& new_data);
-
-	bool reprocess();
+	/**
+	 * \brief Moves the packages of [data] to [queues].
+	 * \return whether [queues] hold packages to process
+	 */
+	bool add_data();
+
+	/**
+	 * \brief [add_data] for callers holding [queue_lock].
+	 */
+	bool add_data0();
+
+	/**
+	 * \brief Wakes the processing thread if it waits for data.
+	 */
+	void wake();
+
+	bool has_room(size_t size) const;
+
+	/**
+	 * \brief Drops the oldest lossy package of [lane] that hasn't been sent yet, unless the processing thread is busy
+	 * with the queued packages.
+	 * \return false if there is none to drop
+	 */
+	bool drop_oldest_lossy(Lane lane);
+
+	/**
+	 * \brief Called whenever bytes leave the processor, wakes producers blocked by [OverflowPolicy::Block].
+	 */
+	void on_bytes_released();
+
+	/**
+	 * \brief Drops acknowledged packages from [pending_queue] and hands their arrays back to [SendBufferPool].
+	 * Must be called under [queue_lock].
+	 */
+	void release_acknowledged();
+
+	/**
+	 * \brief Fills [batch] with packages starting at [begin] within the batch limits.
+	 * \return number of packages in the batch
+	 */
+	size_t fill_batch(std::deque<Buffer::ByteArray>::const_iterator begin, std::deque<Buffer::ByteArray>::const_iterator end);
+
+	/**
+	 * \brief Fills [batch] from the fronts of [queues] within the batch limits, taking up to [LANE_WEIGHTS] packages
+	 * of each lane per round. Packages of a lane keep their order.
+	 * \return number of packages in the batch
+	 */
+	size_t fill_lane_batch();
+
+	/**
+	 * \brief Resends [pending_queue] from [resend_seqn] as far as [RESEND_WINDOW_BYTES] allow. Must be called under
+	 * [queue_lock].
+	 * \return whether everything has been resent
+	 */
+	bool resend();
 
 	void process();
 
@@ -92,16 +283,40 @@ public:
 
 	bool terminate(time_t timeout = time_t(0) /*InfiniteDuration*/);
 
-	void put(Buffer::ByteArray new_data);
+	/**
+	 * \brief Limits the queued plus not yet acknowledged bytes, the limit is soft for a single package exceeding it.
+	 * [policy] applies to every lane.
+	 */
+	void set_limits(size_t max_bytes, OverflowPolicy policy);
+
+	/**
+	 * \brief Sets what [put] does for packages of [lane] while the byte limit is exceeded.
+	 */
+	void set_overflow_policy(Lane lane, OverflowPolicy policy);
+
+	/**
+	 * \brief Queues a package for processing in the given [lane], safe to call from any thread. A [lossy] package may
+	 * be dropped to make room for later lossy packages of the lane.
+	 * \return false if the lossy package was dropped or the processor is stopped, throws if [OverflowPolicy::Fail]
+	 * rejected the package
+	 */
+	bool put(Buffer::ByteArray new_data, Lane lane = Lane::Interactive, bool lossy = false);
+
+	Gauges get_gauges() const;
 
 	void pause(const std::string& reason);
 
+	/**
+	 * \brief Resumes processing, the processing thread resends the unacknowledged packages before any new one.
+	 */
 	void resume();
 
 	void acknowledge(int64_t seqn);
 };
 
 std::string to_string(ByteBufferAsyncProcessor::StateKind state);
+
+std::string to_string(ByteBufferAsyncProcessor::OverflowPolicy policy);
 }	 // namespace rd
 #if defined(_MSC_VER)
 #pragma warning(pop)
@@ -0,0 +1,273 @@
+#include "IoUring.h"
+
+#include <stdexcept>
+#include <string>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+// the operations used arrived along with fast poll, older headers lack them
+#ifdef IORING_FEAT_FAST_POLL
+#define RD_IO_URING_AVAILABLE
+#endif
+#endif
+#endif
+
+#ifdef RD_IO_URING_AVAILABLE
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+// the system call numbers are the same on all architectures but alpha
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup 425
+#endif
+#ifndef __NR_io_uring_enter
+#define __NR_io_uring_enter 426
+#endif
+#ifndef __NR_io_uring_register
+#define __NR_io_uring_register 427
+#endif
+#endif
+
+namespace rd
+{
+#ifdef RD_IO_URING_AVAILABLE
+
+namespace
+{
+void unmap(void*& address, size_t size)
+{
+	if (address != nullptr && address != MAP_FAILED)
+	{
+		munmap(address, size);
+	}
+	address = nullptr;
+}
+
+void* map(int fd, size_t size, off_t offset)
+{
+	return mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+}
+}	 // namespace
+
+IoUring::IoUring(unsigned entries)
+{
+	io_uring_params params{};
+	ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+	if (ring_fd < 0)
+	{
+		throw std::runtime_error("IoUring: setup failed, errno: " + std::to_string(errno));
+	}
+
+	sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (single_mmap)
+	{
+		sq_ring_size = cq_ring_size = (std::max)(sq_ring_size, cq_ring_size);
+	}
+	sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+	sq_ring = map(ring_fd, sq_ring_size, IORING_OFF_SQ_RING);
+	cq_ring = single_mmap ? sq_ring : map(ring_fd, cq_ring_size, IORING_OFF_CQ_RING);
+	sqes = map(ring_fd, sqes_size, IORING_OFF_SQES);
+	if (sq_ring == MAP_FAILED || cq_ring == MAP_FAILED || sqes == MAP_FAILED)
+	{
+		const int error = errno;
+		release();
+		throw std::runtime_error("IoUring: failed to map the rings, errno: " + std::to_string(error));
+	}
+
+	auto* sq = static_cast<char*>(sq_ring);
+	sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+	sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+	sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+	auto* cq = static_cast<char*>(cq_ring);
+	cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+	cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+	cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+	cqes = cq + params.cq_off.cqes;
+}
+
+IoUring::~IoUring()
+{
+	release();
+}
+
+void IoUring::release()
+{
+	unmap(sqes, sqes_size);
+	if (cq_ring != sq_ring)
+	{
+		unmap(cq_ring, cq_ring_size);
+	}
+	cq_ring = nullptr;
+	unmap(sq_ring, sq_ring_size);
+	if (ring_fd >= 0)
+	{
+		close(ring_fd);
+		ring_fd = -1;
+	}
+}
+
+bool IoUring::is_supported()
+{
+	static const bool supported = [] {
+		try
+		{
+			IoUring ring(2);
+			constexpr unsigned OPS = 256;
+			std::vector<char> storage(sizeof(io_uring_probe) + OPS * sizeof(io_uring_probe_op));
+			auto* probe = reinterpret_cast<io_uring_probe*>(storage.data());
+			if (syscall(__NR_io_uring_register, ring.ring_fd, IORING_REGISTER_PROBE, probe, OPS) < 0)
+			{
+				return false;
+			}
+			for (const unsigned op : {IORING_OP_RECV, IORING_OP_READ_FIXED, IORING_OP_SENDMSG})
+			{
+				if (op > probe->last_op || (probe->ops[op].flags & IO_URING_OP_SUPPORTED) == 0)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+		catch (std::exception const&)
+		{
+			return false;
+		}
+	}();
+	return supported;
+}
+
+template <typename F>
+int32_t IoUring::run(F&& prepare)
+{
+	// a single operation is in flight at a time, so the submission queue never overflows
+	const unsigned tail = *sq_tail;
+	const unsigned index = tail & sq_mask;
+	auto* sqe = static_cast<io_uring_sqe*>(sqes) + index;
+	memset(sqe, 0, sizeof(*sqe));
+	prepare(*sqe);
+	sq_array[index] = index;
+	__atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+	unsigned to_submit = 1;
+	while (true)
+	{
+		const unsigned head = *cq_head;
+		if (head != __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE))
+		{
+			const int32_t result = static_cast<io_uring_cqe*>(cqes)[head & cq_mask].res;
+			__atomic_store_n(cq_head, head + 1, __ATOMIC_RELEASE);
+			return result;
+		}
+		// submits the entry and waits for its completion with the same call
+		const long submitted = syscall(__NR_io_uring_enter, ring_fd, to_submit, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+		if (submitted < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			return -errno;
+		}
+		to_submit -= (std::min)(to_submit, static_cast<unsigned>(submitted));
+	}
+}
+
+bool IoUring::register_buffers(iovec const* buffers, unsigned count)
+{
+	if (registered_buffers > 0)
+	{
+		syscall(__NR_io_uring_register, ring_fd, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+		registered_buffers = 0;
+	}
+	if (syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_BUFFERS, buffers, count) < 0)
+	{
+		return false;
+	}
+	registered_buffers = count;
+	return true;
+}
+
+int32_t IoUring::receive(int fd, void* data, size_t size, int32_t buffer_index)
+{
+	return run([&](io_uring_sqe& sqe) {
+		if (buffer_index >= 0 && static_cast<unsigned>(buffer_index) < registered_buffers)
+		{
+			// offsets don't apply to sockets
+			sqe.opcode = IORING_OP_READ_FIXED;
+			sqe.buf_index = static_cast<uint16_t>(buffer_index);
+		}
+		else
+		{
+			sqe.opcode = IORING_OP_RECV;
+		}
+		sqe.fd = fd;
+		sqe.addr = reinterpret_cast<uint64_t>(data);
+		sqe.len = static_cast<uint32_t>(size);
+	});
+}
+
+int32_t IoUring::send(int fd, iovec const* vector, int32_t count)
+{
+	msghdr message{};
+	message.msg_iov = const_cast<iovec*>(vector);
+	message.msg_iovlen = static_cast<size_t>(count);
+	return run([&](io_uring_sqe& sqe) {
+		sqe.opcode = IORING_OP_SENDMSG;
+		sqe.fd = fd;
+		sqe.addr = reinterpret_cast<uint64_t>(&message);
+		sqe.len = 1;
+		sqe.msg_flags = MSG_NOSIGNAL;
+	});
+}
+
+#else
+
+IoUring::IoUring(unsigned)
+{
+	throw std::logic_error("IoUring is only supported on Linux");
+}
+
+IoUring::~IoUring() = default;
+
+void IoUring::release()
+{
+}
+
+bool IoUring::is_supported()
+{
+	return false;
+}
+
+bool IoUring::register_buffers(iovec const*, unsigned)
+{
+	return false;
+}
+
+int32_t IoUring::receive(int, void*, size_t, int32_t)
+{
+	return -1;
+}
+
+int32_t IoUring::send(int, iovec const*, int32_t)
+{
+	return -1;
+}
+
+#endif
+
+unsigned IoUring::get_registered_buffers() const
+{
+	return registered_buffers;
+}
+}	 // namespace rd
@@ -0,0 +1,96 @@
+#ifndef RD_CPP_IOURING_H
+#define RD_CPP_IOURING_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <rd_framework_export.h>
+
+struct iovec;
+
+namespace rd
+{
+/**
+ * \brief Minimal io_uring instance driven by the raw system calls, each operation is submitted and waited for by a
+ * single call into the kernel. Not thread-safe, every thread performing I/O needs its own instance.
+ * Only available on Linux kernels providing the operations used, [is_supported] tells whether it can be used.
+ */
+class RD_FRAMEWORK_API IoUring
+{
+	int ring_fd = -1;
+
+	void* sq_ring = nullptr;
+	size_t sq_ring_size = 0;
+	void* cq_ring = nullptr;
+	size_t cq_ring_size = 0;
+	void* sqes = nullptr;
+	size_t sqes_size = 0;
+
+	unsigned* sq_tail = nullptr;
+	unsigned* sq_array = nullptr;
+	unsigned sq_mask = 0;
+	unsigned* cq_head = nullptr;
+	unsigned* cq_tail = nullptr;
+	unsigned cq_mask = 0;
+	void* cqes = nullptr;
+
+	unsigned registered_buffers = 0;
+
+	/**
+	 * \brief Unmaps the rings and closes the instance, also after a partially failed setup.
+	 */
+	void release();
+
+	/**
+	 * \brief Submits the operation [prepare] wrote into the next submission entry and waits for its completion.
+	 * \return result of the operation, negated errno on failure
+	 */
+	template <typename F>
+	int32_t run(F&& prepare);
+
+public:
+	// region ctor/dtor
+
+	/**
+	 * \brief Sets up a ring of [entries] submission entries, throws if the kernel refuses.
+	 */
+	explicit IoUring(unsigned entries);
+
+	IoUring(IoUring const&) = delete;
+
+	IoUring& operator=(IoUring const&) = delete;
+
+	~IoUring();
+
+	// endregion
+
+	/**
+	 * \brief Whether the kernel provides io_uring with all operations used, probed once.
+	 */
+	static bool is_supported();
+
+	/**
+	 * \brief Registers [count] buffers, replacing the ones registered before. Receiving into a registered buffer
+	 * spares the kernel mapping its pages for every operation. Only allowed while no operation is in flight.
+	 * \return false if the kernel refused, no buffers are registered then
+	 */
+	bool register_buffers(iovec const* buffers, unsigned count);
+
+	unsigned get_registered_buffers() const;
+
+	/**
+	 * \brief Receives up to [size] bytes from the stream socket [fd] into [data], which lies within the registered buffer
+	 * [buffer_index] unless it is negative.
+	 * \return bytes received, 0 once the counterpart shut the connection down, negated errno on failure
+	 */
+	int32_t receive(int fd, void* data, size_t size, int32_t buffer_index);
+
+	/**
+	 * \brief Sends [count] buffers of [vector] to the socket [fd] with a single operation.
+	 * \return bytes sent, which may be less than requested, negated errno on failure
+	 */
+	int32_t send(int fd, iovec const* vector, int32_t count);
+};
+}	 // namespace rd
+
+#endif	  // RD_CPP_IOURING_H
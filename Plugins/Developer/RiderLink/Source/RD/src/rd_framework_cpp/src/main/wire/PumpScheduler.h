@@ -42,6 +42,8 @@ public:
 
 	void flush() override;
 
+	using IScheduler::queue;
+
 	void queue(std::function<void()> action) override;
 
 	bool is_active() const override;
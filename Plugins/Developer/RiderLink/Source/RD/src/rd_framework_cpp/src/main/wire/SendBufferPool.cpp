@@ -0,0 +1,71 @@
+#include "SendBufferPool.h"
+
+namespace rd
+{
+constexpr size_t SendBufferPool::MIN_CLASS_SHIFT;
+constexpr size_t SendBufferPool::MAX_CLASS_SHIFT;
+constexpr size_t SendBufferPool::CLASS_BYTE_BUDGET;
+
+SendBufferPool::SendBufferPool()
+{
+	for (size_t i = 0; i < CLASS_COUNT; ++i)
+	{
+		const size_t class_size = size_t{1} << (MIN_CLASS_SHIFT + i);
+		classes[i] = std::make_unique<util::bounded_queue<Buffer::ByteArray>>((std::max)(CLASS_BYTE_BUDGET / class_size, size_t{4}));
+	}
+}
+
+SendBufferPool& SendBufferPool::instance()
+{
+	static SendBufferPool pool;
+	return pool;
+}
+
+size_t SendBufferPool::class_of_capacity(size_t capacity)
+{
+	size_t shift = MIN_CLASS_SHIFT;
+	while (shift < MAX_CLASS_SHIFT && (size_t{1} << (shift + 1)) <= capacity)
+	{
+		++shift;
+	}
+	return shift - MIN_CLASS_SHIFT;
+}
+
+size_t SendBufferPool::class_of_request(size_t size)
+{
+	size_t shift = MIN_CLASS_SHIFT;
+	while (shift < MAX_CLASS_SHIFT && (size_t{1} << shift) < size)
+	{
+		++shift;
+	}
+	return shift - MIN_CLASS_SHIFT;
+}
+
+Buffer::ByteArray SendBufferPool::acquire(size_t min_size)
+{
+	const size_t first = class_of_request(min_size);
+	Buffer::ByteArray result;
+	// a slightly bigger array is better than a fresh allocation
+	for (size_t i = first; i < (std::min)(first + 2, CLASS_COUNT); ++i)
+	{
+		if (classes[i]->try_pop(result))
+		{
+			result.resize(result.capacity());
+			return result;
+		}
+	}
+	result.resize((std::max)(min_size, size_t{1} << (MIN_CLASS_SHIFT + first)));
+	return result;
+}
+
+void SendBufferPool::release(Buffer::ByteArray&& array)
+{
+	const size_t capacity = array.capacity();
+	if (capacity < (size_t{1} << MIN_CLASS_SHIFT) || capacity >= (size_t{2} << MAX_CLASS_SHIFT))
+	{
+		return;
+	}
+	Buffer::ByteArray released = std::move(array);
+	classes[class_of_capacity(capacity)]->try_push(released);
+}
+}	 // namespace rd
@@ -0,0 +1,74 @@
+#ifndef RD_CPP_SENDBUFFERPOOL_H
+#define RD_CPP_SENDBUFFERPOOL_H
+
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable:4251)
+#endif
+
+#include "protocol/Buffer.h"
+#include "util/bounded_queue.h"
+
+#include <array>
+#include <memory>
+
+#include <rd_framework_export.h>
+
+namespace rd
+{
+/**
+ * \brief Process wide pool of byte arrays for outgoing messages.
+ * Arrays are kept in power of two size classes, each class is a lock-free bounded queue. An array is taken by
+ * [SocketWire::Base::send] and returned by [ByteBufferAsyncProcessor] once the counterpart acknowledged it, so
+ * sending at a steady rate doesn't allocate.
+ */
+class RD_FRAMEWORK_API SendBufferPool
+{
+public:
+	static constexpr size_t MIN_CLASS_SHIFT = 8;
+	static constexpr size_t MAX_CLASS_SHIFT = 20;
+	/**
+	 * \brief Bytes each size class may keep, small classes keep more arrays than big ones.
+	 */
+	static constexpr size_t CLASS_BYTE_BUDGET = 4u << 20;
+
+private:
+	static constexpr size_t CLASS_COUNT = MAX_CLASS_SHIFT - MIN_CLASS_SHIFT + 1;
+
+	std::array<std::unique_ptr<util::bounded_queue<Buffer::ByteArray>>, CLASS_COUNT> classes;
+
+	static size_t class_of_capacity(size_t capacity);
+
+	static size_t class_of_request(size_t size);
+
+public:
+	// region ctor/dtor
+
+	SendBufferPool();
+
+	SendBufferPool(SendBufferPool const&) = delete;
+
+	SendBufferPool& operator=(SendBufferPool const&) = delete;
+
+	// endregion
+
+	static SendBufferPool& instance();
+
+	/**
+	 * \brief Takes an array from the pool, or allocates one if the pool has none of a fitting size.
+	 * \param min_size size the array should have at least, only a hint as [Buffer] grows on demand
+	 * \return array whose size equals its capacity
+	 */
+	Buffer::ByteArray acquire(size_t min_size);
+
+	/**
+	 * \brief Returns an array to the pool, it is freed if it doesn't fit any size class or its class is full.
+	 */
+	void release(Buffer::ByteArray&& array);
+};
+}	 // namespace rd
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+#endif	  // RD_CPP_SENDBUFFERPOOL_H
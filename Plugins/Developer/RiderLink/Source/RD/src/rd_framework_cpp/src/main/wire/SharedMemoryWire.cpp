@@ -0,0 +1,712 @@
+#include "wire/SharedMemoryWire.h"
+#include "wire/SendBufferPool.h"
+
+#include <util/thread_util.h>
+
+#include "spdlog/sinks/stdout_color_sinks.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <ctime>
+#endif
+
+namespace rd
+{
+/**
+ * \brief Header of the mapped segment, the two rings follow it. Ring 0 is written by the server, ring 1 by the client.
+ */
+struct SharedMemoryWire::Segment
+{
+	static constexpr uint32_t MAGIC = 0x48534452;	 // RDSH
+	static constexpr uint32_t VERSION = 1;
+	static constexpr uint64_t RING_CAPACITY = 4 * 1024 * 1024;
+
+	enum State : uint32_t
+	{
+		Waiting,
+		Attaching,
+		Attached,
+		Detached
+	};
+
+	/**
+	 * \brief Positions are byte counts since the rings were reset, the signals are the futex words.
+	 */
+	struct alignas(64) Ring
+	{
+		alignas(64) std::atomic<uint64_t> head{0};
+		alignas(64) std::atomic<uint64_t> tail{0};
+		alignas(64) std::atomic<uint32_t> data_signal{0};
+		std::atomic<uint32_t> reader_waiting{0};
+		std::atomic<uint32_t> space_signal{0};
+		std::atomic<uint32_t> writer_waiting{0};
+	};
+
+	uint32_t magic = MAGIC;
+	uint32_t version = VERSION;
+	uint64_t ring_capacity = RING_CAPACITY;
+	alignas(64) std::atomic<uint32_t> state{Waiting};
+	/**
+	 * \brief Milliseconds of the monotonic clock at which each side was seen running the last time.
+	 */
+	std::atomic<int64_t> timestamps[2]{};
+	Ring rings[2];
+
+	static constexpr size_t size()
+	{
+		return sizeof(Segment) + 2 * RING_CAPACITY;
+	}
+
+	Buffer::word_t* ring_data(int index)
+	{
+		return reinterpret_cast<Buffer::word_t*>(this + 1) + index * RING_CAPACITY;
+	}
+};
+
+namespace
+{
+/**
+ * \brief Longest a reader or writer sleeps before it checks the counterpart and its own lifetime again.
+ */
+constexpr std::chrono::milliseconds WAIT_SLICE{100};
+/**
+ * \brief A side which hasn't updated its timestamp for this long is considered gone.
+ */
+constexpr int64_t DEAD_TIMEOUT_MS = 3000;
+
+int64_t now_ms()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch())
+		.count();
+}
+
+void futex_wait(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::milliseconds timeout)
+{
+#ifdef __linux__
+	static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be a plain 32-bit integer");
+	timespec ts{static_cast<time_t>(timeout.count() / 1000), static_cast<long>((timeout.count() % 1000) * 1000000)};
+	// not FUTEX_PRIVATE_FLAG, the word is shared with another process
+	syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &ts, nullptr, 0);
+#else
+	(void) word;
+	(void) expected;
+	(void) timeout;
+#endif
+}
+
+void futex_wake(std::atomic<uint32_t>& word)
+{
+#ifdef __linux__
+	syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#else
+	(void) word;
+#endif
+}
+
+void notify(std::atomic<uint32_t>& word, std::atomic<uint32_t> const& waiting)
+{
+	// the waiter announces itself before it checks the positions, either side sees the other
+	word.fetch_add(1);
+	if (waiting.load() != 0)
+	{
+		futex_wake(word);
+	}
+}
+}	 // namespace
+
+std::chrono::milliseconds SharedMemoryWire::timeout = std::chrono::milliseconds(500);
+
+std::shared_ptr<spdlog::logger> SharedMemoryWire::Base::logger =
+	spdlog::stderr_color_mt<spdlog::synchronous_factory>("shmWireLog", spdlog::color_mode::automatic);
+
+constexpr int32_t SharedMemoryWire::Base::ACK_MESSAGE_LENGTH;
+constexpr int32_t SharedMemoryWire::Base::PACKAGE_HEADER_LENGTH;
+constexpr int32_t SharedMemoryWire::Base::ACK_PACKAGE_THRESHOLD;
+constexpr size_t SharedMemoryWire::Base::SEND_BUFFER_SIZE;
+constexpr size_t SharedMemoryWire::Base::RECEIVE_BLOCK_SIZE;
+
+bool SharedMemoryWire::is_supported()
+{
+#ifdef __linux__
+	return true;
+#else
+	return false;
+#endif
+}
+
+SharedMemoryWire::Base::Base(std::string id, Lifetime parentLifetime, IScheduler* scheduler, int side)
+	: WireBase(scheduler), id(std::move(id)), side(side), lifetimeDef(parentLifetime)
+{
+	if (!is_supported())
+	{
+		throw std::logic_error("SharedMemoryWire isn't supported on this platform");
+	}
+	async_send_buffer.pause("initial");
+	async_send_buffer.start();
+}
+
+SharedMemoryWire::Base::~Base()
+{
+	if (!lifetimeDef.is_terminated())
+	{
+		lifetimeDef.terminate();
+	}
+}
+
+void SharedMemoryWire::Base::map_segment(void* address, size_t size)
+{
+	segment = static_cast<Segment*>(address);
+	segment_size = size;
+	send_ring = segment->ring_data(side);
+	receive_ring = segment->ring_data(1 - side);
+}
+
+void SharedMemoryWire::Base::unmap_segment()
+{
+#ifdef __linux__
+	if (segment != nullptr)
+	{
+		munmap(segment, segment_size);
+	}
+#endif
+	segment = nullptr;
+	send_ring = receive_ring = nullptr;
+}
+
+bool SharedMemoryWire::Base::counterpart_alive() const
+{
+	return !terminating.load(std::memory_order_relaxed) && segment->state.load() == Segment::Attached &&
+		   now_ms() - segment->timestamps[1 - side].load(std::memory_order_relaxed) < DEAD_TIMEOUT_MS;
+}
+
+void SharedMemoryWire::Base::update_timestamp() const
+{
+	segment->timestamps[side].store(now_ms(), std::memory_order_relaxed);
+}
+
+bool SharedMemoryWire::Base::write_ring(Buffer::word_t const* data, size_t size) const
+{
+	auto& ring = segment->rings[side];
+	while (size > 0)
+	{
+		const size_t free = Segment::RING_CAPACITY - static_cast<size_t>(send_head - ring.tail.load(std::memory_order_acquire));
+		if (free == 0)
+		{
+			// let the counterpart drain what has been written so far
+			publish_ring();
+			ring.writer_waiting.store(1);
+			const uint32_t space_signal = ring.space_signal.load();
+			if (send_head - ring.tail.load() == Segment::RING_CAPACITY)
+			{
+				futex_wait(ring.space_signal, space_signal, WAIT_SLICE);
+			}
+			ring.writer_waiting.store(0, std::memory_order_relaxed);
+			if (!counterpart_alive())
+			{
+				return false;
+			}
+			continue;
+		}
+
+		const size_t count = (std::min)(free, size);
+		const size_t offset = static_cast<size_t>(send_head & (Segment::RING_CAPACITY - 1));
+		const size_t first = (std::min)(count, static_cast<size_t>(Segment::RING_CAPACITY) - offset);
+		memcpy(send_ring + offset, data, first);
+		memcpy(send_ring, data + first, count - first);
+		send_head += count;
+		data += count;
+		size -= count;
+	}
+	return true;
+}
+
+void SharedMemoryWire::Base::publish_ring() const
+{
+	auto& ring = segment->rings[side];
+	if (ring.head.load(std::memory_order_relaxed) != send_head)
+	{
+		ring.head.store(send_head, std::memory_order_release);
+		notify(ring.data_signal, ring.reader_waiting);
+	}
+}
+
+bool SharedMemoryWire::Base::read_ring(Buffer::word_t* data, size_t size) const
+{
+	auto& ring = segment->rings[1 - side];
+	uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+	while (size > 0)
+	{
+		const size_t available = static_cast<size_t>(ring.head.load(std::memory_order_acquire) - tail);
+		if (available == 0)
+		{
+			// nothing else is going to be read soon, so acknowledge what has been received so far
+			flush_ack();
+			update_timestamp();
+			ring.reader_waiting.store(1);
+			const uint32_t data_signal = ring.data_signal.load();
+			if (ring.head.load() == tail)
+			{
+				futex_wait(ring.data_signal, data_signal, WAIT_SLICE);
+			}
+			ring.reader_waiting.store(0, std::memory_order_relaxed);
+			if (!counterpart_alive())
+			{
+				return false;
+			}
+			continue;
+		}
+
+		const size_t count = (std::min)(available, size);
+		const size_t offset = static_cast<size_t>(tail & (Segment::RING_CAPACITY - 1));
+		const size_t first = (std::min)(count, static_cast<size_t>(Segment::RING_CAPACITY) - offset);
+		memcpy(data, receive_ring + offset, first);
+		memcpy(data + first, receive_ring, count - first);
+		tail += count;
+		data += count;
+		size -= count;
+		ring.tail.store(tail, std::memory_order_release);
+		notify(ring.space_signal, ring.writer_waiting);
+	}
+	return true;
+}
+
+void SharedMemoryWire::Base::send(RdId const& rd_id, std::function<void(Buffer& buffer)> writer) const
+{
+	send(rd_id, std::move(writer), Lane::Interactive);
+}
+
+void SharedMemoryWire::Base::send(RdId const& rd_id, std::function<void(Buffer& buffer)> writer, Lane lane) const
+{
+	send(rd_id, std::move(writer), lane, false);
+}
+
+void SharedMemoryWire::Base::send(RdId const& rd_id, std::function<void(Buffer& buffer)> writer, Lane lane, bool lossy) const
+{
+	RD_ASSERT_MSG(!rd_id.isNull(), "{}: id mustn't be null");
+
+	Buffer buffer(SendBufferPool::instance().acquire(send_buffer_hint.load(std::memory_order_relaxed)));
+	buffer.write_integral<int32_t>(0);	  // placeholder for length
+
+	rd_id.write(buffer);				  // write id
+	buffer.write_integral<int16_t>(0);	  // placeholder for context
+	writer(buffer);						  // write rest
+
+	int32_t len = static_cast<int32_t>(buffer.get_position());
+
+	buffer.rewind();
+	buffer.write_integral<int32_t>(len - 4);
+	buffer.set_position(static_cast<size_t>(len));
+	send_buffer_hint.store(static_cast<size_t>(len), std::memory_order_relaxed);
+	// the array goes back to the pool once the counterpart acknowledged it
+	if (!async_send_buffer.put(std::move(buffer).getRealArray(), lane, lossy))
+	{
+		logger->debug("{}: message for {} was dropped", this->id, to_string(rd_id));
+	}
+}
+
+void SharedMemoryWire::Base::set_send_queue_limits(size_t max_bytes, ByteBufferAsyncProcessor::OverflowPolicy policy) const
+{
+	async_send_buffer.set_limits(max_bytes, policy);
+}
+
+void SharedMemoryWire::Base::set_send_queue_overflow_policy(Lane lane, ByteBufferAsyncProcessor::OverflowPolicy policy) const
+{
+	async_send_buffer.set_overflow_policy(lane, policy);
+}
+
+ByteBufferAsyncProcessor::Gauges SharedMemoryWire::Base::get_send_queue_gauges() const
+{
+	return async_send_buffer.get_gauges();
+}
+
+bool SharedMemoryWire::Base::send0(ByteBufferAsyncProcessor::batch_t const& batch, sequence_number_t first_seqn) const
+{
+	std::lock_guard<decltype(send_lock)> guard(send_lock);
+	if (segment == nullptr || !counterpart_alive())
+	{
+		return false;
+	}
+
+	const sequence_number_t ack = ack_seqn_to_send.exchange(0);
+	if (ack > 0)
+	{
+		memcpy(ack_header.data(), &ACK_MESSAGE_LENGTH, sizeof(ACK_MESSAGE_LENGTH));
+		memcpy(ack_header.data() + sizeof(ACK_MESSAGE_LENGTH), &ack, sizeof(ack));
+		if (!write_ring(ack_header.data(), ack_header.size()))
+		{
+			return false;
+		}
+	}
+
+	send_package_headers.resize(batch.size() * PACKAGE_HEADER_LENGTH);
+	for (size_t i = 0; i < batch.size(); ++i)
+	{
+		auto const& package = *batch[i];
+		const int32_t len = static_cast<int32_t>(package.size());
+		const sequence_number_t seqn = first_seqn + static_cast<sequence_number_t>(i);
+		Buffer::word_t* header = send_package_headers.data() + i * PACKAGE_HEADER_LENGTH;
+		memcpy(header, &len, sizeof(len));
+		memcpy(header + sizeof(len), &seqn, sizeof(seqn));
+		if (!write_ring(header, PACKAGE_HEADER_LENGTH) || !write_ring(package.data(), package.size()))
+		{
+			logger->debug("{}: connection lost while sending package {}", this->id, seqn);
+			return false;
+		}
+	}
+	publish_ring();
+	return true;
+}
+
+bool SharedMemoryWire::Base::flush_ack() const
+{
+	unacked_packages = 0;
+	if (ack_seqn_to_send.load() == 0)
+	{
+		return true;
+	}
+	// the processor thread might wait for the counterpart's receiver, which in turn might wait for this one;
+	// while it holds the lock it takes the pending ack along with its next batch anyway
+	std::unique_lock<decltype(send_lock)> guard(send_lock, std::try_to_lock);
+	if (!guard.owns_lock())
+	{
+		return true;
+	}
+	const sequence_number_t seqn = ack_seqn_to_send.exchange(0);
+	if (seqn == 0)
+	{
+		return true;
+	}
+	logger->trace("{} send ack {}", id, seqn);
+	memcpy(ack_header.data(), &ACK_MESSAGE_LENGTH, sizeof(ACK_MESSAGE_LENGTH));
+	memcpy(ack_header.data() + sizeof(ACK_MESSAGE_LENGTH), &seqn, sizeof(seqn));
+	if (!write_ring(ack_header.data(), ack_header.size()))
+	{
+		return false;
+	}
+	publish_ring();
+	return true;
+}
+
+bool SharedMemoryWire::Base::read_package() const
+{
+	update_timestamp();
+	std::array<Buffer::word_t, PACKAGE_HEADER_LENGTH> header{};
+	if (!read_ring(header.data(), header.size()))
+	{
+		return false;
+	}
+	int32_t len = 0;
+	sequence_number_t seqn = 0;
+	memcpy(&len, header.data(), sizeof(len));
+	memcpy(&seqn, header.data() + sizeof(len), sizeof(seqn));
+	if (len == ACK_MESSAGE_LENGTH)
+	{
+		async_send_buffer.acknowledge(seqn);
+		return true;
+	}
+	RD_ASSERT_THROW_MSG(len >= 0, fmt::format("{}: invalid package length: {}", this->id, len));
+
+	if (receive_block.use_count() == 1)
+	{
+		receive_block_used = 0;
+	}
+	if (receive_block == nullptr || receive_block->size() - receive_block_used < static_cast<size_t>(len))
+	{
+		receive_block = std::make_shared<Buffer::ByteArray>((std::max)(RECEIVE_BLOCK_SIZE, static_cast<size_t>(len)));
+		receive_block_used = 0;
+	}
+	Buffer::word_t* package = receive_block->data() + receive_block_used;
+	if (!read_ring(package, static_cast<size_t>(len)))
+	{
+		return false;
+	}
+
+	logger->debug("{}: read len={}, seqn={}, max_received_seqn={}", this->id, len, seqn, max_received_seqn);
+	if (seqn <= max_received_seqn && seqn != 1)
+	{
+		return true;
+	}
+	max_received_seqn = seqn;
+
+	// packages written by [send0] consist of whole messages
+	size_t position = 0;
+	while (position < static_cast<size_t>(len))
+	{
+		int32_t sz = 0;
+		RdId::hash_t message_id = 0;
+		RD_ASSERT_THROW_MSG(position + sizeof(sz) + sizeof(message_id) <= static_cast<size_t>(len),
+			fmt::format("{}: truncated message header in package {}", this->id, seqn));
+		memcpy(&sz, package + position, sizeof(sz));
+		memcpy(&message_id, package + position + sizeof(sz), sizeof(message_id));
+		const size_t begin = position + sizeof(sz) + sizeof(message_id);
+		const size_t size = static_cast<size_t>(sz) - sizeof(message_id);
+		RD_ASSERT_THROW_MSG(sz >= static_cast<int32_t>(sizeof(message_id)) && begin + size <= static_cast<size_t>(len),
+			fmt::format("{}: invalid message size {} in package {}", this->id, sz, seqn));
+		message_broker.dispatch(RdId(message_id), Buffer(receive_block, receive_block_used + begin, size));
+		position = begin + size;
+	}
+	receive_block_used += static_cast<size_t>(len);
+
+	ack_seqn_to_send.store(max_received_seqn);
+	if (++unacked_packages >= ACK_PACKAGE_THRESHOLD)
+	{
+		flush_ack();
+	}
+	return true;
+}
+
+void SharedMemoryWire::Base::run_connection() const
+{
+	update_timestamp();
+	{
+		std::lock_guard<decltype(send_lock)> guard(send_lock);
+		send_head = segment->rings[side].head.load();
+	}
+	logger->info("{}: connected", this->id);
+
+	async_send_buffer.resume();
+	heartbeatAlive.set(true);
+	connected.set(true);
+
+	try
+	{
+		while (read_package())
+		{
+		}
+	}
+	catch (std::exception const& ex)
+	{
+		logger->error("{} caught processing | {}", this->id, ex.what());
+	}
+
+	connected.set(false);
+	heartbeatAlive.set(false);
+	async_send_buffer.pause("Disconnected");
+	logger->info("{}: disconnected", this->id);
+}
+
+void SharedMemoryWire::Base::wake_all() const
+{
+	if (segment == nullptr)
+	{
+		return;
+	}
+	futex_wake(segment->state);
+	for (auto& ring : segment->rings)
+	{
+		futex_wake(ring.data_signal);
+		futex_wake(ring.space_signal);
+	}
+}
+
+SharedMemoryWire::Client::Client(Lifetime parentLifetime, IScheduler* scheduler, std::string name, const std::string& id)
+	: Base(id, parentLifetime, scheduler, 1), name(std::move(name)), clientLifetimeDefinition(parentLifetime)
+{
+	Lifetime lifetime = clientLifetimeDefinition.lifetime;
+	thread = std::thread([this, lifetime]() mutable {
+		rd::util::set_thread_name(this->id.empty() ? "SharedMemoryWire::Client Thread" : this->id.c_str());
+
+		while (!lifetime->is_terminated())
+		{
+			if (attach())
+			{
+				run_connection();
+				detach();
+			}
+			std::unique_lock<decltype(lock)> guard(lock);
+			if (!lifetime->is_terminated())
+			{
+				cv.wait_for(guard, timeout);
+			}
+		}
+		logger->debug("{}: thread expired", this->id);
+	});
+
+	lifetime->add_action([this]() {
+		logger->info("{}: starts terminating lifetime", this->id);
+
+		const bool send_buffer_stopped = async_send_buffer.stop(timeout);
+		logger->debug("{}: send buffer stopped, success: {}", this->id, send_buffer_stopped);
+
+		{
+			std::lock_guard<decltype(lock)> guard(lock);
+			terminating = true;
+			wake_all();
+		}
+		cv.notify_all();
+
+		thread.join();
+		logger->info("{}: termination finished", this->id);
+	});
+}
+
+SharedMemoryWire::Client::~Client()
+{
+	if (!clientLifetimeDefinition.is_terminated())
+	{
+		clientLifetimeDefinition.terminate();
+	}
+}
+
+bool SharedMemoryWire::Client::attach()
+{
+#ifdef __linux__
+	const int fd = shm_open(name.c_str(), O_RDWR, 0);
+	if (fd == -1)
+	{
+		logger->debug("{}: failed to open segment {}, errno: {}", this->id, name, errno);
+		return false;
+	}
+	struct stat st{};
+	void* address = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) == Segment::size())
+	{
+		address = mmap(nullptr, Segment::size(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	}
+	close(fd);
+	if (address == MAP_FAILED)
+	{
+		logger->error("{}: failed to map segment {}", this->id, name);
+		return false;
+	}
+
+	std::lock_guard<decltype(lock)> guard(lock);
+	map_segment(address, Segment::size());
+	if (segment->magic != Segment::MAGIC || segment->version != Segment::VERSION ||
+		segment->ring_capacity != Segment::RING_CAPACITY)
+	{
+		logger->error("{}: segment {} has an incompatible layout", this->id, name);
+		unmap_segment();
+		return false;
+	}
+
+	update_timestamp();
+	uint32_t expected = Segment::Waiting;
+	if (!segment->state.compare_exchange_strong(expected, Segment::Attaching))
+	{
+		logger->debug("{}: segment {} is in use, state: {}", this->id, name, expected);
+		unmap_segment();
+		return false;
+	}
+	// neither side touches the rings until the state is attached
+	for (auto& ring : segment->rings)
+	{
+		ring.head.store(0, std::memory_order_relaxed);
+		ring.tail.store(0, std::memory_order_relaxed);
+	}
+	segment->state.store(Segment::Attached);
+	futex_wake(segment->state);
+	logger->info("{}: attached to {}", this->id, name);
+	return true;
+#else
+	return false;
+#endif
+}
+
+void SharedMemoryWire::Client::detach()
+{
+	std::lock_guard<decltype(lock)> guard(lock);
+	uint32_t expected = Segment::Attached;
+	segment->state.compare_exchange_strong(expected, Segment::Detached);
+	wake_all();
+	unmap_segment();
+}
+
+SharedMemoryWire::Server::Server(Lifetime parentLifetime, IScheduler* scheduler, const std::string& id)
+	: Base(id, parentLifetime, scheduler, 0), serverLifetimeDefinition(parentLifetime)
+{
+#ifdef __linux__
+	static std::atomic<uint32_t> counter{0};
+	name = "/rd-" + std::to_string(getpid()) + "-" + std::to_string(counter++);
+	const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+	RD_ASSERT_THROW_MSG(fd != -1, fmt::format("{}: failed to create segment {}, errno: {}", this->id, name, errno));
+	void* address = MAP_FAILED;
+	if (ftruncate(fd, static_cast<off_t>(Segment::size())) == 0)
+	{
+		address = mmap(nullptr, Segment::size(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	}
+	close(fd);
+	if (address == MAP_FAILED)
+	{
+		shm_unlink(name.c_str());
+		RD_ASSERT_THROW_MSG(false, fmt::format("{}: failed to map segment {}, errno: {}", this->id, name, errno));
+	}
+	map_segment(new (address) Segment(), Segment::size());
+	update_timestamp();
+#endif
+
+	logger->info("{}: listening on {}", this->id, name);
+	Lifetime lifetime = serverLifetimeDefinition.lifetime;
+
+	thread = std::thread([this, lifetime]() mutable {
+		rd::util::set_thread_name(this->id.empty() ? "SharedMemoryWire::Server Thread" : this->id.c_str());
+
+		while (!lifetime->is_terminated())
+		{
+			update_timestamp();
+			uint32_t state = segment->state.load();
+			if (state == Segment::Attached)
+			{
+				run_connection();
+				if (lifetime->is_terminated())
+				{
+					break;
+				}
+				// the client either detached or is gone, either way the next one may attach
+				state = Segment::Attached;
+				if (!segment->state.compare_exchange_strong(state, Segment::Waiting) && state == Segment::Detached)
+				{
+					segment->state.store(Segment::Waiting);
+				}
+				continue;
+			}
+			if (state == Segment::Detached ||
+				(state == Segment::Attaching && now_ms() - segment->timestamps[1].load() >= DEAD_TIMEOUT_MS))
+			{
+				segment->state.compare_exchange_strong(state, Segment::Waiting);
+				continue;
+			}
+			futex_wait(segment->state, state, WAIT_SLICE);
+		}
+		logger->debug("{}: thread expired", this->id);
+	});
+
+	lifetime->add_action([this] {
+		logger->info("{}: start terminating lifetime", this->id);
+
+		const bool send_buffer_stopped = async_send_buffer.stop(timeout);
+		logger->debug("{}: send buffer stopped, success: {}", this->id, send_buffer_stopped);
+
+		terminating = true;
+		segment->state.store(Segment::Detached);
+		wake_all();
+
+		thread.join();
+#ifdef __linux__
+		shm_unlink(name.c_str());
+#endif
+		unmap_segment();
+		logger->info("{}: termination finished", this->id);
+	});
+}
+
+SharedMemoryWire::Server::~Server()
+{
+	if (!serverLifetimeDefinition.is_terminated())
+	{
+		serverLifetimeDefinition.terminate();
+	}
+}
+}	 // namespace rd
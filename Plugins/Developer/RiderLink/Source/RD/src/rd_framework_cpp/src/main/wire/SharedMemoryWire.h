@@ -0,0 +1,227 @@
+#ifndef RD_CPP_SHAREDMEMORYWIRE_H
+#define RD_CPP_SHAREDMEMORYWIRE_H
+
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable:4251)
+#endif
+
+#include "scheduler/base/IScheduler.h"
+#include "base/WireBase.h"
+#include "ByteBufferAsyncProcessor.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <rd_framework_export.h>
+
+namespace rd
+{
+/**
+ * \brief Wire between two processes on the same host, backed by a memory-mapped segment holding one
+ * single-producer/single-consumer ring buffer per direction.
+ *
+ * The rings carry the same packages and acknowledgements as [SocketWire], so sequence numbers survive reconnection the
+ * same way: unacknowledged packages are resent after the counterpart attached again and duplicates are skipped.
+ * Readers and writers sleep on futexes within the segment, liveness is tracked by timestamps both sides keep updating.
+ * Only available on Linux, [is_supported] tells whether it can be used.
+ */
+class RD_FRAMEWORK_API SharedMemoryWire
+{
+	static std::chrono::milliseconds timeout;
+
+public:
+	static bool is_supported();
+
+	/**
+	 * \brief Layout of the mapped segment, defined in the implementation.
+	 */
+	struct Segment;
+
+	class RD_FRAMEWORK_API Base : public WireBase
+	{
+	protected:
+		static std::shared_ptr<spdlog::logger> logger;
+
+		std::string id;
+		std::thread thread{};
+
+		/**
+		 * \brief Index of the side within the segment, 0 for the server and 1 for the client.
+		 */
+		const int side;
+
+		Segment* segment = nullptr;
+		size_t segment_size = 0;
+		Buffer::word_t* send_ring = nullptr;
+		Buffer::word_t* receive_ring = nullptr;
+
+		mutable std::mutex send_lock;
+		mutable ByteBufferAsyncProcessor async_send_buffer{id + "-AsyncSendProcessor",
+			[this](ByteBufferAsyncProcessor::batch_t const& batch, sequence_number_t first_seqn) -> bool {
+				return this->send0(batch, first_seqn);
+			}};
+
+		static constexpr int32_t ACK_MESSAGE_LENGTH = -1;
+		static constexpr int32_t PACKAGE_HEADER_LENGTH = sizeof(ACK_MESSAGE_LENGTH) + sizeof(sequence_number_t);
+		static constexpr int32_t ACK_PACKAGE_THRESHOLD = 32;
+		static constexpr size_t SEND_BUFFER_SIZE = 16 * 1024;
+		static constexpr size_t RECEIVE_BLOCK_SIZE = 1u << 16;
+
+		mutable std::atomic<size_t> send_buffer_hint{SEND_BUFFER_SIZE};
+		/**
+		 * \brief Package headers of the batch currently being sent, guarded by [send_lock].
+		 */
+		mutable Buffer::ByteArray send_package_headers;
+		mutable std::array<Buffer::word_t, PACKAGE_HEADER_LENGTH> ack_header{};
+		/**
+		 * \brief Write position of the send ring which hasn't been published yet, guarded by [send_lock].
+		 */
+		mutable uint64_t send_head = 0;
+
+		/**
+		 * \brief Highest received seqn still to be acknowledged, 0 if there is none. Taken by the next batch or sent
+		 * once the receive ring runs empty.
+		 */
+		mutable std::atomic<sequence_number_t> ack_seqn_to_send{0};
+		mutable int32_t unacked_packages = 0;
+		mutable sequence_number_t max_received_seqn = 0;
+
+		/**
+		 * \brief Received packages, a block is reused once no dispatched message refers to it anymore.
+		 */
+		mutable std::shared_ptr<Buffer::ByteArray> receive_block;
+		mutable size_t receive_block_used = 0;
+
+		LifetimeDefinition lifetimeDef;
+		/**
+		 * \brief Set first thing on termination, stops the waits of all threads.
+		 */
+		std::atomic<bool> terminating{false};
+
+		// region ctor/dtor
+
+		Base(std::string id, Lifetime parentLifetime, IScheduler* scheduler, int side);
+
+		// endregion
+
+		void map_segment(void* address, size_t size);
+
+		void unmap_segment();
+
+		/**
+		 * \brief Whether the counterpart is attached and has updated its timestamp recently.
+		 */
+		bool counterpart_alive() const;
+
+		void update_timestamp() const;
+
+		/**
+		 * \brief Copies [size] bytes to the send ring, waiting for free space as needed. The bytes become visible to
+		 * the counterpart with the next [publish_ring]. Must be called under [send_lock].
+		 * \return false if the connection was lost meanwhile
+		 */
+		bool write_ring(Buffer::word_t const* data, size_t size) const;
+
+		void publish_ring() const;
+
+		/**
+		 * \brief Reads exactly [size] bytes from the receive ring, waiting for data as needed.
+		 * \return false if the connection was lost meanwhile
+		 */
+		bool read_ring(Buffer::word_t* data, size_t size) const;
+
+		bool send0(ByteBufferAsyncProcessor::batch_t const& batch, sequence_number_t first_seqn) const;
+
+		bool flush_ack() const;
+
+		bool read_package() const;
+
+		/**
+		 * \brief Runs an attached connection until it is lost or the wire terminates.
+		 */
+		void run_connection() const;
+
+		/**
+		 * \brief Wakes every thread waiting on the segment, so it checks its connection again.
+		 */
+		void wake_all() const;
+
+	public:
+		// region ctor/dtor
+
+		virtual ~Base();
+
+		// endregion
+
+		void send(RdId const& rd_id, std::function<void(Buffer& buffer)> writer) const override;
+
+		void send(RdId const& rd_id, std::function<void(Buffer& buffer)> writer, Lane lane) const override;
+
+		void send(RdId const& rd_id, std::function<void(Buffer& buffer)> writer, Lane lane, bool lossy) const override;
+
+		void set_send_queue_limits(size_t max_bytes, ByteBufferAsyncProcessor::OverflowPolicy policy) const;
+
+		/**
+		 * \brief Sets what sending does for messages of [lane] while the send queue is full, see
+		 * [ByteBufferAsyncProcessor::set_overflow_policy].
+		 */
+		void set_send_queue_overflow_policy(Lane lane, ByteBufferAsyncProcessor::OverflowPolicy policy) const;
+
+		ByteBufferAsyncProcessor::Gauges get_send_queue_gauges() const;
+	};
+
+	class RD_FRAMEWORK_API Client : public Base
+	{
+	public:
+		std::string name;
+
+		// region ctor/dtor
+
+		Client(Lifetime parentLifetime, IScheduler* scheduler, std::string name, const std::string& id = "ClientSharedMemory");
+
+		virtual ~Client() override;
+		// endregion
+
+	private:
+		bool attach();
+
+		void detach();
+
+		std::mutex lock;
+		std::condition_variable cv;
+
+		LifetimeDefinition clientLifetimeDefinition;
+	};
+
+	class RD_FRAMEWORK_API Server : public Base
+	{
+	public:
+		/**
+		 * \brief Name of the segment, the counterpart opens it to connect.
+		 */
+		std::string name;
+
+		// region ctor/dtor
+
+		Server(Lifetime parentLifetime, IScheduler* scheduler, const std::string& id = "ServerSharedMemory");
+
+		virtual ~Server() override;
+		// endregion
+
+	private:
+		LifetimeDefinition serverLifetimeDefinition;
+	};
+};
+}	 // namespace rd
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+#endif	  // RD_CPP_SHAREDMEMORYWIRE_H
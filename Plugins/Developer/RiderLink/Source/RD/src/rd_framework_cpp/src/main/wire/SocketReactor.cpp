@@ -0,0 +1,262 @@
+#include "SocketReactor.h"
+
+#include <util/thread_util.h>
+
+#include "spdlog/sinks/stdout_color_sinks.h"
+
+#include <stdexcept>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace rd
+{
+std::shared_ptr<spdlog::logger> SocketReactor::logger =
+	spdlog::stderr_color_mt<spdlog::synchronous_factory>("reactorLog", spdlog::color_mode::automatic);
+
+bool SocketReactor::is_supported()
+{
+#ifdef __linux__
+	return true;
+#else
+	return false;
+#endif
+}
+
+SocketReactor& SocketReactor::instance()
+{
+	static SocketReactor reactor;
+	return reactor;
+}
+
+#ifdef __linux__
+
+SocketReactor::SocketReactor()
+{
+	epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (epoll_fd == -1 || wake_fd == -1)
+	{
+		throw std::runtime_error("SocketReactor: failed to create epoll instance, errno: " + std::to_string(errno));
+	}
+	epoll_event event{};
+	event.events = EPOLLIN;
+	event.data.fd = wake_fd;
+	epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &event);
+
+	thread = std::thread([this] { run(); });
+	thread_id = thread.get_id();
+}
+
+SocketReactor::~SocketReactor()
+{
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		terminated = true;
+	}
+	wake();
+	if (thread.joinable())
+	{
+		thread.join();
+	}
+	close(wake_fd);
+	close(epoll_fd);
+}
+
+void SocketReactor::wake() const
+{
+	const uint64_t one = 1;
+	(void) !write(wake_fd, &one, sizeof(one));
+}
+
+void SocketReactor::wait_for_dispatch()
+{
+	// a handler removing itself runs on the reactor thread, which already holds the dispatch lock
+	if (std::this_thread::get_id() != thread_id)
+	{
+		std::lock_guard<decltype(dispatch_lock)> guard(dispatch_lock);
+	}
+}
+
+void SocketReactor::run()
+{
+	rd::util::set_thread_name("SocketReactor Thread");
+
+	constexpr int MAX_EVENTS = 64;
+	epoll_event events[MAX_EVENTS];
+	std::vector<std::shared_ptr<Registration>> ready;
+
+	while (true)
+	{
+		int timeout_ms = -1;
+		{
+			std::lock_guard<decltype(lock)> guard(lock);
+			if (terminated)
+			{
+				return;
+			}
+			const auto now = std::chrono::steady_clock::now();
+			for (auto const& timer : timers)
+			{
+				const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(timer.second.next - now).count();
+				const int left_ms = left > 0 ? static_cast<int>(left) : 0;
+				timeout_ms = timeout_ms == -1 ? left_ms : (std::min)(timeout_ms, left_ms);
+			}
+		}
+
+		const int count = epoll_wait(epoll_fd, events, MAX_EVENTS, timeout_ms);
+		if (count == -1 && errno != EINTR)
+		{
+			logger->error("epoll_wait failed, errno: {}", errno);
+			return;
+		}
+
+		ready.clear();
+		{
+			std::lock_guard<decltype(lock)> guard(lock);
+			for (int i = 0; i < count; ++i)
+			{
+				if (events[i].data.fd == wake_fd)
+				{
+					uint64_t value;
+					(void) !read(wake_fd, &value, sizeof(value));
+					continue;
+				}
+				auto it = sockets.find(events[i].data.fd);
+				if (it != sockets.end())
+				{
+					ready.push_back(it->second);
+				}
+			}
+			const auto now = std::chrono::steady_clock::now();
+			for (auto& timer : timers)
+			{
+				if (timer.second.next <= now)
+				{
+					timer.second.next = now + timer.second.interval;
+					ready.push_back(timer.second.registration);
+				}
+			}
+		}
+
+		std::lock_guard<decltype(dispatch_lock)> guard(dispatch_lock);
+		for (auto const& registration : ready)
+		{
+			// a handler removed earlier in this batch must not be called anymore
+			if (registration->active.load())
+			{
+				try
+				{
+					registration->handler();
+				}
+				catch (std::exception const& e)
+				{
+					logger->error("reactor handler failed | {}", e.what());
+				}
+			}
+		}
+	}
+}
+
+void SocketReactor::add_socket(int fd, handler_t on_readable)
+{
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		sockets[fd] = std::make_shared<Registration>(std::move(on_readable));
+	}
+	epoll_event event{};
+	event.events = EPOLLIN | EPOLLRDHUP;
+	event.data.fd = fd;
+	if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == -1)
+	{
+		throw std::runtime_error("SocketReactor: failed to watch socket, errno: " + std::to_string(errno));
+	}
+}
+
+void SocketReactor::remove_socket(int fd)
+{
+	// fails harmlessly if the socket has been closed already, closing removes it from epoll
+	epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		auto it = sockets.find(fd);
+		if (it != sockets.end())
+		{
+			it->second->active = false;
+			sockets.erase(it);
+		}
+	}
+	wait_for_dispatch();
+}
+
+SocketReactor::timer_id_t SocketReactor::add_timer(std::chrono::milliseconds interval, handler_t on_timer)
+{
+	timer_id_t id;
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		id = next_timer_id++;
+		timers[id] = Timer{interval, std::chrono::steady_clock::now() + interval, std::make_shared<Registration>(std::move(on_timer))};
+	}
+	wake();
+	return id;
+}
+
+void SocketReactor::remove_timer(timer_id_t id)
+{
+	{
+		std::lock_guard<decltype(lock)> guard(lock);
+		auto it = timers.find(id);
+		if (it != timers.end())
+		{
+			it->second.registration->active = false;
+			timers.erase(it);
+		}
+	}
+	wait_for_dispatch();
+}
+
+#else
+
+SocketReactor::SocketReactor()
+{
+	throw std::logic_error("SocketReactor is only supported on Linux");
+}
+
+SocketReactor::~SocketReactor() = default;
+
+void SocketReactor::run()
+{
+}
+
+void SocketReactor::wake() const
+{
+}
+
+void SocketReactor::wait_for_dispatch()
+{
+}
+
+void SocketReactor::add_socket(int, handler_t)
+{
+}
+
+void SocketReactor::remove_socket(int)
+{
+}
+
+SocketReactor::timer_id_t SocketReactor::add_timer(std::chrono::milliseconds, handler_t)
+{
+	return 0;
+}
+
+void SocketReactor::remove_timer(timer_id_t)
+{
+}
+
+#endif
+}	 // namespace rd
@@ -0,0 +1,124 @@
+#ifndef RD_CPP_SOCKETREACTOR_H
+#define RD_CPP_SOCKETREACTOR_H
+
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable:4251)
+#endif
+
+#include "spdlog/spdlog.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include <rd_framework_export.h>
+
+namespace rd
+{
+/**
+ * \brief Single I/O thread multiplexing the sockets and timers of all wires with epoll.
+ * Only available on Linux, [is_supported] tells whether it can be used.
+ */
+class RD_FRAMEWORK_API SocketReactor
+{
+public:
+	using handler_t = std::function<void()>;
+	using timer_id_t = uint64_t;
+
+private:
+	/**
+	 * \brief Handler shared with the reactor thread, it is deactivated on removal and destroyed with its last reference.
+	 */
+	struct Registration
+	{
+		handler_t handler;
+		std::atomic<bool> active{true};
+
+		explicit Registration(handler_t handler) : handler(std::move(handler))
+		{
+		}
+	};
+
+	struct Timer
+	{
+		std::chrono::steady_clock::duration interval;
+		std::chrono::steady_clock::time_point next;
+		std::shared_ptr<Registration> registration;
+	};
+
+	static std::shared_ptr<spdlog::logger> logger;
+
+	int epoll_fd = -1;
+	int wake_fd = -1;
+
+	std::mutex lock;
+	std::unordered_map<int, std::shared_ptr<Registration>> sockets;
+	std::map<timer_id_t, Timer> timers;
+	timer_id_t next_timer_id = 1;
+
+	/**
+	 * \brief Held while handlers run, so removing a socket or timer from another thread waits for its handler.
+	 */
+	std::mutex dispatch_lock;
+	bool terminated = false;
+	std::thread thread;
+	std::thread::id thread_id;
+
+	void run();
+
+	void wake() const;
+
+	void wait_for_dispatch();
+
+public:
+	// region ctor/dtor
+
+	SocketReactor();
+
+	SocketReactor(SocketReactor const&) = delete;
+
+	SocketReactor& operator=(SocketReactor const&) = delete;
+
+	~SocketReactor();
+
+	// endregion
+
+	static bool is_supported();
+
+	/**
+	 * \brief Process wide reactor, started on first use.
+	 */
+	static SocketReactor& instance();
+
+	/**
+	 * \brief Calls [on_readable] on the reactor thread whenever [fd] has data or was closed by the counterpart.
+	 */
+	void add_socket(int fd, handler_t on_readable);
+
+	/**
+	 * \brief Stops watching [fd], its handler isn't running and won't be called anymore once this returns.
+	 */
+	void remove_socket(int fd);
+
+	/**
+	 * \brief Calls [on_timer] on the reactor thread every [interval].
+	 */
+	timer_id_t add_timer(std::chrono::milliseconds interval, handler_t on_timer);
+
+	/**
+	 * \brief Cancels a timer, its handler isn't running and won't be called anymore once this returns.
+	 */
+	void remove_timer(timer_id_t id);
+};
+}	 // namespace rd
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+#endif	  // RD_CPP_SOCKETREACTOR_H
@@ -1,4 +1,8 @@
 #include "wire/SocketWire.h"
+#include "wire/SendBufferPool.h"
+#include "wire/SocketReactor.h"
+#include "wire/IoUring.h"
+#include "util/lz4.h"
 
 #include <util/thread_util.h>
 
@@ -8,10 +12,17 @@
 #include <ActiveSocket.h>
 #include <PassiveSocket.h>
 
+#include <algorithm>
+#include <cstring>
 #include <utility>
+#include <vector>
 #include <thread>
 #include <csignal>
 
+#ifndef _WIN32
+#include <poll.h>
+#endif
+
 namespace rd
 {
 std::shared_ptr<spdlog::logger> SocketWire::Base::logger =
@@ -19,16 +30,49 @@ std::shared_ptr<spdlog::logger> SocketWire::Base::logger =
 
 std::chrono::milliseconds SocketWire::timeout = std::chrono::milliseconds(500);
 
+std::atomic<bool> SocketWire::reactor_enabled{false};
+
+void SocketWire::set_reactor_enabled(bool enabled)
+{
+	reactor_enabled = enabled && SocketReactor::is_supported();
+}
+
+bool SocketWire::is_reactor_enabled()
+{
+	return reactor_enabled;
+}
+
+std::atomic<bool> SocketWire::io_uring_enabled{false};
+
+void SocketWire::set_io_uring_enabled(bool enabled)
+{
+	io_uring_enabled = enabled && IoUring::is_supported();
+}
+
+bool SocketWire::is_io_uring_enabled()
+{
+	return io_uring_enabled;
+}
+
 constexpr int32_t SocketWire::Base::ACK_MESSAGE_LENGTH;
 constexpr int32_t SocketWire::Base::PING_MESSAGE_LENGTH;
 constexpr int32_t SocketWire::Base::PACKAGE_HEADER_LENGTH;
+constexpr size_t SocketWire::Base::MAX_VIEW_SIZE;
+constexpr int32_t SocketWire::Base::CAPABILITIES_MESSAGE_LENGTH;
+constexpr sequence_number_t SocketWire::Base::CAPABILITY_COMPRESSION;
+constexpr int32_t SocketWire::Base::COMPRESSED_PACKAGE_FLAG;
+constexpr size_t SocketWire::Base::DEFAULT_COMPRESSION_THRESHOLD;
+constexpr size_t SocketWire::Base::MESSAGE_HEADER_LENGTH;
+constexpr int32_t SocketWire::Base::PING_HISTORY;
+constexpr unsigned SocketWire::Base::IO_URING_ENTRIES;
 
 SocketWire::Base::Base(std::string id, Lifetime parentLifetime, IScheduler* scheduler)
-	: WireBase(scheduler), id(std::move(id)), scheduler(scheduler), local_send_buffer(SEND_BUFFER_SIZE), lifetimeDef(parentLifetime)
+	: WireBase(scheduler), id(std::move(id)), scheduler(scheduler), lifetimeDef(parentLifetime)
 {
 	async_send_buffer.pause("initial");
 	async_send_buffer.start();
 	ping_pkg_header.write_integral(PING_MESSAGE_LENGTH);
+	switch_receive_block();
 }
 
 SocketWire::Base::~Base()
@@ -52,7 +96,7 @@ void SocketWire::Base::receiverProc() const
 				break;
 			}
 
-			if (!read_and_dispatch_message())
+			if (receive_to_block() < 0 || !process_received())
 			{
 				logger->debug("{}: connection was gracefully shutdown", id);
 				//					async_send_buffer.terminate();
@@ -68,58 +112,324 @@ void SocketWire::Base::receiverProc() const
 	}
 }
 
-bool SocketWire::Base::send0(Buffer::ByteArray const& msg, sequence_number_t seqn) const
+namespace
+{
+#ifndef _WIN32
+/**
+ * \brief Skips the first [sent] bytes of [vector].
+ */
+void advance_vector(iovec*& vector, int32_t& count, size_t sent)
+{
+	while (count > 0 && sent >= vector->iov_len)
+	{
+		sent -= vector->iov_len;
+		++vector;
+		--count;
+	}
+	if (count > 0)
+	{
+		vector->iov_base = static_cast<Buffer::word_t*>(vector->iov_base) + sent;
+		vector->iov_len -= sent;
+	}
+}
+#endif
+
+/**
+ * \brief Writes all [count] buffers of [vector] through [ring] if it isn't null, [vector] is advanced past partially
+ * written buffers.
+ */
+bool send_vector(CSimpleSocket& socket, IoUring* ring, iovec* vector, int32_t count, size_t total)
+{
+#ifdef _WIN32
+	(void) ring;
+	// Windows emulates writev with a send per buffer, a single contiguous send is cheaper
+	static thread_local Buffer::ByteArray coalesced;
+	coalesced.clear();
+	coalesced.reserve(total);
+	for (int32_t i = 0; i < count; ++i)
+	{
+		auto const* base = static_cast<Buffer::word_t const*>(vector[i].iov_base);
+		coalesced.insert(coalesced.end(), base, base + vector[i].iov_len);
+	}
+	return socket.Send(coalesced.data(), coalesced.size()) == static_cast<int32_t>(total);
+#else
+	(void) total;
+	while (count > 0)
+	{
+		if (ring != nullptr)
+		{
+			const int32_t sent = ring->send(static_cast<int>(socket.GetSocketDescriptor()), vector, count);
+			if (sent <= 0)
+			{
+				return false;
+			}
+			advance_vector(vector, count, static_cast<size_t>(sent));
+			continue;
+		}
+		const int32_t sent = socket.Send(vector, count);
+		if (sent == -1 && socket.GetSocketError() == CSimpleSocket::SocketEwouldblock)
+		{
+			// the socket is non-blocking when driven by the reactor, wait until it is writable again
+			pollfd writable{static_cast<int>(socket.GetSocketDescriptor()), POLLOUT, 0};
+			poll(&writable, 1, -1);
+			continue;
+		}
+		if (sent <= 0)
+		{
+			return false;
+		}
+		advance_vector(vector, count, static_cast<size_t>(sent));
+	}
+	return true;
+#endif
+}
+
+#ifndef _WIN32
+/**
+ * \brief Writes [vector] as far as a non-blocking [socket] takes it without waiting.
+ * \return number of bytes written, -1 if the socket failed
+ */
+int64_t send_vector_now(CSimpleSocket& socket, iovec* vector, int32_t count)
+{
+	int64_t written = 0;
+	while (count > 0)
+	{
+		const int32_t sent = socket.Send(vector, count);
+		if (sent == -1 && socket.GetSocketError() == CSimpleSocket::SocketEwouldblock)
+		{
+			break;
+		}
+		if (sent <= 0)
+		{
+			return -1;
+		}
+		written += sent;
+		advance_vector(vector, count, static_cast<size_t>(sent));
+	}
+	return written;
+}
+#endif
+
+void write_ack_header(Buffer::word_t* header, int32_t length, sequence_number_t seqn)
+{
+	memcpy(header, &length, sizeof(length));
+	memcpy(header + sizeof(length), &seqn, sizeof(seqn));
+}
+}	 // namespace
+
+bool SocketWire::Base::send0(ByteBufferAsyncProcessor::batch_t const& batch, sequence_number_t first_seqn) const
 {
 	try
 	{
 		std::lock_guard<decltype(socket_send_lock)> guard(socket_send_lock);
 
-		int32_t msglen = static_cast<int32_t>(msg.size());
+		static thread_local std::vector<iovec> send_vector_items;
+		send_vector_items.clear();
+		send_package_headers.resize((batch.size() + 1) * PACKAGE_HEADER_LENGTH);
 
-		send_package_header.rewind();
-		send_package_header.write_integral(msglen);
-		send_package_header.write_integral(seqn);
+		size_t total = 0;
+		if (!unsent_control.empty())
+		{
+			send_vector_items.push_back({unsent_control.data(), unsent_control.size()});
+			total += unsent_control.size();
+		}
+		Buffer::word_t* header = send_package_headers.data();
+		const sequence_number_t ack = ack_seqn_to_send.exchange(0);
+		if (ack > 0)
+		{
+			write_ack_header(header, ACK_MESSAGE_LENGTH, ack);
+			send_vector_items.push_back({header, static_cast<size_t>(PACKAGE_HEADER_LENGTH)});
+			header += PACKAGE_HEADER_LENGTH;
+			total += PACKAGE_HEADER_LENGTH;
+		}
+		const bool compress =
+			compression_enabled.load(std::memory_order_relaxed) && counterpart_compression.load(std::memory_order_relaxed);
+		if (compress && compressed_packages.size() < batch.size())
+		{
+			compressed_packages.resize(batch.size());
+		}
+		for (size_t i = 0; i < batch.size(); ++i)
+		{
+			auto const* msg = batch[i];
+			int32_t len = static_cast<int32_t>(msg->size());
+			if (compress && compress_package(*msg, compressed_packages[i]))
+			{
+				msg = &compressed_packages[i];
+				len = static_cast<int32_t>(msg->size()) | COMPRESSED_PACKAGE_FLAG;
+			}
+			const sequence_number_t seqn = first_seqn + static_cast<sequence_number_t>(i);
+			write_ack_header(header, len, seqn);
 
+			send_vector_items.push_back({header, static_cast<size_t>(PACKAGE_HEADER_LENGTH)});
+			send_vector_items.push_back({const_cast<Buffer::word_t*>(msg->data()), msg->size()});
+			header += PACKAGE_HEADER_LENGTH;
+			total += PACKAGE_HEADER_LENGTH + msg->size();
+		}
+
+		SentBatch sent{first_seqn + static_cast<sequence_number_t>(batch.size()) - 1, std::chrono::steady_clock::now()};
 		RD_ASSERT_THROW_MSG(
-			socket_provider->Send(send_package_header.data(), send_package_header.get_position()) == PACKAGE_HEADER_LENGTH,
+			send_vector(*socket_provider, send_ring.get(), send_vector_items.data(), static_cast<int32_t>(send_vector_items.size()), total),
 			this->id +
-				": failed to send header over the network"
+				": failed to send packages over the network"
 				", reason: " +
-				socket_provider->DescribeError())
-
-		RD_ASSERT_THROW_MSG(socket_provider->Send(msg.data(), msglen) == msglen, this->id +
-																					 ": failed to send package over the network"
-																					 ", reason: " +
-																					 socket_provider->DescribeError());
-		logger->info("{}: were sent {} bytes", this->id, msglen);
-		//        RD_ASSERT_MSG(socketProvider->Flush(), "{}: failed to flush");
+				socket_provider->DescribeError());
+		unsent_control.clear();
+		logger->trace("{}: were sent {} packages, {} bytes", this->id, batch.size(), total);
+		sent_batches.try_push(sent);
 		return true;
 	}
 	catch (std::exception const& e)
 	{
-		//			async_send_buffer.pause("send0");
 		logger->warn("Send0 failed due to: | {}", e.what());
 		return false;
 	}
 }
 
 void SocketWire::Base::send(RdId const& rd_id, std::function<void(Buffer& buffer)> writer) const
+{
+	send(rd_id, std::move(writer), Lane::Interactive);
+}
+
+void SocketWire::Base::send(RdId const& rd_id, std::function<void(Buffer& buffer)> writer, Lane lane) const
+{
+	send(rd_id, std::move(writer), lane, false);
+}
+
+void SocketWire::Base::send(RdId const& rd_id, std::function<void(Buffer& buffer)> writer, Lane lane, bool lossy) const
 {
 	RD_ASSERT_MSG(!rd_id.isNull(), "{}: id mustn't be null");
 
-	local_send_buffer.write_integral<int32_t>(0);	 // placeholder for length
+	Buffer buffer(SendBufferPool::instance().acquire(send_buffer_hint.load(std::memory_order_relaxed)));
+	buffer.write_integral<int32_t>(0);	  // placeholder for length
+
+	rd_id.write(buffer);				  // write id
+	buffer.write_integral<int16_t>(0);	  // placeholder for context
+	writer(buffer);						  // write rest
+
+	int32_t len = static_cast<int32_t>(buffer.get_position());
+
+	buffer.rewind();
+	buffer.write_integral<int32_t>(len - 4);
+	buffer.set_position(static_cast<size_t>(len));
+	send_buffer_hint.store(static_cast<size_t>(len), std::memory_order_relaxed);
+	// the array goes back to the pool once the counterpart acknowledged it
+	if (!async_send_buffer.put(std::move(buffer).getRealArray(), lane, lossy))
+	{
+		logger->debug("{}: message for {} was dropped", this->id, to_string(rd_id));
+		return;
+	}
+	sent_message_count.fetch_add(1, std::memory_order_relaxed);
+	sent_byte_count.fetch_add(static_cast<uint64_t>(len), std::memory_order_relaxed);
+}
+
+void SocketWire::Base::set_send_queue_limits(size_t max_bytes, ByteBufferAsyncProcessor::OverflowPolicy policy) const
+{
+	async_send_buffer.set_limits(max_bytes, policy);
+}
+
+void SocketWire::Base::set_send_queue_overflow_policy(Lane lane, ByteBufferAsyncProcessor::OverflowPolicy policy) const
+{
+	async_send_buffer.set_overflow_policy(lane, policy);
+}
+
+ByteBufferAsyncProcessor::Gauges SocketWire::Base::get_send_queue_gauges() const
+{
+	return async_send_buffer.get_gauges();
+}
+
+void SocketWire::Base::set_compression(bool enabled, size_t threshold)
+{
+	compression_threshold = threshold;
+	compression_enabled = enabled;
+	// either this or [set_socket_provider] sees the other under [socket_send_lock], so no connection misses it
+	send_capabilities();
+}
 
-	rd_id.write(local_send_buffer);					 // write id
-	local_send_buffer.write_integral<int16_t>(0);	 // placeholder for context
-	writer(local_send_buffer);						 // write rest
+void SocketWire::Base::set_max_message_size(size_t max_size)
+{
+	max_message_size = max_size;
+}
 
-	int32_t len = static_cast<int32_t>(local_send_buffer.get_position());
+SocketWire::Base::CompressionStats SocketWire::Base::get_compression_stats() const
+{
+	CompressionStats stats;
+	stats.compressed_packages = compressed_package_count.load(std::memory_order_relaxed);
+	stats.skipped_packages = skipped_package_count.load(std::memory_order_relaxed);
+	stats.uncompressed_bytes = uncompressed_byte_count.load(std::memory_order_relaxed);
+	stats.compressed_bytes = compressed_byte_count.load(std::memory_order_relaxed);
+	stats.compress_time = std::chrono::nanoseconds(compress_nanos.load(std::memory_order_relaxed));
+	stats.decompressed_packages = decompressed_package_count.load(std::memory_order_relaxed);
+	stats.decompress_time = std::chrono::nanoseconds(decompress_nanos.load(std::memory_order_relaxed));
+	return stats;
+}
 
-	local_send_buffer.rewind();
-	local_send_buffer.write_integral<int32_t>(len - 4);
-	local_send_buffer.set_position(static_cast<size_t>(len));
-	async_send_buffer.put(std::move(local_send_buffer).getRealArray());
-	local_send_buffer.rewind();
+SocketWire::Base::Stats SocketWire::Base::get_stats() const
+{
+	Stats stats;
+	stats.messages_sent = sent_message_count.load(std::memory_order_relaxed);
+	stats.bytes_sent = sent_byte_count.load(std::memory_order_relaxed);
+	stats.messages_received = received_message_count.load(std::memory_order_relaxed);
+	stats.bytes_received = received_byte_count.load(std::memory_order_relaxed);
+	const auto gauges = async_send_buffer.get_gauges();
+	stats.queued_packages = gauges.queued_packages;
+	stats.pending_packages = gauges.pending_packages;
+	stats.unacked_bytes = gauges.pending_bytes;
+	const uint32_t connections = connection_count.load(std::memory_order_relaxed);
+	stats.reconnects = connections > 0 ? connections - 1 : 0;
+	stats.heartbeat_lag = current_timestamp - counterpart_acknowledge_timestamp;
+	stats.heartbeat_echo_delay = std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::nanoseconds(heartbeat_echo_nanos.load(std::memory_order_relaxed)));
+	stats.ack_latency = ack_latency.get_snapshot();
+	return stats;
+}
+
+bool SocketWire::Base::compress_package(Buffer::ByteArray const& package, Buffer::ByteArray& compressed) const
+{
+	const size_t size = package.size();
+	if (size < compression_threshold.load(std::memory_order_relaxed))
+	{
+		return false;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	const int32_t uncompressed_size = static_cast<int32_t>(size);
+	compressed.resize(sizeof(uncompressed_size) + util::lz4::compress_bound(size));
+	memcpy(compressed.data(), &uncompressed_size, sizeof(uncompressed_size));
+	const size_t block_size = util::lz4::compress(
+		package.data(), size, compressed.data() + sizeof(uncompressed_size), compressed.size() - sizeof(uncompressed_size));
+	compressed.resize(sizeof(uncompressed_size) + block_size);
+	compress_nanos += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+	// not worth the decompression on the other side unless at least an eighth is saved
+	if (compressed.size() > size - size / 8)
+	{
+		++skipped_package_count;
+		return false;
+	}
+	++compressed_package_count;
+	uncompressed_byte_count += size;
+	compressed_byte_count += compressed.size();
+	return true;
+}
+
+void SocketWire::Base::send_capabilities() const
+{
+	if (!compression_enabled)
+	{
+		return;
+	}
+	std::lock_guard<decltype(socket_send_lock)> guard(socket_send_lock);
+	if (socket_provider == nullptr)
+	{
+		return;
+	}
+	Buffer::word_t header[PACKAGE_HEADER_LENGTH];
+	write_ack_header(header, CAPABILITIES_MESSAGE_LENGTH, CAPABILITY_COMPRESSION);
+	iovec item{header, static_cast<size_t>(PACKAGE_HEADER_LENGTH)};
+	if (send_control(&item, 1, PACKAGE_HEADER_LENGTH, true) != ControlSend::Sent)
+	{
+		logger->warn("{}: failed to send capabilities, reason: {}", this->id, socket_provider->DescribeError());
+	}
 }
 
 void SocketWire::Base::set_socket_provider(std::shared_ptr<CActiveSocket> new_socket)
@@ -127,6 +437,7 @@ void SocketWire::Base::set_socket_provider(std::shared_ptr<CActiveSocket> new_so
 	{
 		std::lock_guard<decltype(socket_send_lock)> guard(socket_send_lock);
 		socket_provider = std::move(new_socket);
+		unsent_control.clear();
 		socket_send_var.notify_all();
 	}
 	{
@@ -137,24 +448,48 @@ void SocketWire::Base::set_socket_provider(std::shared_ptr<CActiveSocket> new_so
 		}
 	}
 
-	auto heartbeat = LifetimeDefinition::use([this](Lifetime heartbeatLifetime) {
-		const auto heartbeat = start_heartbeat(heartbeatLifetime).share();
+	connection_count.fetch_add(1, std::memory_order_relaxed);
+	reset_receive_state();
+	send_capabilities();
 
+	if (SocketWire::is_reactor_enabled())
+	{
 		async_send_buffer.resume();
 
 		connected.set(true);
 
-		receiverProc();
+		run_on_reactor();
 
 		connected.set(false);
 
 		async_send_buffer.pause("Disconnected");
+	}
+	else
+	{
+		if (SocketWire::is_io_uring_enabled())
+		{
+			open_rings();
+		}
+		auto heartbeat = LifetimeDefinition::use([this](Lifetime heartbeatLifetime) {
+			const auto heartbeat = start_heartbeat(heartbeatLifetime).share();
 
-		return heartbeat;
-	});
-	const auto status = heartbeat.wait_for(timeout);
+			async_send_buffer.resume();
+
+			connected.set(true);
+
+			receiverProc();
+
+			connected.set(false);
 
-	logger->debug("{}: waited for heartbeat to stop with status: {}", this->id, status);
+			async_send_buffer.pause("Disconnected");
+
+			return heartbeat;
+		});
+		const auto status = heartbeat.wait_for(timeout);
+
+		logger->debug("{}: waited for heartbeat to stop with status: {}", this->id, status);
+		close_rings();
+	}
 
 	if (!socket_provider->IsSocketValid())
 	{
@@ -183,188 +518,472 @@ std::future<void> SocketWire::Base::start_heartbeat(Lifetime lifetime)
 	});
 }
 
-bool SocketWire::Base::read_from_socket(Buffer::word_t* res, int32_t msglen) const
+Buffer::word_t* SocketWire::Base::receive_block_begin() const
 {
-	int32_t ptr = 0;
-	while (ptr < msglen)
-	{
-		RD_ASSERT_MSG(hi >= lo, "hi >= lo")
+	return receive_blocks[receive_block_index]->data();
+}
 
-		int32_t rest = msglen - ptr;
-		int32_t available = static_cast<int32_t>(hi - lo);
+Buffer::word_t* SocketWire::Base::receive_block_end() const
+{
+	return receive_block_begin() + RECEIVE_BUFFER_SIZE;
+}
 
-		if (available > 0)
-		{
-			int32_t copylen = (std::min)(rest, available);
-			std::copy(lo, lo + copylen, res + ptr);
-			lo += copylen;
-			ptr += copylen;
-		}
-		else
+void SocketWire::Base::switch_receive_block() const
+{
+	size_t target = receive_blocks.size();
+	// the slab holds the only reference of a block no message views anymore
+	if (target > 0 && receive_blocks[receive_block_index].use_count() == 1)
+	{
+		target = receive_block_index;
+	}
+	else
+	{
+		for (size_t i = 0; i < receive_blocks.size(); ++i)
 		{
-			if (hi == receiver_buffer.end())
-			{
-				hi = lo = receiver_buffer.begin();
-			}
-			logger->info("{}: receive started", this->id);
-			int32_t read = socket_provider->Receive(static_cast<int32_t>(receiver_buffer.end() - hi), &*hi);
-			if (read == -1)
+			if (receive_blocks[i].use_count() == 1)
 			{
-				auto err = socket_provider->GetSocketError();
-				if (err == CSimpleSocket::SocketInvalidSocket)
-				{
-					logger->info("{}: socket was shut down for receiving", this->id);
-					return false;
-				}
-				logger->error("{}: error has occurred while receiving", this->id);
-				return false;
-			}
-			if (read == 0)
-			{
-				logger->info("{}: socket was shut down for receiving", this->id);
-				return false;
-			}
-			hi += read;
-			if (read > 0)
-			{
-				logger->info("{}: receive finished: {} bytes read", this->id, read);
+				target = i;
+				break;
 			}
 		}
 	}
-	if (ptr != msglen)
+	if (target == receive_blocks.size())
 	{
-		logger->error("read invalid number of bytes from socket, expected: {}, actual: {}", msglen, ptr);
-		assert(false);
+		receive_blocks.push_back(std::make_shared<Buffer::ByteArray>(RECEIVE_BUFFER_SIZE));
+		logger->debug("{}: allocated receive block #{}", this->id, receive_blocks.size());
 	}
-	return true;
+
+	Buffer::word_t* begin = receive_blocks[target]->data();
+	const auto available = hi - lo;
+	if (available > 0)
+	{
+		std::memmove(begin, lo, available);
+	}
+	receive_block_index = target;
+	lo = begin;
+	hi = begin + available;
 }
 
-static constexpr std::pair<int, sequence_number_t> INVALID_HEADER = std::make_pair(-1, -1);
+int32_t SocketWire::Base::receive_to_block() const
+{
+	// nothing else is going to be read soon, so acknowledge what has been received so far
+	flush_ack();
+
+	if (hi == receive_block_end() || static_cast<size_t>(receive_block_end() - lo) < receive_wanted)
+	{
+		switch_receive_block();
+	}
+
+	logger->trace("{}: receive started", this->id);
+	int32_t read;
+	if (receive_ring)
+	{
+		read = receive_on_ring();
+		if (read < 0)
+		{
+			logger->error("{}: error has occurred while receiving, errno: {}", this->id, -read);
+			return -1;
+		}
+	}
+	else if ((read = socket_provider->Receive(static_cast<int32_t>(receive_block_end() - hi), hi)) == -1)
+	{
+		auto err = socket_provider->GetSocketError();
+		if (err == CSimpleSocket::SocketEwouldblock)
+		{
+			return 0;
+		}
+		if (err == CSimpleSocket::SocketInvalidSocket)
+		{
+			logger->info("{}: socket was shut down for receiving", this->id);
+			return -1;
+		}
+		logger->error("{}: error has occurred while receiving", this->id);
+		return -1;
+	}
+	if (read == 0)
+	{
+		logger->info("{}: socket was shut down for receiving", this->id);
+		return -1;
+	}
+	hi += read;
+	logger->trace("{}: receive finished: {} bytes read", this->id, read);
+	return read;
+}
 
-std::pair<int, sequence_number_t> SocketWire::Base::read_header() const
+int32_t SocketWire::Base::receive_on_ring() const
 {
-	int32_t len = 0;
-	sequence_number_t seqn = 0;
-	while (true)
+	if (registered_receive_blocks != receive_blocks.size())
 	{
-		if (!read_integral_from_socket(len))
+		std::vector<iovec> blocks;
+		blocks.reserve(receive_blocks.size());
+		for (auto const& block : receive_blocks)
 		{
-			return INVALID_HEADER;
+			blocks.push_back({block->data(), block->size()});
 		}
-		if (len == PING_MESSAGE_LENGTH)
+		// receives go to unregistered buffers if the kernel refuses, e.g. for exceeding the locked memory limit
+		if (!receive_ring->register_buffers(blocks.data(), static_cast<unsigned>(blocks.size())))
 		{
-			int32_t received_timestamp = 0;
-			int32_t received_counterpart_timestamp = 0;
-			if (!read_integral_from_socket(received_timestamp))
+			logger->debug("{}: failed to register {} receive blocks", this->id, blocks.size());
+		}
+		registered_receive_blocks = receive_blocks.size();
+	}
+	return receive_ring->receive(static_cast<int>(socket_provider->GetSocketDescriptor()), hi,
+		static_cast<size_t>(receive_block_end() - hi), static_cast<int32_t>(receive_block_index));
+}
+
+void SocketWire::Base::open_rings() const
+{
+	try
+	{
+		auto receive = std::make_unique<IoUring>(IO_URING_ENTRIES);
+		auto send = std::make_unique<IoUring>(IO_URING_ENTRIES);
+		std::lock_guard<decltype(socket_send_lock)> guard(socket_send_lock);
+		receive_ring = std::move(receive);
+		send_ring = std::move(send);
+		registered_receive_blocks = 0;
+	}
+	catch (std::exception const& e)
+	{
+		logger->warn("{}: falling back to plain socket calls | {}", this->id, e.what());
+	}
+}
+
+void SocketWire::Base::close_rings() const
+{
+	std::lock_guard<decltype(socket_send_lock)> guard(socket_send_lock);
+	send_ring.reset();
+	receive_ring.reset();
+}
+
+void SocketWire::Base::reset_receive_state() const
+{
+	// messages of the previous connection may still be queued as views of the current block, so it isn't rewound
+	lo = hi;
+	switch_receive_block();
+	receive_wanted = 0;
+	package_remaining = 0;
+	package_duplicate = false;
+	package_seqn = 0;
+	message_header_read = 0;
+	message_size = -1;
+	message.rewind();
+	package_compressed = false;
+	counterpart_compression = false;
+	// the sender is paused between connections, unacknowledged batches are resent and recorded again
+	SentBatch discarded;
+	while (sent_batches.try_pop(discarded))
+	{
+	}
+	unacknowledged_batch = {};
+}
+
+bool SocketWire::Base::process_received() const
+{
+	while (true)
+	{
+		const auto available = static_cast<size_t>(hi - lo);
+		if (package_remaining > 0)
+		{
+			const size_t in_package = (std::min)(available, static_cast<size_t>(package_remaining));
+			if (package_duplicate || package_compressed)
+			{
+				if (!package_duplicate)
+				{
+					compressed_package.insert(compressed_package.end(), lo, lo + in_package);
+				}
+				lo += in_package;
+				package_remaining -= static_cast<int32_t>(in_package);
+				if (package_remaining == 0 && !package_duplicate)
+				{
+					dispatch_compressed_package();
+				}
+			}
+			else if (!process_message_bytes(in_package))
 			{
-				return INVALID_HEADER;
+				return true;
 			}
-			if (!read_integral_from_socket(received_counterpart_timestamp))
+			if (package_remaining == 0)
 			{
-				return INVALID_HEADER;
+				complete_package();
 			}
-
-			counterpart_timestamp = received_timestamp;
-			counterpart_acknowledge_timestamp = received_counterpart_timestamp;
-
-			if ((connection_established(current_timestamp, counterpart_acknowledge_timestamp)))
+			else if (lo == hi)
 			{
-				if (!heartbeatAlive.get())
-				{	 // only on change
-					logger->trace(
-						"Connection is alive after receiving PING {}: "
-						"received_timestamp: {}, "
-						"received_counterpart_timestamp: {}, "
-						"current_timestamp: {}, "
-						"counterpart_timestamp: {}, "
-						"counterpart_acknowledge_timestamp: {}, ",
-						id, received_timestamp, received_counterpart_timestamp, current_timestamp, counterpart_timestamp,
-						counterpart_acknowledge_timestamp);
-				}
-				heartbeatAlive.set(true);
+				receive_wanted = 1;
+				return true;
 			}
 			continue;
 		}
-		if (!read_integral_from_socket(seqn))
+
+		// every frame starts with a package header: length and seqn, or a ping's timestamps
+		receive_wanted = PACKAGE_HEADER_LENGTH;
+		if (available < static_cast<size_t>(PACKAGE_HEADER_LENGTH))
 		{
-			return INVALID_HEADER;
+			return true;
 		}
-
+		int32_t len = 0;
+		memcpy(&len, lo, sizeof(len));
+		if (len == PING_MESSAGE_LENGTH)
+		{
+			int32_t received_timestamp = 0;
+			int32_t received_counterpart_timestamp = 0;
+			memcpy(&received_timestamp, lo + sizeof(len), sizeof(received_timestamp));
+			memcpy(&received_counterpart_timestamp, lo + sizeof(len) + sizeof(received_timestamp), sizeof(received_counterpart_timestamp));
+			lo += PACKAGE_HEADER_LENGTH;
+			on_ping(received_timestamp, received_counterpart_timestamp);
+			continue;
+		}
+		sequence_number_t seqn = 0;
+		memcpy(&seqn, lo + sizeof(len), sizeof(seqn));
+		lo += PACKAGE_HEADER_LENGTH;
 		if (len == ACK_MESSAGE_LENGTH)
 		{
+			record_ack_latency(seqn);
 			async_send_buffer.acknowledge(seqn);
 			continue;
 		}
-		return std::make_pair(len, seqn);
+		if (len == CAPABILITIES_MESSAGE_LENGTH)
+		{
+			counterpart_compression = (seqn & CAPABILITY_COMPRESSION) != 0;
+			logger->debug("{}: counterpart capabilities: {}", this->id, seqn);
+			continue;
+		}
+		if (len < 0)
+		{
+			logger->error("{}: invalid package length: {}", this->id, len);
+			return false;
+		}
+
+		package_compressed = (len & COMPRESSED_PACKAGE_FLAG) != 0;
+		if (package_compressed)
+		{
+			len &= ~COMPRESSED_PACKAGE_FLAG;
+			compressed_package.clear();
+		}
+
+		logger->debug("{}: read len={}, seqn={}, max_received_seqn={}", this->id, len, seqn, max_received_seqn);
+		package_duplicate = seqn <= max_received_seqn && seqn != 1;
+		package_seqn = seqn;
+		package_remaining = len;
+		if (len == 0)
+		{
+			complete_package();
+		}
 	}
 }
 
-int32_t SocketWire::Base::read_package() const
+void SocketWire::Base::complete_package() const
 {
-	receive_pkg.rewind();
-
-	const auto pair = read_header();
-	if (pair == INVALID_HEADER)
+	if (!package_duplicate)
 	{
-		logger->debug("{}: failed to read header", this->id);
-		return -1;
+		max_received_seqn = package_seqn;
+		logger->trace("{}: was received package, seqn={}", this->id, package_seqn);
 	}
-	const auto len = pair.first;
-	const auto seqn = pair.second;
-
-	logger->debug("{}: read len={}, seqn={}, max_received_seqn={}", this->id, len, seqn, max_received_seqn);
+	schedule_ack(max_received_seqn);
+}
 
-	receive_pkg.require_available(len);
-	if (!read_data_from_socket(receive_pkg.data(), len))
+bool SocketWire::Base::process_message_bytes(size_t available) const
+{
+	if (message_size == -1)
 	{
-		logger->debug("{}: failed to read package", this->id);
-		return -1;
+		if (message_header_read == 0 && available < MESSAGE_HEADER_LENGTH &&
+			static_cast<size_t>(package_remaining) >= MESSAGE_HEADER_LENGTH)
+		{
+			// the header is within this package, wait for the rest of it
+			receive_wanted = MESSAGE_HEADER_LENGTH;
+			return false;
+		}
+		const size_t n = (std::min)(MESSAGE_HEADER_LENGTH - message_header_read, available);
+		memcpy(message_header.data() + message_header_read, lo, n);
+		message_header_read += n;
+		lo += n;
+		package_remaining -= static_cast<int32_t>(n);
+		if (message_header_read < MESSAGE_HEADER_LENGTH)
+		{
+			return true;
+		}
+
+		int32_t sz = 0;
+		memcpy(&sz, message_header.data(), sizeof(sz));
+		memcpy(&message_id, message_header.data() + sizeof(sz), sizeof(message_id));
+		message_header_read = 0;
+		logger->trace("{}: message info: sz={}, id={}", this->id, sz, message_id);
+		RD_ASSERT_THROW_MSG(sz >= static_cast<int32_t>(sizeof(RdId::hash_t)) && message_id != -1,
+			fmt::format("{}: invalid message header, sz={}, id={}", this->id, sz, message_id));
+		message_size = sz - static_cast<int32_t>(sizeof(RdId::hash_t));
+		RD_ASSERT_THROW_MSG(static_cast<size_t>(message_size) <= max_message_size.load(std::memory_order_relaxed),
+			fmt::format("{}: message too large, sz={}, id={}", this->id, sz, message_id));
+		message.rewind();
+		return true;
 	}
-	send_ack(seqn);
-	if (seqn <= max_received_seqn && seqn != 1)
+
+	const size_t need = static_cast<size_t>(message_size) - message.get_position();
+	if (message.get_position() == 0 && need <= MAX_VIEW_SIZE && need <= static_cast<size_t>(package_remaining))
 	{
+		if (need > available)
+		{
+			// the message is within this package, wait for the rest to dispatch it without copying
+			receive_wanted = need;
+			return false;
+		}
+		const auto begin = static_cast<size_t>(lo - receive_block_begin());
+		lo += need;
+		package_remaining -= static_cast<int32_t>(need);
+		dispatch_message(Buffer(receive_blocks[receive_block_index], begin, need));
 		return true;
 	}
-	max_received_seqn = seqn;
 
-	logger->info("{}: was received package, bytes={}, seqn={}", this->id, len, seqn);
-	return len;
+	const size_t n = (std::min)(need, available);
+	const size_t position = message.get_position();
+	message.require_available(n);
+	memcpy(message.data() + position, lo, n);
+	message.set_position(position + n);
+	lo += n;
+	package_remaining -= static_cast<int32_t>(n);
+	if (message.get_position() == static_cast<size_t>(message_size))
+	{
+		message.rewind();
+		dispatch_message(std::move(message));
+		message.rewind();
+	}
+	return true;
+}
+
+void SocketWire::Base::dispatch_message(Buffer buffer) const
+{
+	const RdId rd_id{message_id};
+	received_message_count.fetch_add(1, std::memory_order_relaxed);
+	received_byte_count.fetch_add(static_cast<uint64_t>(message_size) + MESSAGE_HEADER_LENGTH, std::memory_order_relaxed);
+	message_size = -1;
+	logger->debug("{}: message received", this->id);
+	message_broker.dispatch(rd_id, std::move(buffer));
+	logger->debug("{}: message dispatched", this->id);
 }
 
-bool SocketWire::Base::read_and_dispatch_message() const
+void SocketWire::Base::dispatch_compressed_package() const
 {
-	sz = (sz == -1 ? receive_pkg.read_integral<int32_t>() : sz);
-	if (sz == -1)
+	package_compressed = false;
+	RD_ASSERT_THROW_MSG(message_size == -1 && message_header_read == 0,
+		fmt::format("{}: compressed package within a message", this->id));
+	int32_t size = 0;
+	RD_ASSERT_THROW_MSG(compressed_package.size() >= sizeof(size), fmt::format("{}: truncated compressed package", this->id));
+	memcpy(&size, compressed_package.data(), sizeof(size));
+	RD_ASSERT_THROW_MSG(size >= 0 && size < COMPRESSED_PACKAGE_FLAG, fmt::format("{}: invalid uncompressed size: {}", this->id, size));
+
+	const auto start = std::chrono::steady_clock::now();
+	// dispatched messages are views into the block, so it is only reused once they are all gone
+	if (decompressed_block.use_count() != 1 || decompressed_block->size() < static_cast<size_t>(size))
 	{
-		logger->debug("{}: sz == -1", this->id);
-		return false;
+		decompressed_block = std::make_shared<Buffer::ByteArray>(static_cast<size_t>(size));
 	}
-	id_ = (id_ == -1 ? receive_pkg.read_integral<RdId::hash_t>() : id_);
-	if (id_ == -1)
+	const int64_t decompressed = util::lz4::decompress(compressed_package.data() + sizeof(size),
+		compressed_package.size() - sizeof(size), decompressed_block->data(), static_cast<size_t>(size));
+	RD_ASSERT_THROW_MSG(decompressed == size, fmt::format("{}: malformed compressed package", this->id));
+	++decompressed_package_count;
+	decompress_nanos += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+	// a compressed package consists of whole messages
+	size_t position = 0;
+	while (position < static_cast<size_t>(size))
 	{
-		logger->error("id == -1");
-		return false;
+		int32_t sz = 0;
+		RD_ASSERT_THROW_MSG(position + MESSAGE_HEADER_LENGTH <= static_cast<size_t>(size),
+			fmt::format("{}: truncated message in compressed package", this->id));
+		memcpy(&sz, decompressed_block->data() + position, sizeof(sz));
+		memcpy(&message_id, decompressed_block->data() + position + sizeof(sz), sizeof(message_id));
+		const size_t begin = position + MESSAGE_HEADER_LENGTH;
+		const size_t length = static_cast<size_t>(sz) - sizeof(RdId::hash_t);
+		RD_ASSERT_THROW_MSG(sz >= static_cast<int32_t>(sizeof(RdId::hash_t)) && begin + length <= static_cast<size_t>(size),
+			fmt::format("{}: invalid message size {} in compressed package", this->id, sz));
+		message_size = static_cast<int32_t>(length);
+		dispatch_message(Buffer(decompressed_block, begin, length));
+		position = begin + length;
 	}
-	logger->trace("{}: message info: sz={}, id={}", this->id, sz, id_);
-	const RdId rd_id{id_};
-	sz -= 8;	// RdId
-	message.require_available(sz);
+}
 
-	if (!receive_pkg.read(message.data() + message.get_position(), sz - message.get_position()))
+void SocketWire::Base::on_ping(int32_t received_timestamp, int32_t received_counterpart_timestamp) const
+{
+	// the counterpart echoes the latest timestamp it received from this wire
+	if (received_counterpart_timestamp > counterpart_acknowledge_timestamp &&
+		current_timestamp - received_counterpart_timestamp <= PING_HISTORY)
 	{
-		logger->error("{}: constructing message failed", this->id);
-		return false;
+		const int64_t sent = ping_send_nanos[received_counterpart_timestamp % PING_HISTORY].load(std::memory_order_relaxed);
+		const int64_t delay = std::chrono::duration_cast<std::chrono::nanoseconds>(
+								  std::chrono::steady_clock::now().time_since_epoch()).count() - sent;
+		const int64_t smoothed = heartbeat_echo_nanos.load(std::memory_order_relaxed);
+		heartbeat_echo_nanos.store(smoothed == 0 ? delay : smoothed + (delay - smoothed) / 8, std::memory_order_relaxed);
 	}
+	counterpart_timestamp = received_timestamp;
+	counterpart_acknowledge_timestamp = received_counterpart_timestamp;
 
-	logger->debug("{}: message received", this->id);
-	message_broker.dispatch(rd_id, std::move(message));
-	logger->debug("{}: message dispatched", this->id);
+	if ((connection_established(current_timestamp, counterpart_acknowledge_timestamp)))
+	{
+		if (!heartbeatAlive.get())
+		{	 // only on change
+			logger->trace(
+				"Connection is alive after receiving PING {}: "
+				"received_timestamp: {}, "
+				"received_counterpart_timestamp: {}, "
+				"current_timestamp: {}, "
+				"counterpart_timestamp: {}, "
+				"counterpart_acknowledge_timestamp: {}, ",
+				id, received_timestamp, received_counterpart_timestamp, current_timestamp, counterpart_timestamp,
+				counterpart_acknowledge_timestamp);
+		}
+		heartbeatAlive.set(true);
+	}
+}
 
-	sz = -1;
-	id_ = -1;
-	message.rewind();
-	return true;
-	//		RD_ASSERT_MSG(summary_size == sz, "Broken message, read:%d bytes, expected:%d bytes", summary_size, sz)
+void SocketWire::Base::run_on_reactor() const
+{
+	auto& reactor = SocketReactor::instance();
+	const int fd = static_cast<int>(socket_provider->GetSocketDescriptor());
+	RD_ASSERT_THROW_MSG(socket_provider->SetNonblocking(),
+		fmt::format("{}: failed to make socket non-blocking, reason: {}", this->id, socket_provider->DescribeError()));
+	on_reactor = true;
+
+	std::promise<void> closed;
+	auto closed_future = closed.get_future();
+	bool finished = false;	  // reactor thread only
+	reactor.add_socket(fd, [this, &closed, &finished] {
+		if (finished)
+		{
+			return;
+		}
+		bool alive = true;
+		try
+		{
+			int32_t read;
+			while (alive && (read = receive_to_block()) != 0)
+			{
+				alive = read > 0 && process_received();
+			}
+		}
+		catch (std::exception const& ex)
+		{
+			logger->error("{} caught processing | {}", this->id, ex.what());
+			alive = false;
+		}
+		if (!alive)
+		{
+			logger->debug("{}: connection was gracefully shutdown", id);
+			finished = true;
+			closed.set_value();
+		}
+	});
+	const auto heartbeat = reactor.add_timer(heartBeatInterval, [this] { ping(); });
+
+	// closing the socket on termination silently removes it from epoll, so termination is checked as well
+	while (closed_future.wait_for(timeout) == std::future_status::timeout)
+	{
+		if (lifetimeDef.lifetime->is_terminated() || !socket_provider->IsSocketValid())
+		{
+			break;
+		}
+	}
+
+	reactor.remove_timer(heartbeat);
+	reactor.remove_socket(fd);
+	on_reactor = false;
 }
 
 CSimpleSocket* SocketWire::Base::get_socket_provider() const
@@ -392,15 +1011,42 @@ void SocketWire::Base::ping() const
 		ping_pkg_header.set_position(sizeof(PING_MESSAGE_LENGTH));
 		ping_pkg_header.write_integral(current_timestamp);
 		ping_pkg_header.write_integral(counterpart_timestamp);
+		ping_send_nanos[current_timestamp % PING_HISTORY].store(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(),
+			std::memory_order_relaxed);
 		{
-			std::lock_guard<decltype(socket_send_lock)> guard(socket_send_lock);
-			int32_t sent = socket_provider->Send(ping_pkg_header.data(), ping_pkg_header.get_position());
-			if (sent == 0 && !socket_provider->IsSocketValid())
+			std::unique_lock<decltype(socket_send_lock)> guard(socket_send_lock, std::defer_lock);
+			if (!lock_for_send(guard))
+			{
+				// the processor thread is writing, it carries the pending ack and the next ping comes soon enough
+				return;
+			}
+			iovec items[] = {{ping_pkg_header.data(), static_cast<size_t>(PACKAGE_HEADER_LENGTH)},
+				{ack_buffer.data(), static_cast<size_t>(PACKAGE_HEADER_LENGTH)}};
+			int32_t count = 1;
+			const sequence_number_t ack = ack_seqn_to_send.exchange(0);
+			if (ack > 0)
+			{
+				ack_buffer.rewind();
+				ack_buffer.write_integral(ACK_MESSAGE_LENGTH);
+				ack_buffer.write_integral(ack);
+				count = 2;
+			}
+			const auto result = send_control(items, count, count * PACKAGE_HEADER_LENGTH, !on_reactor);
+			if (result == ControlSend::Blocked)
+			{
+				// the reactor thread doesn't wait for the socket, the ack stays pending and this ping is skipped
+				sequence_number_t expected = 0;
+				ack_seqn_to_send.compare_exchange_strong(expected, ack);
+				return;
+			}
+			const bool sent = result == ControlSend::Sent;
+			if (!sent && !socket_provider->IsSocketValid())
 			{
 				logger->debug("{}: failed to send ping over the network, reason: socket was shut down for sending", this->id);
 				return;
 			}
-			RD_ASSERT_THROW_MSG(sent == PACKAGE_HEADER_LENGTH,
+			RD_ASSERT_THROW_MSG(sent,
 				fmt::format("{}: failed to send ping over the network, reason: {}", this->id, socket_provider->DescribeError()))
 		}
 
@@ -412,22 +1058,136 @@ void SocketWire::Base::ping() const
 	}
 }
 
-bool SocketWire::Base::send_ack(sequence_number_t seqn) const
+void SocketWire::Base::record_ack_latency(sequence_number_t seqn) const
+{
+	const auto now = std::chrono::steady_clock::now();
+	while (unacknowledged_batch.last_seqn != 0 || sent_batches.try_pop(unacknowledged_batch))
+	{
+		if (unacknowledged_batch.last_seqn > seqn)
+		{
+			return;
+		}
+		ack_latency.record(now - unacknowledged_batch.time);
+		unacknowledged_batch = {};
+	}
+}
+
+bool SocketWire::Base::lock_for_send(std::unique_lock<std::mutex>& guard) const
+{
+	// the reactor thread serves every wire, so it never waits for a send of another thread
+	if (on_reactor)
+	{
+		return guard.try_lock();
+	}
+	guard.lock();
+	return true;
+}
+
+SocketWire::Base::ControlSend SocketWire::Base::send_control(iovec* items, int32_t count, size_t total, bool wait) const
 {
-	logger->trace("{} send ack {}", id, seqn);
+	iovec vector[4];
+	int32_t length = 0;
+	const size_t unsent = unsent_control.size();
+	if (unsent > 0)
+	{
+		vector[length++] = {unsent_control.data(), unsent};
+	}
+	for (int32_t i = 0; i < count; ++i)
+	{
+		vector[length++] = items[i];
+	}
+
+#ifndef _WIN32
+	if (!wait)
+	{
+		const int64_t written = send_vector_now(*socket_provider, vector, length);
+		if (written < 0)
+		{
+			return ControlSend::Failed;
+		}
+		const size_t done = static_cast<size_t>(written);
+		if (done < unsent)
+		{
+			unsent_control.erase(unsent_control.begin(), unsent_control.begin() + done);
+			return ControlSend::Blocked;
+		}
+		// a frame is never cut short, whatever the socket didn't take of it goes out with the next send
+		unsent_control.clear();
+		size_t skip = done - unsent;
+		for (int32_t i = 0; i < count; ++i)
+		{
+			auto const* base = static_cast<Buffer::word_t const*>(items[i].iov_base);
+			const size_t taken = std::min(skip, items[i].iov_len);
+			unsent_control.insert(unsent_control.end(), base + taken, base + items[i].iov_len);
+			skip -= taken;
+		}
+		return ControlSend::Sent;
+	}
+#else
+	(void) wait;
+#endif
+	if (!send_vector(*socket_provider, send_ring.get(), vector, length, unsent + total))
+	{
+		return ControlSend::Failed;
+	}
+	unsent_control.clear();
+	return ControlSend::Sent;
+}
+
+void SocketWire::Base::schedule_ack(sequence_number_t seqn) const
+{
+	ack_seqn_to_send.store(seqn);
+	const auto now = std::chrono::steady_clock::now();
+	if (unacked_packages++ == 0)
+	{
+		first_unacked_time = now;
+	}
+	if (unacked_packages >= ack_package_threshold || now - first_unacked_time >= ack_delay)
+	{
+		flush_ack();
+	}
+}
+
+bool SocketWire::Base::flush_ack() const
+{
+	unacked_packages = 0;
+	if (ack_seqn_to_send.load() == 0)
+	{
+		return true;
+	}
+	sequence_number_t seqn = 0;
 	try
 	{
+		std::unique_lock<decltype(socket_send_lock)> guard(socket_send_lock, std::defer_lock);
+		if (!lock_for_send(guard))
+		{
+			// the processor thread is writing and piggybacks the pending ack
+			return true;
+		}
+		// taken under the lock, so acknowledgements reach the socket in order
+		seqn = ack_seqn_to_send.exchange(0);
+		if (seqn == 0)
+		{
+			return true;
+		}
+		logger->trace("{} send ack {}", id, seqn);
 		ack_buffer.rewind();
 		ack_buffer.write_integral(ACK_MESSAGE_LENGTH);
 		ack_buffer.write_integral(seqn);
+		iovec item{ack_buffer.data(), static_cast<size_t>(PACKAGE_HEADER_LENGTH)};
+		const auto result = send_control(&item, 1, PACKAGE_HEADER_LENGTH, !on_reactor);
+		if (result == ControlSend::Blocked)
 		{
-			std::lock_guard<decltype(socket_send_lock)> guard(socket_send_lock);
-			RD_ASSERT_THROW_MSG(socket_provider->Send(ack_buffer.data(), ack_buffer.get_position()) == PACKAGE_HEADER_LENGTH,
-				this->id +
-					": failed to send ack over the network"
-					", reason: " +
-					socket_provider->DescribeError())
+			// the reactor thread doesn't wait for the socket, the ack stays pending for the next ping or package
+			sequence_number_t expected = 0;
+			ack_seqn_to_send.compare_exchange_strong(expected, seqn);
+			return true;
 		}
+		RD_ASSERT_THROW_MSG(result == ControlSend::Sent,
+			this->id +
+				": failed to send ack over the network"
+				", reason: " +
+				socket_provider->DescribeError())
 		return true;
 	}
 	catch (std::exception const& e)
@@ -9,10 +9,14 @@
 #include "scheduler/base/IScheduler.h"
 #include "base/WireBase.h"
 #include "ByteBufferAsyncProcessor.h"
-#include "PkgInputStream.h"
+#include "util/bounded_queue.h"
+#include "util/latency_histogram.h"
 
 #include <string>
 #include <array>
+#include <vector>
+#include <memory>
+#include <atomic>
 #include <condition_variable>
 
 #include <rd_framework_export.h>
@@ -20,14 +24,41 @@
 class CSimpleSocket;
 class CActiveSocket;
 class CPassiveSocket;
+struct iovec;
 
 namespace rd
 {
+// region predeclared
+
+class IoUring;
+// endregion
+
 class RD_FRAMEWORK_API SocketWire
 {
 	static std::chrono::milliseconds timeout;
 
+	static std::atomic<bool> reactor_enabled;
+
+	static std::atomic<bool> io_uring_enabled;
+
 public:
+	/**
+	 * \brief Lets connections established from now on be driven by the shared [SocketReactor] instead of a receiver and
+	 * a heartbeat thread each. Ignored where the reactor isn't supported.
+	 */
+	static void set_reactor_enabled(bool enabled);
+
+	static bool is_reactor_enabled();
+
+	/**
+	 * \brief Lets connections established from now on receive and send through io_uring instead of plain socket calls.
+	 * Ignored where the kernel doesn't support it and for connections driven by the reactor, connections fall back to
+	 * plain socket calls if setting up their rings fails.
+	 */
+	static void set_io_uring_enabled(bool enabled);
+
+	static bool is_io_uring_enabled();
+
 	class RD_FRAMEWORK_API Base : public WireBase
 	{
 	protected:
@@ -46,20 +77,73 @@ public:
 
 		mutable std::condition_variable socket_send_var;
 		mutable ByteBufferAsyncProcessor async_send_buffer{id + "-AsyncSendProcessor",
-			[this](Buffer::ByteArray const& it, sequence_number_t seqn) -> bool { return this->send0(it, seqn); }};
+			[this](ByteBufferAsyncProcessor::batch_t const& batch, sequence_number_t first_seqn) -> bool {
+				return this->send0(batch, first_seqn);
+			}};
 
 		static constexpr size_t RECEIVE_BUFFER_SIZE = 1u << 16;
-		mutable std::array<Buffer::word_t, RECEIVE_BUFFER_SIZE> receiver_buffer{};
-		mutable decltype(receiver_buffer)::iterator lo = receiver_buffer.begin(), hi = receiver_buffer.begin();
+		/**
+		 * \brief Slab of receive blocks. Packages fitting into a block are dispatched as views into it, so a block
+		 * is only reused once no dispatched message refers to it anymore.
+		 */
+		mutable std::vector<std::shared_ptr<Buffer::ByteArray>> receive_blocks;
+		mutable size_t receive_block_index = 0;
+		mutable Buffer::word_t* lo = nullptr;
+		mutable Buffer::word_t* hi = nullptr;
 
 		static constexpr size_t SEND_BUFFER_SIZE = 16 * 1024;
-		mutable Buffer local_send_buffer;
+		/**
+		 * \brief Size of the latest sent message, pooled buffers of that size are requested for the next one.
+		 */
+		mutable std::atomic<size_t> send_buffer_hint{SEND_BUFFER_SIZE};
 
 		static constexpr int32_t ACK_MESSAGE_LENGTH = -1;
 		static constexpr int32_t PING_MESSAGE_LENGTH = -2;
 		static constexpr int32_t PACKAGE_HEADER_LENGTH = sizeof(ACK_MESSAGE_LENGTH) + sizeof(sequence_number_t);
 		mutable Buffer ack_buffer{PACKAGE_HEADER_LENGTH};
 
+		/**
+		 * \brief Control frame announcing the optional features a side supports, the seqn field holds their bits.
+		 * It is only sent with compression enabled, so counterparts unaware of it never see it.
+		 */
+		static constexpr int32_t CAPABILITIES_MESSAGE_LENGTH = -3;
+		static constexpr sequence_number_t CAPABILITY_COMPRESSION = 1;
+		/**
+		 * \brief Set in the length of a package holding the uncompressed size followed by an LZ4 block.
+		 */
+		static constexpr int32_t COMPRESSED_PACKAGE_FLAG = 1 << 30;
+
+		std::atomic<bool> compression_enabled{false};
+		std::atomic<size_t> compression_threshold{DEFAULT_COMPRESSION_THRESHOLD};
+		/**
+		 * \brief Whether the current counterpart announced it decompresses packages, reset on every connection.
+		 */
+		mutable std::atomic<bool> counterpart_compression{false};
+		/**
+		 * \brief Compressed forms of the packages of the batch currently being sent, guarded by [socket_send_lock].
+		 */
+		mutable std::vector<Buffer::ByteArray> compressed_packages;
+		mutable bool package_compressed = false;
+		mutable Buffer::ByteArray compressed_package;
+		mutable std::shared_ptr<Buffer::ByteArray> decompressed_block;
+
+		mutable std::atomic<uint64_t> compressed_package_count{0};
+		mutable std::atomic<uint64_t> skipped_package_count{0};
+		mutable std::atomic<uint64_t> uncompressed_byte_count{0};
+		mutable std::atomic<uint64_t> compressed_byte_count{0};
+		mutable std::atomic<int64_t> compress_nanos{0};
+		mutable std::atomic<uint64_t> decompressed_package_count{0};
+		mutable std::atomic<int64_t> decompress_nanos{0};
+
+		/**
+		 * \brief Highest received seqn still to be acknowledged, 0 if there is none. It is taken under
+		 * [socket_send_lock] by whatever is written to the socket next, so acknowledgements ride along with packages
+		 * and pings whenever possible.
+		 */
+		mutable std::atomic<sequence_number_t> ack_seqn_to_send{0};
+		mutable int32_t unacked_packages = 0;
+		mutable std::chrono::steady_clock::time_point first_unacked_time;
+
 		/**
 		 * \brief Timestamp of this wire which increases at intervals of [heartBeatInterval].
 		 */
@@ -77,28 +161,159 @@ public:
 
 		mutable Buffer ping_pkg_header{PACKAGE_HEADER_LENGTH};
 
+		mutable std::atomic<uint64_t> sent_message_count{0};
+		mutable std::atomic<uint64_t> sent_byte_count{0};
+		mutable std::atomic<uint64_t> received_message_count{0};
+		mutable std::atomic<uint64_t> received_byte_count{0};
+		std::atomic<uint32_t> connection_count{0};
+
+		/**
+		 * \brief Send times of the latest pings in steady clock nanoseconds, indexed by their timestamp.
+		 */
+		static constexpr int32_t PING_HISTORY = 8;
+		mutable std::array<std::atomic<int64_t>, PING_HISTORY> ping_send_nanos{};
+		/**
+		 * \brief Smoothed time from sending a ping until the counterpart echoed its timestamp.
+		 */
+		mutable std::atomic<int64_t> heartbeat_echo_nanos{0};
+
+		struct SentBatch
+		{
+			sequence_number_t last_seqn = 0;
+			std::chrono::steady_clock::time_point time;
+		};
+		/**
+		 * \brief Batches sent and not yet acknowledged, pushed by the sender under [socket_send_lock] and popped by
+		 * the receiving thread. Batches are left out of the latency histogram while it is full.
+		 */
+		mutable util::bounded_queue<SentBatch> sent_batches{1024};
+		/**
+		 * \brief Batch popped from [sent_batches] which the counterpart hasn't acknowledged yet, its last_seqn is 0 if
+		 * there is none. Only touched by the receiving thread.
+		 */
+		mutable SentBatch unacknowledged_batch;
+		mutable util::latency_histogram ack_latency;
+
 		mutable sequence_number_t max_received_seqn = 0;
-		mutable Buffer send_package_header{PACKAGE_HEADER_LENGTH};
+		/**
+		 * \brief Package headers of the batch currently being sent, guarded by [socket_send_lock].
+		 */
+		mutable Buffer::ByteArray send_package_headers;
+		/**
+		 * \brief Rest of a control frame the reactor thread could only partially write, written ahead of anything else
+		 * by the next sender. Guarded by [socket_send_lock].
+		 */
+		mutable Buffer::ByteArray unsent_control;
 
 		static constexpr int32_t CHUNK_SIZE = 16370;
-		mutable int32_t sz = -1;
-		mutable RdId::hash_t id_ = -1;
-		mutable PkgInputStream receive_pkg{[this]() -> int32_t { return this->read_package(); }};
+		/**
+		 * \brief Messages up to this size that lie within a single package are dispatched as views of a receive block.
+		 */
+		static constexpr size_t MAX_VIEW_SIZE = RECEIVE_BUFFER_SIZE / 2;
+		static constexpr size_t MESSAGE_HEADER_LENGTH = sizeof(int32_t) + sizeof(RdId::hash_t);
 
+		/**
+		 * \brief Bytes of the current package which haven't been parsed yet.
+		 */
+		mutable int32_t package_remaining = 0;
+		mutable bool package_duplicate = false;
+		/**
+		 * \brief Seqn of the current package, it counts as received once the package is complete.
+		 */
+		mutable sequence_number_t package_seqn = 0;
+		/**
+		 * \brief Message size and id, they may be split between packages.
+		 */
+		mutable std::array<Buffer::word_t, MESSAGE_HEADER_LENGTH> message_header{};
+		mutable size_t message_header_read = 0;
+		mutable int32_t message_size = -1;
+		mutable RdId::hash_t message_id = 0;
+		std::atomic<size_t> max_message_size{DEFAULT_MAX_MESSAGE_SIZE};
+		/**
+		 * \brief Assembles messages which can't be dispatched as a view, at most [max_message_size] bytes.
+		 */
 		mutable Buffer message{CHUNK_SIZE};
+		/**
+		 * \brief Contiguous bytes the parser needs at [lo] to continue, the receive block must have room for them.
+		 */
+		mutable size_t receive_wanted = 0;
 
-		bool read_from_socket(Buffer::word_t* res, int32_t msglen) const;
+		Buffer::word_t* receive_block_begin() const;
 
-		template <typename T>
-		bool read_integral_from_socket(T& x) const
-		{
-			return read_from_socket(reinterpret_cast<Buffer::word_t*>(&x), sizeof(T));
-		}
+		Buffer::word_t* receive_block_end() const;
 
-		bool read_data_from_socket(Buffer::word_t* data, size_t len) const
-		{
-			return read_from_socket(reinterpret_cast<Buffer::word_t*>(data), static_cast<int32_t>(len));
-		}
+		/**
+		 * \brief Moves the received but unparsed bytes to the start of a free receive block, allocating one if needed.
+		 */
+		void switch_receive_block() const;
+
+		/**
+		 * \brief Receives from the socket into the free space of the current receive block.
+		 * \return number of bytes received, 0 if a non-blocking socket has no data, -1 if the connection is closed
+		 */
+		int32_t receive_to_block() const;
+
+		void reset_receive_state() const;
+
+		/**
+		 * \brief Rings of a connection using io_uring, null otherwise. The receive ring is only used by the receiving
+		 * thread, the send ring under [socket_send_lock].
+		 */
+		static constexpr unsigned IO_URING_ENTRIES = 4;
+		mutable std::unique_ptr<IoUring> receive_ring;
+		mutable std::unique_ptr<IoUring> send_ring;
+		/**
+		 * \brief Number of receive blocks registered with [receive_ring], they are registered again once the slab grew.
+		 */
+		mutable size_t registered_receive_blocks = 0;
+
+		void open_rings() const;
+
+		void close_rings() const;
+
+		/**
+		 * \brief Receives into the free space of the current receive block through [receive_ring].
+		 * \return number of bytes received, 0 if the connection was shut down, negated errno on failure
+		 */
+		int32_t receive_on_ring() const;
+
+		/**
+		 * \brief Parses all received bytes, handling pings and acknowledgements and dispatching complete messages.
+		 * Parsing stops at incomplete data and resumes with the next call.
+		 * \return false if the stream is broken
+		 */
+		bool process_received() const;
+
+		/**
+		 * \brief Records the current package as received and schedules its acknowledgement. A package cut off by a
+		 * lost connection isn't, so it is accepted again when resent.
+		 */
+		void complete_package() const;
+
+		/**
+		 * \brief Parses message bytes of the current package.
+		 * \return false if more data is needed
+		 */
+		bool process_message_bytes(size_t available) const;
+
+		void dispatch_message(Buffer message) const;
+
+		void on_ping(int32_t received_timestamp, int32_t received_counterpart_timestamp) const;
+
+		/**
+		 * \brief Records the send-to-ACK latency of all sent batches acknowledged by [seqn].
+		 */
+		void record_ack_latency(sequence_number_t seqn) const;
+
+		/**
+		 * \brief Set while the connection is driven by [SocketReactor], its thread must never wait for a sender.
+		 */
+		mutable std::atomic<bool> on_reactor{false};
+
+		/**
+		 * \brief Drives the connection from [SocketReactor] and returns once it is closed.
+		 */
+		void run_on_reactor() const;
 
 		void set_socket_provider(std::shared_ptr<CActiveSocket> new_socket);
 
@@ -107,6 +322,73 @@ public:
 	public:
 		static constexpr int32_t MaximumHeartbeatDelay = 3;
 		std::chrono::milliseconds heartBeatInterval = std::chrono::milliseconds(500);
+		/**
+		 * \brief Number of received packages after which they are acknowledged at the latest.
+		 */
+		int32_t ack_package_threshold = 32;
+		/**
+		 * \brief Time after which received packages are acknowledged at the latest, while packages keep arriving.
+		 * Pending acknowledgements are sent before the receiver blocks on the socket anyway.
+		 */
+		std::chrono::microseconds ack_delay = std::chrono::microseconds(500);
+
+		/**
+		 * \brief Counters of package compression, see [set_compression].
+		 */
+		struct CompressionStats
+		{
+			uint64_t compressed_packages = 0;
+			/**
+			 * \brief Packages above the threshold which were sent raw, because compression didn't pay off.
+			 */
+			uint64_t skipped_packages = 0;
+			uint64_t uncompressed_bytes = 0;
+			uint64_t compressed_bytes = 0;
+			std::chrono::nanoseconds compress_time{0};
+			uint64_t decompressed_packages = 0;
+			std::chrono::nanoseconds decompress_time{0};
+
+			double ratio() const
+			{
+				return uncompressed_bytes == 0 ? 1.0 : static_cast<double>(compressed_bytes) / uncompressed_bytes;
+			}
+		};
+
+		static constexpr size_t DEFAULT_COMPRESSION_THRESHOLD = 4096;
+
+		/**
+		 * \brief Counters and gauges of a wire, see [get_stats]. Message counts and sizes include the message header.
+		 */
+		struct Stats
+		{
+			uint64_t messages_sent = 0;
+			uint64_t bytes_sent = 0;
+			uint64_t messages_received = 0;
+			uint64_t bytes_received = 0;
+			/**
+			 * \brief Packages waiting to be sent.
+			 */
+			size_t queued_packages = 0;
+			/**
+			 * \brief Packages sent but not acknowledged yet, kept for resending after a reconnect.
+			 */
+			size_t pending_packages = 0;
+			size_t unacked_bytes = 0;
+			uint32_t reconnects = 0;
+			/**
+			 * \brief Heartbeats sent since the latest one the counterpart acknowledged.
+			 */
+			int32_t heartbeat_lag = 0;
+			/**
+			 * \brief Smoothed time from sending a ping until the counterpart echoed its timestamp. The counterpart
+			 * echoes it only with its own next ping, so this is mostly its heartbeat interval and not a round trip.
+			 */
+			std::chrono::microseconds heartbeat_echo_delay{0};
+			/**
+			 * \brief Time from writing a batch of packages to the socket until the counterpart acknowledged it.
+			 */
+			util::latency_histogram::snapshot ack_latency;
+		};
 
 		// region ctor/dtor
 
@@ -116,17 +398,62 @@ public:
 
 		// endregion
 
-		std::pair<int, sequence_number_t> read_header() const;
+		void receiverProc() const;
 
-		int32_t read_package() const;
+		/**
+		 * \brief Sends a batch of packages with a single vectored write.
+		 */
+		bool send0(ByteBufferAsyncProcessor::batch_t const& batch, sequence_number_t first_seqn) const;
 
-		bool read_and_dispatch_message() const;
+		void send(RdId const& rd_id, std::function<void(Buffer& buffer)> writer) const override;
 
-		void receiverProc() const;
+		void send(RdId const& rd_id, std::function<void(Buffer& buffer)> writer, Lane lane) const override;
 
-		bool send0(Buffer::ByteArray const& msg, sequence_number_t seqn) const;
+		void send(RdId const& rd_id, std::function<void(Buffer& buffer)> writer, Lane lane, bool lossy) const override;
 
-		void send(RdId const& rd_id, std::function<void(Buffer& buffer)> writer) const override;
+		/**
+		 * \brief Limits the bytes waiting to be sent or acknowledged, see [ByteBufferAsyncProcessor::set_limits].
+		 */
+		void set_send_queue_limits(size_t max_bytes, ByteBufferAsyncProcessor::OverflowPolicy policy) const;
+
+		/**
+		 * \brief Sets what sending does for messages of [lane] while the send queue is full, see
+		 * [ByteBufferAsyncProcessor::set_overflow_policy].
+		 */
+		void set_send_queue_overflow_policy(Lane lane, ByteBufferAsyncProcessor::OverflowPolicy policy) const;
+
+		ByteBufferAsyncProcessor::Gauges get_send_queue_gauges() const;
+
+		/**
+		 * \brief Lets packages of at least [threshold] bytes be LZ4 compressed on the send processor thread, once the
+		 * counterpart announced it supports it. Enabling it announces the support to the current counterpart as well.
+		 */
+		void set_compression(bool enabled, size_t threshold = DEFAULT_COMPRESSION_THRESHOLD);
+
+		CompressionStats get_compression_stats() const;
+
+		/**
+		 * \brief Limits the size of a received message to [max_size] bytes. The header of a larger one breaks the
+		 * connection before any of its bytes are assembled, so values that big have to be sent through [RdStream].
+		 */
+		void set_max_message_size(size_t max_size);
+
+		/**
+		 * \brief Snapshot of the counters of this wire, safe to call from any thread.
+		 */
+		Stats get_stats() const;
+
+		/**
+		 * \brief Compresses [package] into [compressed] if that saves enough bytes. Called under [socket_send_lock].
+		 */
+		bool compress_package(Buffer::ByteArray const& package, Buffer::ByteArray& compressed) const;
+
+		void send_capabilities() const;
+
+		/**
+		 * \brief Decompresses [compressed_package] and dispatches the messages it consists of.
+		 */
+		void dispatch_compressed_package() const;
 
 		static bool connection_established(int32_t timestamp, int32_t acknowledged_timestamp);
 
@@ -134,7 +461,37 @@ public:
 
 		void ping() const;
 
-		bool send_ack(sequence_number_t seqn) const;
+		/**
+		 * \brief Acknowledges all packages up to [seqn], delayed until [ack_package_threshold] or [ack_delay] is reached.
+		 */
+		void schedule_ack(sequence_number_t seqn) const;
+
+		/**
+		 * \brief Sends the pending acknowledgement, if it hasn't been sent along with a package or ping meanwhile.
+		 */
+		bool flush_ack() const;
+
+		/**
+		 * \brief Locks [socket_send_lock] for a control frame, only if it is free while running on the reactor.
+		 */
+		bool lock_for_send(std::unique_lock<std::mutex>& guard) const;
+
+		enum class ControlSend
+		{
+			Sent,
+			/**
+			 * \brief The socket took no byte of the frame, it has been dropped.
+			 */
+			Blocked,
+			Failed
+		};
+
+		/**
+		 * \brief Writes the control frame [items] of [total] bytes under [socket_send_lock], after [unsent_control].
+		 * Unless [wait] is set, a non-blocking socket is never waited for: a frame it took nothing of is dropped, the
+		 * rest of a partially written one is left in [unsent_control].
+		 */
+		ControlSend send_control(iovec* items, int32_t count, size_t total, bool wait) const;
 
 		bool try_shutdown_connection() const;
 		
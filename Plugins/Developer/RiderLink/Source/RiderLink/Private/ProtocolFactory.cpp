@@ -1,10 +1,12 @@
 #include "ProtocolFactory.h"
 
 #include "scheduler/base/IScheduler.h"
+#include "wire/SharedMemoryWire.h"
 #include "wire/SocketWire.h"
 
 #include "HAL/PlatformFilemanager.h"
 #include "Misc/App.h"
+#include "Misc/CommandLine.h"
 #include "Misc/FileHelper.h"
 #include "Misc/Paths.h"
 
@@ -59,18 +61,32 @@ FString GetProjectName()
     return ProjectNameNoExtension + TEXT(".uproject");
 }
 
-std::shared_ptr<rd::SocketWire::Server> ProtocolFactory::CreateWire(rd::IScheduler* Scheduler, rd::Lifetime SocketLifetime)
+// The port file holds the port of the socket wire, or "shm:" followed by the segment name of the shared memory wire
+static FString GetPortFileContents(const std::shared_ptr<rd::IWire>& Wire)
+{
+    if (const auto SharedMemoryWire = std::dynamic_pointer_cast<rd::SharedMemoryWire::Server>(Wire))
+    {
+        return TEXT("shm:") + FString(UTF8_TO_TCHAR(SharedMemoryWire->name.c_str()));
+    }
+    return FString::FromInt(std::static_pointer_cast<rd::SocketWire::Server>(Wire)->port);
+}
+
+std::shared_ptr<rd::IWire> ProtocolFactory::CreateWire(rd::IScheduler* Scheduler, rd::Lifetime SocketLifetime)
 {
     const FString ProjectName = GetProjectName();
+    const std::string Id = TCHAR_TO_UTF8(*FString::Printf(TEXT("UnrealEditorServer-%s"), *ProjectName));
 
     spdlog::set_level(spdlog::level::err);
-    return std::make_shared<rd::SocketWire::Server>(SocketLifetime, Scheduler, 0,
-                                                         TCHAR_TO_UTF8(*FString::Printf(TEXT("UnrealEditorServer-%s"),
-                                                             *ProjectName)));
+    // Opt-in until the IDE side understands shared memory port files
+    if (FParse::Param(FCommandLine::Get(), TEXT("RiderLinkSharedMemory")) && rd::SharedMemoryWire::is_supported())
+    {
+        return std::make_shared<rd::SharedMemoryWire::Server>(SocketLifetime, Scheduler, Id);
+    }
+    return std::make_shared<rd::SocketWire::Server>(SocketLifetime, Scheduler, 0, Id);
 }
 
 
-TUniquePtr<rd::Protocol> ProtocolFactory::CreateProtocol(rd::IScheduler* Scheduler, rd::Lifetime SocketLifetime, std::shared_ptr<rd::SocketWire::Server> wire)
+TUniquePtr<rd::Protocol> ProtocolFactory::CreateProtocol(rd::IScheduler* Scheduler, rd::Lifetime SocketLifetime, std::shared_ptr<rd::IWire> wire)
 {
     const FString ProjectName = GetProjectName();
 
@@ -82,7 +98,7 @@ TUniquePtr<rd::Protocol> ProtocolFactory::CreateProtocol(rd::IScheduler* Schedul
     {
         const FString TmpPortFile = TEXT("~") + ProjectName;
         const FString TmpPortFileFullPath = FPaths::Combine(*PortFullDirectoryPath, *TmpPortFile);
-        FFileHelper::SaveStringToFile(FString::FromInt(wire->port), *TmpPortFileFullPath);
+        FFileHelper::SaveStringToFile(GetPortFileContents(wire), *TmpPortFileFullPath);
         const FString PortFileFullPath = FPaths::Combine(*PortFullDirectoryPath, *ProjectName);
         IFileManager::Get().Move(*PortFileFullPath, *TmpPortFileFullPath, true, true);
     }
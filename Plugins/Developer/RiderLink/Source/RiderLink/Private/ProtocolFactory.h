@@ -6,6 +6,6 @@
 #include "Templates/UniquePtr.h"
 
 namespace ProtocolFactory {
-    std::shared_ptr<rd::SocketWire::Server> CreateWire(rd::IScheduler* Scheduler, rd::Lifetime SocketLifetime);
-    TUniquePtr<rd::Protocol> CreateProtocol(rd::IScheduler* Scheduler, rd::Lifetime SocketLifetime, std::shared_ptr<rd::SocketWire::Server> wire);
+    std::shared_ptr<rd::IWire> CreateWire(rd::IScheduler* Scheduler, rd::Lifetime SocketLifetime);
+    TUniquePtr<rd::Protocol> CreateProtocol(rd::IScheduler* Scheduler, rd::Lifetime SocketLifetime, std::shared_ptr<rd::IWire> wire);
 };
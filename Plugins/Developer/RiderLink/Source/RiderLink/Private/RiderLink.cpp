@@ -3,19 +3,74 @@
 #include "ProtocolFactory.h"
 #include "UE4Library/UE4Library.Generated.h"
 
+#include "Misc/ScopeLock.h"
 #include "Misc/ScopeRWLock.h"
 #include "Modules/ModuleManager.h"
 #include "HAL/Platform.h"
+#include "Stats/Stats.h"
 
 #define LOCTEXT_NAMESPACE "RiderLink"
 
 DEFINE_LOG_CATEGORY(FLogRiderLinkModule);
 
+DECLARE_STATS_GROUP(TEXT("RiderLink"), STATGROUP_RiderLink, STATCAT_Advanced);
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Messages Sent"), STAT_RiderLinkMessagesSent, STATGROUP_RiderLink);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Bytes Sent"), STAT_RiderLinkBytesSent, STATGROUP_RiderLink);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Messages Received"), STAT_RiderLinkMessagesReceived, STATGROUP_RiderLink);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Bytes Received"), STAT_RiderLinkBytesReceived, STATGROUP_RiderLink);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Queued Packages"), STAT_RiderLinkQueuedPackages, STATGROUP_RiderLink);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Unacknowledged Packages"), STAT_RiderLinkPendingPackages, STATGROUP_RiderLink);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Unacknowledged Bytes"), STAT_RiderLinkUnackedBytes, STATGROUP_RiderLink);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Reconnects"), STAT_RiderLinkReconnects, STATGROUP_RiderLink);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Send To Ack p50 (ms)"), STAT_RiderLinkAckLatencyP50, STATGROUP_RiderLink);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Send To Ack p99 (ms)"), STAT_RiderLinkAckLatencyP99, STATGROUP_RiderLink);
+
 IMPLEMENT_MODULE(FRiderLinkModule, RiderLink);
 
+namespace
+{
+	// the model exposes its signals through reactive interfaces, the lane belongs to the entity behind them
+	template <typename T>
+	void SetLane(T const& Entity, rd::Lane Lane)
+	{
+		dynamic_cast<rd::IRdReactive const&>(Entity).lane = Lane;
+	}
+
+	template <typename T>
+	void SetLossy(T const& Entity)
+	{
+		dynamic_cast<rd::IRdReactive const&>(Entity).lossy = true;
+	}
+
+	// Play controls and call responses mustn't queue up behind a flood of log events
+	void AssignLanes(JetBrains::EditorPlugin::RdEditorModel const& Model)
+	{
+		SetLane(Model.get_playStateFromEditor(), rd::Lane::Control);
+		SetLane(Model.get_playModeFromEditor(), rd::Lane::Control);
+		SetLane(Model.get_notificationReplyFromEditor(), rd::Lane::Control);
+		SetLane(Model.get_isBlueprintPathName(), rd::Lane::Control);
+		SetLane(Model.get_getPathNameByPath(), rd::Lane::Control);
+		SetLane(Model.get_unrealLog(), rd::Lane::Bulk);
+		SetLane(Model.get_onBlueprintAdded(), rd::Lane::Bulk);
+		// A stalled IDE must not block the game thread on log events, the IDE can do without some of them
+		SetLossy(Model.get_unrealLog());
+		SetLossy(Model.get_onBlueprintAdded());
+	}
+}
+
 void FRiderLinkModule::ShutdownModule()
 {
 	UE_LOG(FLogRiderLinkModule, Verbose, TEXT("RiderLink SHUTDOWN START"));
+#if ENGINE_MAJOR_VERSION >= 5
+	FTSTicker::GetCoreTicker().RemoveTicker(StatsTickerHandle);
+#else
+	FTicker::GetCoreTicker().RemoveTicker(StatsTickerHandle);
+#endif
+	{
+		FScopeLock Lock(&StatsWireLock);
+		StatsWire.reset();
+	}
 	ModuleLifetimeDef.terminate();
 	UE_LOG(FLogRiderLinkModule, Verbose, TEXT("RiderLink SHUTDOWN FINISH"));
 }
@@ -23,6 +78,11 @@ void FRiderLinkModule::ShutdownModule()
 void FRiderLinkModule::StartupModule()
 {
 	UE_LOG(FLogRiderLinkModule, Verbose, TEXT("RiderLink STARTUP START"));
+#if ENGINE_MAJOR_VERSION >= 5
+	StatsTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FRiderLinkModule::TickStats));
+#else
+	StatsTickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FRiderLinkModule::TickStats));
+#endif
 	Scheduler.queue([this]()
 	{
 		InitProtocol();
@@ -34,7 +94,12 @@ void FRiderLinkModule::InitProtocol()
 {
 	WireLifetimeDef = MakeUnique<rd::LifetimeDefinition>(ModuleLifetimeDef.lifetime);
 	rd::Lifetime WireLifetime = WireLifetimeDef->lifetime;
-	std::shared_ptr<rd::SocketWire::Server> Wire = ProtocolFactory::CreateWire(&Scheduler, WireLifetime);
+	std::shared_ptr<rd::IWire> Wire = ProtocolFactory::CreateWire(&Scheduler, WireLifetime);
+	{
+		// only the socket wire keeps counters
+		FScopeLock Lock(&StatsWireLock);
+		StatsWire = std::dynamic_pointer_cast<rd::SocketWire::Base>(Wire);
+	}
 	Protocol = ProtocolFactory::CreateProtocol(&Scheduler, WireLifetime.create_nested(), Wire);
 	// Exception fired for Server::Base::~Base() when trying to invoke it this way
 //	WireLifetime->add_action([this]()
@@ -55,6 +120,7 @@ void FRiderLinkModule::InitProtocol()
 
 			FRWScopeLock LockOnConnect(ModelLock, SLT_Write);
 			EditorModel = MakeUnique<JetBrains::EditorPlugin::RdEditorModel>();
+			AssignLanes(*EditorModel);
 			EditorModel->connect(ConnectionLifetime, Protocol.Get());
 			JetBrains::EditorPlugin::UE4Library::serializersOwner.registerSerializersCore(
 				EditorModel->get_serialization_context().get_serializers()
@@ -72,6 +138,31 @@ void FRiderLinkModule::InitProtocol()
 	});
 }
 
+bool FRiderLinkModule::TickStats(float DeltaTime)
+{
+#if STATS
+	std::shared_ptr<rd::SocketWire::Base> Wire;
+	{
+		FScopeLock Lock(&StatsWireLock);
+		Wire = StatsWire;
+	}
+	if (!Wire) return true;
+
+	const rd::SocketWire::Base::Stats Stats = Wire->get_stats();
+	SET_DWORD_STAT(STAT_RiderLinkMessagesSent, Stats.messages_sent);
+	SET_DWORD_STAT(STAT_RiderLinkBytesSent, Stats.bytes_sent);
+	SET_DWORD_STAT(STAT_RiderLinkMessagesReceived, Stats.messages_received);
+	SET_DWORD_STAT(STAT_RiderLinkBytesReceived, Stats.bytes_received);
+	SET_DWORD_STAT(STAT_RiderLinkQueuedPackages, Stats.queued_packages);
+	SET_DWORD_STAT(STAT_RiderLinkPendingPackages, Stats.pending_packages);
+	SET_DWORD_STAT(STAT_RiderLinkUnackedBytes, Stats.unacked_bytes);
+	SET_DWORD_STAT(STAT_RiderLinkReconnects, Stats.reconnects);
+	SET_FLOAT_STAT(STAT_RiderLinkAckLatencyP50, Stats.ack_latency.percentile(0.5).count() / 1000.f);
+	SET_FLOAT_STAT(STAT_RiderLinkAckLatencyP99, Stats.ack_latency.percentile(0.99).count() / 1000.f);
+#endif
+	return true;
+}
+
 bool FRiderLinkModule::SupportsDynamicReloading() { return true; }
 
 
@@ -6,9 +6,12 @@
 #include "scheduler/SingleThreadScheduler.h"
 #include "wire/SocketWire.h"
 
+#include "Containers/Ticker.h"
+#include "HAL/CriticalSection.h"
 #include "Logging/LogMacros.h"
 #include "Logging/LogVerbosity.h"
 #include "Modules/ModuleManager.h"
+#include "Runtime/Launch/Resources/Version.h"
 
 #include "RdEditorModel/RdEditorModel.Generated.h"
 
@@ -44,6 +47,9 @@ public:
 private:
 	void InitProtocol();
 
+	/** Publishes the counters of the wire to STATGROUP_RiderLink */
+	bool TickStats(float DeltaTime);
+
 	rd::LifetimeDefinition ModuleLifetimeDef{rd::Lifetime::Eternal()};
 	rd::SingleThreadScheduler Scheduler{ModuleLifetimeDef.lifetime, "MainScheduler"};
 	TUniquePtr<rd::LifetimeDefinition> WireLifetimeDef;
@@ -51,4 +57,13 @@ private:
 	rd::RdProperty<bool> RdIsModelAlive;
 	TUniquePtr<JetBrains::EditorPlugin::RdEditorModel> EditorModel;
 	FRWLock ModelLock;
+
+	/** Wire whose counters are published, set on the scheduler thread and read on the game thread */
+	std::shared_ptr<rd::SocketWire::Base> StatsWire;
+	FCriticalSection StatsWireLock;
+#if ENGINE_MAJOR_VERSION >= 5
+	FTSTicker::FDelegateHandle StatsTickerHandle;
+#else
+	FDelegateHandle StatsTickerHandle;
+#endif
 };
@@ -11,23 +11,24 @@ void UOrbital::Init(UUniversalConstants* UniversalConstants, const FVector Initi
 	this->Mass = ObjectMass;
 }
 
+void UOrbital::SetState(const FVector& NewLocation, const FVector& NewVelocity, const float NewMass)
+{
+	this->Location = NewLocation;
+	this->Velocity = NewVelocity;
+	this->Mass = NewMass;
+}
+
 FVector UOrbital::UpdateVelocity(TArray<IOrbitalInterface*> Others)
 {
+	const float G = Constants->GetGravitationalConstant();
+	const float TimeStep = Constants->GetPhysicsTimestep();
+	const float Softening = Constants->GetSofteningLength();
+	
 	for (const auto Other : Others)
 	{
 		if (Other != this)
 		{
-			const float G = Constants->GetGravitationalConstant();
-			const float TimeStep = Constants->GetPhysicsTimestep();
-			const FVector OtherLocation = Other->GetLocation();
-			const float OtherMass = Other->GetMass();
-			
-			const float SquareDistance = (OtherLocation - Location).SizeSquared();
-			FVector ForceDirection = OtherLocation - Location;
-			ForceDirection.Normalize();
-			const FVector Force = (ForceDirection * (G * Mass * OtherMass)) / SquareDistance;
-			const FVector Acceleration = Force / Mass;
-
+			const FVector Acceleration = ComputeAcceleration(G, Location, Other->GetLocation(), Other->GetMass(), Softening);
 			Velocity += Acceleration * TimeStep;
 		}
 	}
@@ -35,6 +36,27 @@ FVector UOrbital::UpdateVelocity(TArray<IOrbitalInterface*> Others)
 	return Velocity;
 }
 
+FVector UOrbital::ApplyAcceleration(const FVector& Acceleration)
+{
+	Velocity += Acceleration * Constants->GetPhysicsTimestep();
+	return Velocity;
+}
+
+FVector UOrbital::ComputeAcceleration(
+	const float G,
+	const FVector& Location,
+	const FVector& OtherLocation,
+	const float OtherMass,
+	const float Softening)
+{
+	const FVector Offset = OtherLocation - Location;
+	const float SquareDistance = Offset.SizeSquared() + Softening * Softening;
+	if (SquareDistance <= 0) return FVector::ZeroVector;
+
+	// G * M * r / (r^2 + e^2)^(3/2), the plain inverse square law for a softening length of zero.
+	return Offset * (G * OtherMass / (SquareDistance * FMath::Sqrt(SquareDistance)));
+}
+
 FVector UOrbital::UpdateLocation()
 {
 	const float TimeStep = Constants->GetPhysicsTimestep();
@@ -49,6 +49,14 @@ public:
 	 * @param ObjectMass Orbital objects mass
 	 */
 	void Init(UUniversalConstants* UniversalConstants, FVector InitialLocation, FVector InitialVelocity, float ObjectMass);
+
+	/**
+	 * @brief Overrides the current state of the orbital.
+	 * @param NewLocation New orbital location
+	 * @param NewVelocity New orbital velocity
+	 * @param NewMass New orbital mass
+	 */
+	void SetState(const FVector& NewLocation, const FVector& NewVelocity, float NewMass);
 	
 	/**
 	 * @brief Returns the current orbital location.
@@ -84,6 +92,24 @@ public:
 	 */
 	virtual FVector UpdateVelocity(TArray<IOrbitalInterface*> Others) override;
 
+	/**
+	 * @brief Updates the velocity with an externally computed acceleration.
+	 * @param Acceleration Acceleration to apply for one timestep
+	 * @return Updated velocity
+	 */
+	virtual FVector ApplyAcceleration(const FVector& Acceleration) override;
+
+	/**
+	 * @brief Computes the gravitational acceleration another mass exerts on a given location.
+	 * @param G Gravitational constant
+	 * @param Location Location the acceleration is computed for
+	 * @param OtherLocation Location of the attracting mass
+	 * @param OtherMass Attracting mass
+	 * @param Softening Softening length, the acceleration stays finite for distances below it
+	 * @return Gravitational acceleration
+	 */
+	static FVector ComputeAcceleration(float G, const FVector& Location, const FVector& OtherLocation, float OtherMass, float Softening = 0);
+
 	/**
 	 * @brief Updates the location based on the current velocity.
 	 * @return Updated location
@@ -0,0 +1,15 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "OrbitalMechanics/OrbitalBodyTrait.h"
+#include "OrbitalMechanics/OrbitalFragments.h"
+#include "MassCommonFragments.h"
+#include "MassEntityTemplateRegistry.h"
+
+void UOrbitalBodyTrait::BuildTemplate(FMassEntityTemplateBuildContext& BuildContext, UWorld& World) const
+{
+	BuildContext.AddFragment<FTransformFragment>();
+	BuildContext.AddFragment_GetRef<FOrbitalVelocityFragment>().Value = Velocity;
+	BuildContext.AddFragment_GetRef<FOrbitalMassFragment>().Value = Mass;
+	BuildContext.AddTag<FOrbitalBodyTag>();
+	if (bMassiveBody) BuildContext.AddTag<FOrbitalMassiveBodyTag>();
+}
@@ -0,0 +1,144 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "OrbitalMechanics/OrbitalEphemeris.h"
+#include "OrbitalMechanics/Orbital.h"
+#include "Algo/BinarySearch.h"
+
+namespace OrbitalEphemeris
+{
+	/**
+	 * @brief Maximum number of simulated samples a single segment may span.
+	 */
+	constexpr int32 MaxSegmentSamples = 64;
+
+	/**
+	 * @brief Evaluates the cubic Hermite segment between two knots.
+	 * @param Start Knot the segment starts at
+	 * @param End Knot the segment ends at
+	 * @param Time Time to evaluate, has to lie within the segment
+	 * @return Interpolated location
+	 */
+	static FVector Evaluate(const FOrbitalEphemeris::FKnot& Start, const FOrbitalEphemeris::FKnot& End, const double Time)
+	{
+		const double Duration = End.Time - Start.Time;
+		if (Duration <= 0) return Start.Location;
+
+		const float S = static_cast<float>((Time - Start.Time) / Duration);
+		const float S2 = S * S;
+		const float S3 = S2 * S;
+		const float H = static_cast<float>(Duration);
+
+		return Start.Location * (2 * S3 - 3 * S2 + 1)
+			+ Start.Velocity * (H * (S3 - 2 * S2 + S))
+			+ End.Location * (-2 * S3 + 3 * S2)
+			+ End.Velocity * (H * (S3 - S2));
+	}
+
+	/**
+	 * @brief Checks whether a single segment between two samples reproduces every sample in between.
+	 * @param Samples Simulated samples
+	 * @param First Index of the first sample of the segment
+	 * @param Last Index of the last sample of the segment
+	 * @param Tolerance Maximum allowed distance
+	 * @return Flag, whether the segment stays within the tolerance
+	 */
+	static bool Fits(const TArray<FOrbitalEphemeris::FKnot>& Samples, const int32 First, const int32 Last, const float Tolerance)
+	{
+		const float SquareTolerance = Tolerance * Tolerance;
+		for (int32 i = First + 1; i < Last; i++)
+		{
+			const FVector Location = Evaluate(Samples[First], Samples[Last], Samples[i].Time);
+			if (FVector::DistSquared(Location, Samples[i].Location) > SquareTolerance) return false;
+		}
+
+		return true;
+	}
+}
+
+TSharedRef<const FOrbitalEphemeris, ESPMode::ThreadSafe> FOrbitalEphemeris::Build(
+	const TArray<FBody>& Bodies,
+	const double StartTime,
+	const float Timestep,
+	const float G,
+	const float Softening,
+	const int32 Steps,
+	const float Tolerance,
+	const int32 Version)
+{
+	const TSharedRef<FOrbitalEphemeris, ESPMode::ThreadSafe> Result = MakeShared<FOrbitalEphemeris, ESPMode::ThreadSafe>();
+	Result->StartTime = StartTime;
+	Result->EndTime = StartTime + static_cast<double>(Steps) * Timestep;
+	Result->Version = Version;
+
+	TArray<FVector> Locations;
+	TArray<FVector> Velocities;
+	TArray<TArray<FKnot>> Samples;
+	for (const auto& Body : Bodies)
+	{
+		Result->Indices.Add(Body.Orbital, Locations.Num());
+		Result->Masses.Add(Body.Mass);
+		Locations.Add(Body.Location);
+		Velocities.Add(Body.Velocity);
+		Samples.AddDefaulted_GetRef().Add({StartTime, Body.Location, Body.Velocity});
+	}
+
+	// Same integration as the simulation orbitals, every velocity is updated before any location is.
+	for (int32 Step = 1; Step <= Steps; Step++)
+	{
+		const double Time = StartTime + static_cast<double>(Step) * Timestep;
+		for (int32 i = 0; i < Locations.Num(); i++)
+		{
+			for (int32 j = 0; j < Locations.Num(); j++)
+			{
+				if (i != j) Velocities[i] += UOrbital::ComputeAcceleration(G, Locations[i], Locations[j], Result->Masses[j], Softening) * Timestep;
+			}
+		}
+		for (int32 i = 0; i < Locations.Num(); i++)
+		{
+			Locations[i] += Velocities[i] * Timestep;
+			Samples[i].Add({Time, Locations[i], Velocities[i]});
+		}
+	}
+
+	for (auto& BodySamples : Samples)
+	{
+		// Locations advance with the velocity of the following step, so the tangent at a sample lies in between.
+		for (int32 i = 0; i + 1 < BodySamples.Num(); i++)
+		{
+			BodySamples[i].Velocity = (BodySamples[i].Velocity + BodySamples[i + 1].Velocity) * 0.5f;
+		}
+
+		auto& BodyKnots = Result->Knots.AddDefaulted_GetRef();
+		BodyKnots.Add(BodySamples[0]);
+
+		int32 First = 0;
+		while (First + 1 < BodySamples.Num())
+		{
+			int32 Last = First + 1;
+			while (Last + 1 < BodySamples.Num()
+				&& Last + 1 - First <= OrbitalEphemeris::MaxSegmentSamples
+				&& OrbitalEphemeris::Fits(BodySamples, First, Last + 1, Tolerance))
+			{
+				Last++;
+			}
+
+			BodyKnots.Add(BodySamples[Last]);
+			First = Last;
+		}
+		BodyKnots.Shrink();
+	}
+
+	return Result;
+}
+
+FVector FOrbitalEphemeris::GetLocation(const int32 Index, double Time) const
+{
+	const auto& BodyKnots = Knots[Index];
+	if (BodyKnots.Num() == 1) return BodyKnots[0].Location;
+
+	Time = FMath::Clamp(Time, StartTime, EndTime);
+	const int32 Upper = Algo::UpperBoundBy(BodyKnots, Time, &FKnot::Time);
+	const int32 Segment = FMath::Clamp(Upper - 1, 0, BodyKnots.Num() - 2);
+
+	return OrbitalEphemeris::Evaluate(BodyKnots[Segment], BodyKnots[Segment + 1], Time);
+}
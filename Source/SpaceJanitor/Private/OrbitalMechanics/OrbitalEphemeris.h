@@ -0,0 +1,172 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IOrbitalInterface;
+
+/**
+ * @brief Recorded future trajectories of a set of orbitals.
+ *
+ * Every trajectory is stored as piecewise cubic Hermite segments. Segments are merged as long as every simulated
+ * sample in between stays within the given tolerance, so the error of a lookup is bounded by that tolerance.
+ * An ephemeris is built from copies of the orbital states, so it can be built on any thread, and is immutable once
+ * built and can therefore be queried concurrently from any thread.
+ */
+class FOrbitalEphemeris
+{
+public:
+	/**
+	 * @brief Segment boundary of a trajectory.
+	 */
+	struct FKnot
+	{
+		double Time;
+		FVector Location;
+		FVector Velocity;
+	};
+
+	/**
+	 * @brief State of an orbital to record.
+	 */
+	struct FBody
+	{
+		/**
+		 * @brief Orbital the state belongs to, only used as key and never dereferenced.
+		 */
+		const IOrbitalInterface* Orbital;
+		FVector Location;
+		FVector Velocity;
+		float Mass;
+	};
+
+private:
+	/**
+	 * @brief Index of each recorded orbital.
+	 */
+	TMap<const IOrbitalInterface*, int32> Indices;
+
+	/**
+	 * @brief Masses of the recorded orbitals.
+	 */
+	TArray<float> Masses;
+
+	/**
+	 * @brief Segment boundaries of each recorded orbital, sorted by time.
+	 */
+	TArray<TArray<FKnot>> Knots;
+
+	/**
+	 * @brief First time covered by the ephemeris.
+	 */
+	double StartTime = 0;
+
+	/**
+	 * @brief Last time covered by the ephemeris.
+	 */
+	double EndTime = 0;
+
+	/**
+	 * @brief Massive body set version the ephemeris was built for.
+	 */
+	int32 Version = INDEX_NONE;
+
+public:
+	/**
+	 * @brief Simulates the given orbitals and records their trajectories.
+	 * @param Bodies States of the orbitals to record
+	 * @param StartTime Simulation time of the given states
+	 * @param Timestep Physics timestep
+	 * @param G Gravitational constant
+	 * @param Softening Softening length
+	 * @param Steps Number of steps to simulate
+	 * @param Tolerance Maximum distance between the recorded and the simulated trajectory
+	 * @param Version Massive body set version the ephemeris is built for
+	 * @return Built ephemeris
+	 */
+	static TSharedRef<const FOrbitalEphemeris, ESPMode::ThreadSafe> Build(
+		const TArray<FBody>& Bodies,
+		double StartTime,
+		float Timestep,
+		float G,
+		float Softening,
+		int32 Steps,
+		float Tolerance,
+		int32 Version);
+
+	/**
+	 * @brief Returns the index of a recorded orbital.
+	 * @param Orbital Orbital to look up
+	 * @return Index of the orbital, INDEX_NONE if it has not been recorded
+	 */
+	int32 Find(const IOrbitalInterface* Orbital) const
+	{
+		const auto Index = Indices.Find(Orbital);
+		return Index != nullptr ? *Index : INDEX_NONE;
+	}
+
+	/**
+	 * @brief Returns the number of recorded orbitals.
+	 * @return Number of recorded orbitals
+	 */
+	int32 Num() const
+	{
+		return Masses.Num();
+	}
+
+	/**
+	 * @brief Returns the mass of a recorded orbital.
+	 * @param Index Index of the orbital
+	 * @return Mass of the orbital
+	 */
+	float GetMass(const int32 Index) const
+	{
+		return Masses[Index];
+	}
+
+	/**
+	 * @brief Returns the first time covered by the ephemeris.
+	 * @return Start time
+	 */
+	double GetStartTime() const
+	{
+		return StartTime;
+	}
+
+	/**
+	 * @brief Returns the last time covered by the ephemeris.
+	 * @return End time
+	 */
+	double GetEndTime() const
+	{
+		return EndTime;
+	}
+
+	/**
+	 * @brief Returns the massive body set version the ephemeris was built for.
+	 * @return Massive body set version
+	 */
+	int32 GetVersion() const
+	{
+		return Version;
+	}
+
+	/**
+	 * @brief Returns whether or not a given time is covered by the ephemeris.
+	 * @param Time Simulation time
+	 * @return Flag, whether the time is covered
+	 */
+	bool Covers(const double Time) const
+	{
+		return Time >= StartTime && Time <= EndTime;
+	}
+
+	/**
+	 * @brief Looks up the location of a recorded orbital, O(log n) in the number of segments.
+	 * @param Index Index of the orbital
+	 * @param Time Simulation time to look up, clamped to the covered time range
+	 * @return Location of the orbital at the given time
+	 */
+	FVector GetLocation(int32 Index, double Time) const;
+};
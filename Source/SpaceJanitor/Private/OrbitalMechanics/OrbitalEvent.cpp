@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "OrbitalMechanics/OrbitalEvent.h"
+#include "OrbitalMechanics/OrbitalKeyframe.h"
+#include "Engine/NetSerialization.h"
+
+namespace OrbitalEvent
+{
+	/**
+	 * @brief Precision event locations are quantized to, the default precision of keyframe locations.
+	 */
+	constexpr float LocationPrecision = 0.1f;
+}
+
+bool FOrbitalEvent::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	bOutSuccess = true;
+
+	Ar << Type;
+	Ar << BodyId;
+	Ar << SimulationStep;
+
+	switch (Type)
+	{
+	case EOrbitalEventType::Impulse:
+		bOutSuccess &= SerializePackedVector<100, 30>(Velocity, Ar);
+		break;
+	case EOrbitalEventType::Spawn:
+		{
+			FOrbitalKeyframe::SerializeQuantized(Ar, Location, OrbitalEvent::LocationPrecision);
+			bOutSuccess &= SerializePackedVector<100, 30>(Velocity, Ar);
+			Ar << Mass;
+
+			UObject* Class = BodyClass.Get();
+			bOutSuccess &= Map != nullptr && Map->SerializeObject(Ar, UClass::StaticClass(), Class);
+			if (Ar.IsLoading()) BodyClass = Cast<UClass>(Class);
+		}
+		break;
+	case EOrbitalEventType::Pickup:
+		break;
+	case EOrbitalEventType::Merge:
+		FOrbitalKeyframe::SerializeQuantized(Ar, Location, OrbitalEvent::LocationPrecision);
+		bOutSuccess &= SerializePackedVector<100, 30>(Velocity, Ar);
+		Ar << Mass;
+		break;
+	}
+
+	bOutSuccess &= !Ar.IsError();
+	return bOutSuccess;
+}
@@ -39,6 +39,15 @@ public:
 	*/
 	virtual float GetMass() const = 0;
 
+	/**
+	* @brief Returns whether or not the orbital is a massive body, massive bodies are the attractors used for trajectory prediction.
+	* @return Flag, whether the orbital is a massive body
+	*/
+	virtual bool IsMassiveBody() const
+	{
+		return false;
+	}
+
 	/**
 	* @brief Updates the velocity with a given set of other orbitals within the universe. 
 	* @param Others Other orbitals within the universe
@@ -46,6 +55,13 @@ public:
 	*/
 	virtual FVector UpdateVelocity(TArray<IOrbitalInterface*> Others) = 0;
 
+	/**
+	* @brief Updates the velocity with an externally computed acceleration.
+	* @param Acceleration Acceleration to apply for one timestep
+	* @return Updated velocity
+	*/
+	virtual FVector ApplyAcceleration(const FVector& Acceleration) = 0;
+
 	/**
 	* @brief Updates the location based on the current velocity.
 	* @return Updated location
@@ -0,0 +1,196 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "OrbitalMechanics/OrbitalKeyframe.h"
+#include "OrbitalMechanics/OrbitalMovementComponent.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace OrbitalKeyframe
+{
+	/**
+	 * @brief Flag, the orbital is sent without a baseline.
+	 */
+	constexpr uint8 Absolute = 1 << 0;
+
+	/**
+	 * @brief Flag, the orbitals mass is part of the keyframe.
+	 */
+	constexpr uint8 HasMass = 1 << 1;
+
+	/**
+	 * @brief Quantizes a vector to a given precision.
+	 * @param Vector Vector to quantize
+	 * @param Precision Precision to quantize to
+	 * @return Quantized vector
+	 */
+	static FIntVector Quantize(const FVector& Vector, const float Precision)
+	{
+		return FIntVector(
+			FMath::RoundToInt(Vector.X / Precision),
+			FMath::RoundToInt(Vector.Y / Precision),
+			FMath::RoundToInt(Vector.Z / Precision));
+	}
+
+	/**
+	 * @brief Serializes a signed value zigzag encoded and packed, small magnitudes take a single byte.
+	 * @param Ar Archive to serialize with
+	 * @param Value Value to serialize
+	 */
+	static void SerializeSigned(FArchive& Ar, int32& Value)
+	{
+		uint32 Encoded = (static_cast<uint32>(Value) << 1) ^ static_cast<uint32>(Value >> 31);
+		Ar.SerializeIntPacked(Encoded);
+		Value = static_cast<int32>(Encoded >> 1) ^ -static_cast<int32>(Encoded & 1);
+	}
+
+	/**
+	 * @brief Serializes a quantized vector.
+	 * @param Ar Archive to serialize with
+	 * @param Vector Vector to serialize
+	 */
+	static void SerializeVector(FArchive& Ar, FIntVector& Vector)
+	{
+		SerializeSigned(Ar, Vector.X);
+		SerializeSigned(Ar, Vector.Y);
+		SerializeSigned(Ar, Vector.Z);
+	}
+}
+
+FOrbitalKeyframe::FOrbitalKeyframe(const float LocationPrecision, const float VelocityPrecision)
+	: LocationPrecision(FMath::Max(LocationPrecision, KINDA_SMALL_NUMBER))
+	, VelocityPrecision(FMath::Max(VelocityPrecision, KINDA_SMALL_NUMBER))
+{
+}
+
+void FOrbitalKeyframe::Write(
+	int64 SimulationStep,
+	const float Timestep,
+	const TArray<const UOrbitalMovementComponent*>& Orbitals,
+	const int32 MaxBodies,
+	const int32 AbsoluteInterval,
+	TArray<uint8>& OutData)
+{
+	OutData.Reset();
+	FMemoryWriter Ar(OutData);
+
+	const int32 NumBodies = FMath::Min(Orbitals.Num(), FMath::Max(MaxBodies, 1));
+	uint32 PackedNumBodies = NumBodies;
+	Ar << SimulationStep;
+	Ar.SerializeIntPacked(PackedNumBodies);
+
+	if (Cursor >= Orbitals.Num()) Cursor = 0;
+	const bool bAbsoluteRound = AbsoluteInterval > 0 && Rounds % AbsoluteInterval == 0;
+
+	for (int32 i = 0; i < NumBodies; i++)
+	{
+		const auto Orbital = Orbitals[Cursor];
+		if (++Cursor >= Orbitals.Num())
+		{
+			Cursor = 0;
+			Rounds++;
+		}
+
+		uint32 BodyId = Orbital->GetBodyId();
+		float Mass = Orbital->GetMass();
+		FIntVector Location = OrbitalKeyframe::Quantize(Orbital->GetLocation(), LocationPrecision);
+		FIntVector Velocity = OrbitalKeyframe::Quantize(Orbital->GetVelocity(), VelocityPrecision);
+
+		const auto Baseline = Baselines.Find(BodyId);
+		uint8 Flags = 0;
+		if (Baseline == nullptr || bAbsoluteRound) Flags |= OrbitalKeyframe::Absolute;
+		if (Baseline == nullptr || bAbsoluteRound || Baseline->Mass != Mass) Flags |= OrbitalKeyframe::HasMass;
+
+		Ar << BodyId;
+		Ar << Flags;
+		if (Flags & OrbitalKeyframe::HasMass) Ar << Mass;
+
+		if (Flags & OrbitalKeyframe::Absolute)
+		{
+			OrbitalKeyframe::SerializeVector(Ar, Location);
+			OrbitalKeyframe::SerializeVector(Ar, Velocity);
+		}
+		else
+		{
+			FIntVector LocationDelta = Location - Predict(*Baseline, SimulationStep, Timestep);
+			FIntVector VelocityDelta = Velocity - Baseline->Velocity;
+			OrbitalKeyframe::SerializeVector(Ar, LocationDelta);
+			OrbitalKeyframe::SerializeVector(Ar, VelocityDelta);
+		}
+
+		// The reader only knows the quantized state, so that is what the next delta has to be based on.
+		Baselines.Add(BodyId, {SimulationStep, Location, Velocity, Mass});
+	}
+}
+
+bool FOrbitalKeyframe::Read(const TArrayView<const uint8> Data, const float Timestep, int64& OutSimulationStep, TArray<FOrbitalBodyState>& OutBodies)
+{
+	// Keyframes are small, copying one is cheaper than a reader over a view.
+	TArray<uint8> Bytes(Data.GetData(), Data.Num());
+	FMemoryReader Ar(Bytes);
+
+	int64 SimulationStep = 0;
+	uint32 NumBodies = 0;
+	Ar << SimulationStep;
+	Ar.SerializeIntPacked(NumBodies);
+	if (Ar.IsError()) return false;
+
+	OutBodies.Reset();
+	for (uint32 i = 0; i < NumBodies && !Ar.IsError(); i++)
+	{
+		uint32 BodyId = 0;
+		uint8 Flags = 0;
+		Ar << BodyId;
+		Ar << Flags;
+
+		const auto Baseline = Baselines.Find(BodyId);
+		float Mass = Baseline != nullptr ? Baseline->Mass : 0;
+		if (Flags & OrbitalKeyframe::HasMass) Ar << Mass;
+
+		FIntVector Location;
+		FIntVector Velocity;
+		OrbitalKeyframe::SerializeVector(Ar, Location);
+		OrbitalKeyframe::SerializeVector(Ar, Velocity);
+
+		if (!(Flags & OrbitalKeyframe::Absolute))
+		{
+			// Deltas of orbitals this reader has no baseline for wait for the next absolute round.
+			if (Baseline == nullptr) continue;
+
+			Location += Predict(*Baseline, SimulationStep, Timestep);
+			Velocity += Baseline->Velocity;
+		}
+
+		Baselines.Add(BodyId, {SimulationStep, Location, Velocity, Mass});
+		OutBodies.Add({
+			BodyId,
+			Mass,
+			FVector(Location) * LocationPrecision,
+			FVector(Velocity) * VelocityPrecision
+		});
+	}
+
+	OutSimulationStep = SimulationStep;
+	return !Ar.IsError();
+}
+
+void FOrbitalKeyframe::Forget(const uint32 BodyId)
+{
+	Baselines.Remove(BodyId);
+}
+
+void FOrbitalKeyframe::SerializeQuantized(FArchive& Ar, FVector& Vector, const float Precision)
+{
+	FIntVector Quantized = OrbitalKeyframe::Quantize(Vector, Precision);
+	OrbitalKeyframe::SerializeVector(Ar, Quantized);
+	if (Ar.IsLoading()) Vector = FVector(Quantized) * Precision;
+}
+
+FIntVector FOrbitalKeyframe::Predict(const FBaseline& Baseline, const int64 SimulationStep, const float Timestep) const
+{
+	// Computed in double precision on both ends, so writer and reader round to the same quantized location.
+	const double Scale = static_cast<double>(SimulationStep - Baseline.SimulationStep) * Timestep * VelocityPrecision / LocationPrecision;
+	return FIntVector(
+		Baseline.Location.X + static_cast<int32>(FMath::RoundToDouble(Baseline.Velocity.X * Scale)),
+		Baseline.Location.Y + static_cast<int32>(FMath::RoundToDouble(Baseline.Velocity.Y * Scale)),
+		Baseline.Location.Z + static_cast<int32>(FMath::RoundToDouble(Baseline.Velocity.Z * Scale)));
+}
@@ -0,0 +1,115 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OrbitalMechanics/UniverseSnapshot.h"
+
+class UOrbitalMovementComponent;
+
+/**
+ * @brief Quantized, delta compressed keyframes of the orbital states, used to correct client drift.
+ *
+ * Each keyframe covers a bounded slice of the orbitals in round robin order, so its size does not grow with the number
+ * of orbitals. Locations and velocities are quantized to a fixed precision, every orbital is sent as the difference to
+ * its last sent state moved ahead by its last sent velocity. Writer and reader keep the same quantized baselines, so
+ * keyframes have to be delivered reliably and in order. Every few rounds all orbitals are sent without a baseline,
+ * which lets late joining clients pick up orbitals they have no baseline for.
+ */
+class FOrbitalKeyframe
+{
+	/**
+	 * @brief Last sent quantized state of an orbital.
+	 */
+	struct FBaseline
+	{
+		int64 SimulationStep;
+		FIntVector Location;
+		FIntVector Velocity;
+		float Mass;
+	};
+
+	/**
+	 * @brief Baseline of each orbital by body identifier.
+	 */
+	TMap<uint32, FBaseline> Baselines;
+
+	/**
+	 * @brief Precision locations are quantized to.
+	 */
+	float LocationPrecision;
+
+	/**
+	 * @brief Precision velocities are quantized to.
+	 */
+	float VelocityPrecision;
+
+	/**
+	 * @brief Index of the orbital the next keyframe starts at.
+	 */
+	int32 Cursor = 0;
+
+	/**
+	 * @brief Number of completed rounds over all orbitals.
+	 */
+	int32 Rounds = 0;
+
+public:
+	/**
+	 * @brief Constructor.
+	 * @param LocationPrecision Precision locations are quantized to
+	 * @param VelocityPrecision Precision velocities are quantized to
+	 */
+	FOrbitalKeyframe(float LocationPrecision, float VelocityPrecision);
+
+	/**
+	 * @brief Writes the next keyframe.
+	 * @param SimulationStep Simulation step the orbital states belong to
+	 * @param Timestep Physics timestep
+	 * @param Orbitals All simulated orbitals
+	 * @param MaxBodies Maximum number of orbitals within a single keyframe
+	 * @param AbsoluteInterval Number of rounds after which all orbitals are sent without a baseline
+	 * @param OutData Written keyframe
+	 */
+	void Write(
+		int64 SimulationStep,
+		float Timestep,
+		const TArray<const UOrbitalMovementComponent*>& Orbitals,
+		int32 MaxBodies,
+		int32 AbsoluteInterval,
+		TArray<uint8>& OutData);
+
+	/**
+	 * @brief Reads a keyframe, orbitals without a baseline are skipped.
+	 * @param Data Keyframe to read
+	 * @param Timestep Physics timestep
+	 * @param OutSimulationStep Simulation step the orbital states belong to
+	 * @param OutBodies Decoded orbital states
+	 * @return Flag, whether the keyframe was valid
+	 */
+	bool Read(TArrayView<const uint8> Data, float Timestep, int64& OutSimulationStep, TArray<FOrbitalBodyState>& OutBodies);
+
+	/**
+	 * @brief Forgets the baseline of an orbital that is no longer simulated.
+	 * @param BodyId Identifier of the orbital
+	 */
+	void Forget(uint32 BodyId);
+
+	/**
+	 * @brief Serializes a vector quantized to 32 bit components like the keyframe vectors, so it covers their range.
+	 * @param Ar Archive to serialize with
+	 * @param Vector Vector to serialize
+	 * @param Precision Precision to quantize to
+	 */
+	static void SerializeQuantized(FArchive& Ar, FVector& Vector, float Precision);
+
+private:
+	/**
+	 * @brief Returns where a baseline will be at a given simulation step, in quantized units.
+	 * @param Baseline Baseline to move ahead
+	 * @param SimulationStep Simulation step to move to
+	 * @param Timestep Physics timestep
+	 * @return Predicted quantized location
+	 */
+	FIntVector Predict(const FBaseline& Baseline, int64 SimulationStep, float Timestep) const;
+};
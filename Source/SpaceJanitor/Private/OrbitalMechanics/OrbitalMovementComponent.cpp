@@ -8,6 +8,8 @@
 UOrbitalMovementComponent::UOrbitalMovementComponent()
 {
 	PrimaryComponentTick.bCanEverTick = true;
+	Radius = 0;
+	bMassiveBody = false;
 }
 
 AUniverse* UOrbitalMovementComponent::GetUniverse() const
@@ -21,13 +23,22 @@ AUniverse* UOrbitalMovementComponent::GetUniverse() const
 	return Cast<AUniverse>(Actor);
 }
 
+void UOrbitalMovementComponent::SetOrbitalState(const FVector& NewLocation, const FVector& NewVelocity, const float NewMass)
+{
+	Velocity = NewVelocity;
+	Mass = NewMass;
+	GetOwner()->SetActorLocation(NewLocation);
+
+	if (Orbital != nullptr) Orbital->SetState(NewLocation, NewVelocity, NewMass);
+}
+
 IOrbitalInterface* UOrbitalMovementComponent::GetSimulationOrbital(const float Timestep, const bool bUsePhysicsTimestep) const
 {
 	const auto LocalUniverse = GetUniverse();
 	const auto UniverseConstants = LocalUniverse->GetConstants();
 	const float UsedTimestep = bUsePhysicsTimestep ? UniverseConstants->GetPhysicsTimestep() : Timestep;
 
-	const auto Constants = UUniversalConstants::Create(UsedTimestep, UniverseConstants->G());
+	const auto Constants = UUniversalConstants::Create(UsedTimestep, UniverseConstants->G(), UniverseConstants->GetSofteningLength());
 	return CreateOrbital(Constants);
 }
 
@@ -49,6 +60,14 @@ FVector UOrbitalMovementComponent::UpdateVelocity(const TArray<IOrbitalInterface
 	return Velocity;
 }
 
+FVector UOrbitalMovementComponent::ApplyAcceleration(const FVector& Acceleration)
+{
+	if (Orbital == nullptr) return GetVelocity();
+
+	Velocity = Orbital->ApplyAcceleration(Acceleration);
+	return Velocity;
+}
+
 FVector UOrbitalMovementComponent::UpdateLocation()
 {
 	if (Orbital == nullptr) return GetLocation();
@@ -63,6 +82,7 @@ void UOrbitalMovementComponent::BeginPlay()
 {
 	Super::BeginPlay();
 	
+	BodyId = GetTypeHash(GetPathName());
 	Universe = GetUniverse();
 	const auto Constants = Universe->GetConstants();
 	Orbital = CreateOrbital(Constants);
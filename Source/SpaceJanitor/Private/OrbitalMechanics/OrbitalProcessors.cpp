@@ -0,0 +1,127 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "OrbitalMechanics/OrbitalProcessors.h"
+#include "OrbitalMechanics/Orbital.h"
+#include "OrbitalMechanics/OrbitalFragments.h"
+#include "OrbitalMechanics/Universe.h"
+#include "OrbitalMechanics/UniverseSubsystem.h"
+#include "MassCommonFragments.h"
+
+namespace OrbitalProcessors
+{
+	/**
+	 * @brief Returns the universe playing in a world, if it has constants to simulate with.
+	 * @param World World to look up
+	 * @return Universe, null if there is none or it has no constants
+	 */
+	static AUniverse* FindUniverse(const UWorld* World)
+	{
+		const auto Subsystem = World != nullptr ? World->GetSubsystem<UUniverseSubsystem>() : nullptr;
+		if (Subsystem == nullptr) return nullptr;
+
+		const auto Universe = Subsystem->GetUniverse();
+		return Universe != nullptr && Universe->GetConstants() != nullptr ? Universe : nullptr;
+	}
+}
+
+UOrbitalGravityProcessor::UOrbitalGravityProcessor()
+{
+	ExecutionFlags = static_cast<int32>(EProcessorExecutionFlags::All);
+
+	// The universe runs it once per simulation step, so entities take the same steps as the orbitals.
+	bAutoRegisterWithProcessingPhases = false;
+
+	// The universe and its orbitals are read while gathering the attractors, the chunks themselves run in parallel.
+	bRequiresGameThreadExecution = true;
+}
+
+void UOrbitalGravityProcessor::ConfigureQueries()
+{
+	EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FOrbitalMassFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FOrbitalVelocityFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddTagRequirement<FOrbitalBodyTag>(EMassFragmentPresence::All);
+
+	MassiveEntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadOnly);
+	MassiveEntityQuery.AddRequirement<FOrbitalMassFragment>(EMassFragmentAccess::ReadOnly);
+	MassiveEntityQuery.AddTagRequirement<FOrbitalBodyTag>(EMassFragmentPresence::All);
+	MassiveEntityQuery.AddTagRequirement<FOrbitalMassiveBodyTag>(EMassFragmentPresence::All);
+}
+
+void UOrbitalGravityProcessor::Execute(UMassEntitySubsystem& EntitySubsystem, FMassExecutionContext& Context)
+{
+	const auto Universe = OrbitalProcessors::FindUniverse(EntitySubsystem.GetWorld());
+	if (Universe == nullptr) return;
+
+	const float Timestep = Universe->GetConstants()->GetPhysicsTimestep();
+	const float G = Universe->GetConstants()->G();
+	const float Softening = Universe->GetConstants()->GetSofteningLength();
+
+	Attractors.Reset();
+	for (const auto Orbital : Universe->GetMassiveOrbitals())
+	{
+		Attractors.Add({FMassEntityHandle(), Orbital->GetLocation(), Orbital->GetMass()});
+	}
+
+	MassiveEntityQuery.ForEachEntityChunk(EntitySubsystem, Context, [this](FMassExecutionContext& ChunkContext)
+	{
+		const auto Transforms = ChunkContext.GetFragmentView<FTransformFragment>();
+		const auto Masses = ChunkContext.GetFragmentView<FOrbitalMassFragment>();
+		for (int32 i = 0; i < ChunkContext.GetNumEntities(); i++)
+		{
+			Attractors.Add({ChunkContext.GetEntity(i), Transforms[i].GetTransform().GetLocation(), Masses[i].Value});
+		}
+	});
+
+	EntityQuery.ParallelForEachEntityChunk(EntitySubsystem, Context, [this, Timestep, G, Softening](FMassExecutionContext& ChunkContext)
+	{
+		const auto Transforms = ChunkContext.GetFragmentView<FTransformFragment>();
+		const auto Velocities = ChunkContext.GetMutableFragmentView<FOrbitalVelocityFragment>();
+		for (int32 i = 0; i < ChunkContext.GetNumEntities(); i++)
+		{
+			const FMassEntityHandle Entity = ChunkContext.GetEntity(i);
+			const FVector Location = Transforms[i].GetTransform().GetLocation();
+
+			FVector Acceleration = FVector::ZeroVector;
+			for (const auto& Attractor : Attractors)
+			{
+				if (Attractor.Entity == Entity) continue;
+				Acceleration += UOrbital::ComputeAcceleration(G, Location, Attractor.Location, Attractor.Mass, Softening);
+			}
+
+			Velocities[i].Value += Acceleration * Timestep;
+		}
+	});
+}
+
+UOrbitalIntegrationProcessor::UOrbitalIntegrationProcessor()
+{
+	ExecutionFlags = static_cast<int32>(EProcessorExecutionFlags::All);
+	bAutoRegisterWithProcessingPhases = false;
+	bRequiresGameThreadExecution = true;
+}
+
+void UOrbitalIntegrationProcessor::ConfigureQueries()
+{
+	EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FOrbitalVelocityFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddTagRequirement<FOrbitalBodyTag>(EMassFragmentPresence::All);
+}
+
+void UOrbitalIntegrationProcessor::Execute(UMassEntitySubsystem& EntitySubsystem, FMassExecutionContext& Context)
+{
+	const auto Universe = OrbitalProcessors::FindUniverse(EntitySubsystem.GetWorld());
+	if (Universe == nullptr) return;
+
+	const float Timestep = Universe->GetConstants()->GetPhysicsTimestep();
+	EntityQuery.ParallelForEachEntityChunk(EntitySubsystem, Context, [Timestep](FMassExecutionContext& ChunkContext)
+	{
+		const auto Transforms = ChunkContext.GetMutableFragmentView<FTransformFragment>();
+		const auto Velocities = ChunkContext.GetFragmentView<FOrbitalVelocityFragment>();
+		for (int32 i = 0; i < ChunkContext.GetNumEntities(); i++)
+		{
+			auto& Transform = Transforms[i].GetMutableTransform();
+			Transform.SetLocation(Transform.GetLocation() + Velocities[i].Value * Timestep);
+		}
+	});
+}
@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "OrbitalMechanics/SphereOfInfluence.h"
+#include "OrbitalMechanics/Orbital.h"
+
+void FSphereOfInfluence::UpdateVelocities(
+	const TArray<IOrbitalInterface*>& Orbitals,
+	const TArray<IOrbitalInterface*>& MassiveOrbitals,
+	const float Timestep,
+	const float G,
+	const float Softening)
+{
+	BuildHierarchy(MassiveOrbitals);
+	if (Bodies.Num() == 0) return;
+
+	TArray<FVector> PreviousVelocities;
+	PreviousVelocities.Reserve(Bodies.Num());
+	for (const auto& Body : Bodies) PreviousVelocities.Add(Body.Orbital->GetVelocity());
+	for (const auto& Body : Bodies) Body.Orbital->UpdateVelocity(MassiveOrbitals);
+	for (int32 i = 0; i < Bodies.Num(); i++)
+	{
+		const FVector VelocityChange = Bodies[i].Orbital->GetVelocity() - PreviousVelocities[i];
+		Bodies[i].Acceleration = Timestep > 0 ? VelocityChange / Timestep : FVector::ZeroVector;
+	}
+
+	for (const auto Orbital : Orbitals)
+	{
+		if (BodyIndices.Contains(Orbital)) continue;
+
+		const FVector Location = Orbital->GetLocation();
+		const auto PreviousParent = Parents.Find(Orbital);
+		const auto PreviousIndex = PreviousParent != nullptr ? BodyIndices.Find(*PreviousParent) : nullptr;
+		const auto& Parent = Bodies[FindDominant(Location, PreviousIndex != nullptr ? *PreviousIndex : INDEX_NONE)];
+
+		if (PreviousParent == nullptr) Parents.Add(Orbital, Parent.Orbital);
+		else *PreviousParent = Parent.Orbital;
+
+		// Moving along with the parent plus the parents gravity integrates the particle relative to its parent.
+		const FVector Gravity = UOrbital::ComputeAcceleration(G, Location, Parent.Location, Parent.Mass, Softening);
+		Orbital->ApplyAcceleration(Parent.Acceleration + Gravity);
+	}
+}
+
+void FSphereOfInfluence::Remove(const IOrbitalInterface* Orbital)
+{
+	Parents.Remove(Orbital);
+}
+
+const IOrbitalInterface* FSphereOfInfluence::GetParent(const IOrbitalInterface* Orbital) const
+{
+	const auto Parent = Parents.Find(Orbital);
+	return Parent != nullptr ? *Parent : nullptr;
+}
+
+void FSphereOfInfluence::BuildHierarchy(const TArray<IOrbitalInterface*>& MassiveOrbitals)
+{
+	Bodies.Reset();
+	BodyIndices.Reset();
+
+	for (const auto Orbital : MassiveOrbitals)
+	{
+		Bodies.Add({Orbital, Orbital->GetLocation(), Orbital->GetMass(), INDEX_NONE, MAX_flt, FVector::ZeroVector, {}});
+	}
+	Bodies.Sort([](const FBody& A, const FBody& B) { return A.Mass > B.Mass; });
+
+	for (int32 i = 0; i < Bodies.Num(); i++)
+	{
+		BodyIndices.Add(Bodies[i].Orbital, i);
+		if (i == 0) continue;
+
+		// Every more massive body already has its radius, the smallest sphere containing this body becomes the parent.
+		int32 Parent = 0;
+		for (int32 j = 1; j < i; j++)
+		{
+			if (Contains(Bodies[j], Bodies[i].Location) && Bodies[j].Radius < Bodies[Parent].Radius) Parent = j;
+		}
+
+		const float MassRatio = Bodies[Parent].Mass > 0 ? Bodies[i].Mass / Bodies[Parent].Mass : 0;
+		Bodies[i].Parent = Parent;
+		Bodies[i].Radius = FVector::Dist(Bodies[i].Location, Bodies[Parent].Location) * FMath::Pow(MassRatio, 0.4f);
+		Bodies[Parent].Children.Add(i);
+	}
+}
+
+int32 FSphereOfInfluence::FindDominant(const FVector& Location, const int32 Start) const
+{
+	int32 Index = Bodies.IsValidIndex(Start) ? Start : 0;
+	while (!Contains(Bodies[Index], Location)) Index = Bodies[Index].Parent;
+
+	bool bDescended = true;
+	while (bDescended)
+	{
+		bDescended = false;
+		for (const auto Child : Bodies[Index].Children)
+		{
+			if (Contains(Bodies[Child], Location))
+			{
+				Index = Child;
+				bDescended = true;
+				break;
+			}
+		}
+	}
+
+	return Index;
+}
@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IOrbitalInterface;
+
+/**
+ * @brief Patched conics velocity update based on a hierarchy of spheres of influence.
+ *
+ * Massive bodies attract each other as in the full N-body simulation and form a hierarchy, where every massive body is
+ * parented to the smallest sphere of influence it lies in. Every other orbital is a test particle that only feels its
+ * dominant massive body, it is integrated relative to that body by applying the bodies own acceleration plus its
+ * gravity. Test particles are handed over between parents whenever they cross a sphere of influence.
+ */
+class FSphereOfInfluence
+{
+	/**
+	 * @brief Massive body within the hierarchy.
+	 */
+	struct FBody
+	{
+		IOrbitalInterface* Orbital;
+		FVector Location;
+		float Mass;
+		int32 Parent;
+		float Radius;
+		FVector Acceleration;
+		TArray<int32> Children;
+	};
+
+	/**
+	 * @brief Massive bodies of the current step, the root body comes first.
+	 */
+	TArray<FBody> Bodies;
+
+	/**
+	 * @brief Index of each massive body of the current step.
+	 */
+	TMap<const IOrbitalInterface*, int32> BodyIndices;
+
+	/**
+	 * @brief Dominant massive body of each test particle.
+	 */
+	TMap<const IOrbitalInterface*, const IOrbitalInterface*> Parents;
+
+public:
+	/**
+	 * @brief Updates the velocity of all orbitals by one timestep.
+	 * @param Orbitals All simulated orbitals
+	 * @param MassiveOrbitals Massive orbitals, these form the sphere of influence hierarchy
+	 * @param Timestep Physics timestep
+	 * @param G Gravitational constant
+	 * @param Softening Softening length
+	 */
+	void UpdateVelocities(
+		const TArray<IOrbitalInterface*>& Orbitals,
+		const TArray<IOrbitalInterface*>& MassiveOrbitals,
+		float Timestep,
+		float G,
+		float Softening);
+
+	/**
+	 * @brief Forgets an orbital that is no longer simulated.
+	 * @param Orbital Orbital to forget
+	 */
+	void Remove(const IOrbitalInterface* Orbital);
+
+	/**
+	 * @brief Returns the dominant massive body of a test particle.
+	 * @param Orbital Test particle
+	 * @return Dominant massive body, null if the orbital has not been assigned yet
+	 */
+	const IOrbitalInterface* GetParent(const IOrbitalInterface* Orbital) const;
+
+private:
+	/**
+	 * @brief Builds the sphere of influence hierarchy from the current massive body states.
+	 * @param MassiveOrbitals Massive orbitals
+	 */
+	void BuildHierarchy(const TArray<IOrbitalInterface*>& MassiveOrbitals);
+
+	/**
+	 * @brief Finds the dominant massive body for a location, starting at the previous one.
+	 * @param Location Location to find the dominant body for
+	 * @param Start Index of the previously dominant body, INDEX_NONE to start at the root
+	 * @return Index of the dominant body
+	 */
+	int32 FindDominant(const FVector& Location, int32 Start) const;
+
+	/**
+	 * @brief Returns whether a location lies within the sphere of influence of a massive body.
+	 * @param Body Massive body
+	 * @param Location Location to check
+	 * @return Flag, whether the location is within the sphere of influence
+	 */
+	static bool Contains(const FBody& Body, const FVector& Location)
+	{
+		return Body.Parent == INDEX_NONE || FVector::DistSquared(Body.Location, Location) <= FMath::Square(Body.Radius);
+	}
+};
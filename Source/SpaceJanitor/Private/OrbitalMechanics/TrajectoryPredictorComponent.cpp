@@ -0,0 +1,134 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "OrbitalMechanics/TrajectoryPredictorComponent.h"
+#include "OrbitalMechanics/Orbital.h"
+#include "OrbitalMechanics/OrbitalEphemeris.h"
+#include "OrbitalMechanics/OrbitalMovementComponent.h"
+#include "OrbitalMechanics/Universe.h"
+#include "Runtime/Engine/Public/DrawDebugHelpers.h"
+
+UTrajectoryPredictorComponent::UTrajectoryPredictorComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+	PredictionSteps = 1000;
+	MaxStepsPerTick = 250;
+	ResyncTolerance = 1;
+	bDrawPrediction = true;
+	DrawColor = FColor::Green;
+}
+
+void UTrajectoryPredictorComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	OrbitalMovement = GetOwner()->FindComponentByClass<UOrbitalMovementComponent>();
+}
+
+void UTrajectoryPredictorComponent::TickComponent(const float DeltaTime, const ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (OrbitalMovement == nullptr) return;
+
+	const auto Universe = OrbitalMovement->GetUniverse();
+	if (Universe == nullptr || Universe->GetConstants() == nullptr) return;
+
+	const auto Constants = Universe->GetConstants();
+	const int64 Step = Universe->GetSimulationStep();
+
+	const auto CurrentEphemeris = Universe->GetEphemeris();
+	if (!CurrentEphemeris.IsValid()) return;
+
+	// A refreshed ephemeris continues the same massive body trajectories, only a changed body set invalidates them.
+	if (!Ephemeris.IsValid() || Ephemeris->GetVersion() != CurrentEphemeris->GetVersion()) ResetPrediction();
+	Ephemeris = CurrentEphemeris;
+
+	DiscardBefore(Step);
+
+	const bool bDiverged = PredictedLocations.Num() > 0 && (
+		PredictionStartStep != Step ||
+		!PredictedLocations[0].Equals(OrbitalMovement->GetLocation(), ResyncTolerance) ||
+		!PredictedVelocities[0].Equals(OrbitalMovement->GetVelocity(), ResyncTolerance));
+
+	if (PredictedLocations.Num() == 0 || bDiverged)
+	{
+		PredictedLocations.Reset();
+		PredictedVelocities.Reset();
+		PredictedLocations.Add(OrbitalMovement->GetLocation());
+		PredictedVelocities.Add(OrbitalMovement->GetVelocity());
+		PredictionStartStep = Step;
+	}
+
+	const int32 MissingSteps = PredictionSteps + 1 - PredictedLocations.Num();
+	if (MissingSteps > 0)
+	{
+		ExtendPrediction(FMath::Min(MissingSteps, MaxStepsPerTick), Constants->GetPhysicsTimestep(), Constants->G(), Constants->GetSofteningLength());
+	}
+
+	if (bDrawPrediction) DrawPrediction();
+}
+
+void UTrajectoryPredictorComponent::ResetPrediction()
+{
+	PredictedLocations.Reset();
+	PredictedVelocities.Reset();
+}
+
+void UTrajectoryPredictorComponent::DiscardBefore(const int64 Step)
+{
+	const int64 StalePredictions = FMath::Min<int64>(Step - PredictionStartStep, PredictedLocations.Num() - 1);
+	if (StalePredictions > 0)
+	{
+		PredictedLocations.RemoveAt(0, static_cast<int32>(StalePredictions), false);
+		PredictedVelocities.RemoveAt(0, static_cast<int32>(StalePredictions), false);
+		PredictionStartStep += StalePredictions;
+	}
+}
+
+void UTrajectoryPredictorComponent::ExtendPrediction(const int32 Steps, const float Timestep, const float G, const float Softening)
+{
+	const int32 Self = Ephemeris->Find(OrbitalMovement);
+
+	FVector Location = PredictedLocations.Last();
+	FVector Velocity = PredictedVelocities.Last();
+	int64 Step = PredictionStartStep + PredictedLocations.Num() - 1;
+
+	for (int32 i = 0; i < Steps; i++, Step++)
+	{
+		const double Time = static_cast<double>(Step) * Timestep;
+		if (!Ephemeris->Covers(Time)) break;
+
+		for (int32 Body = 0; Body < Ephemeris->Num(); Body++)
+		{
+			if (Body == Self) continue;
+
+			const FVector BodyLocation = Ephemeris->GetLocation(Body, Time);
+			Velocity += UOrbital::ComputeAcceleration(G, Location, BodyLocation, Ephemeris->GetMass(Body), Softening) * Timestep;
+		}
+		Location += Velocity * Timestep;
+
+		PredictedLocations.Add(Location);
+		PredictedVelocities.Add(Velocity);
+	}
+}
+
+void UTrajectoryPredictorComponent::DrawPrediction() const
+{
+	const auto World = GetWorld();
+	if (World == nullptr) return;
+
+	for (int i = 0; i + 1 < PredictedLocations.Num(); i++)
+	{
+		DrawDebugLine(
+			World,
+			PredictedLocations[i],
+			PredictedLocations[i + 1],
+			DrawColor,
+			false,
+			-1,
+			0,
+			10
+			);
+	}
+}
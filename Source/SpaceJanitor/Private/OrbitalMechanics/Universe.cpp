@@ -2,7 +2,14 @@
 
 #include "OrbitalMechanics/Universe.h"
 #include "OrbitalMechanics/Orbital.h"
+#include "OrbitalMechanics/OrbitalEphemeris.h"
+#include "OrbitalMechanics/OrbitalKeyframe.h"
 #include "OrbitalMechanics/OrbitalMovementComponent.h"
+#include "OrbitalMechanics/SphereOfInfluence.h"
+#include "OrbitalMechanics/UniverseSnapshot.h"
+#include "OrbitalMechanics/UniverseSubsystem.h"
+#include "Async/Async.h"
+#include "Runtime/Engine/Classes/Engine/Engine.h"
 #include "Runtime/Engine/Classes/Kismet/GameplayStatics.h"
 #include "Runtime/Engine/Public/DrawDebugHelpers.h"
 
@@ -14,20 +21,47 @@ AUniverse::AUniverse()
 	SimulationSteps = 1000;
 	SimulationTimestep = 0.1f;
 	bUsePhysicsTimestep = false;
+	MaxStepsPerTick = 8;
+	EphemerisSteps = 10000;
+	EphemerisTolerance = 1;
+	bUseSphereOfInfluence = false;
+	bMergeCollidingOrbitals = false;
+	KeyframeInterval = 60;
+	MaxKeyframeBodies = 64;
+	AbsoluteKeyframeInterval = 10;
+	KeyframeLocationPrecision = 0.1f;
+	KeyframeVelocityPrecision = 0.01f;
+	SphereOfInfluence = MakeUnique<FSphereOfInfluence>();
+
+	// Orbitals do not replicate themselves, every client runs the simulation and only receives what breaks determinism.
+	bReplicates = true;
+	bAlwaysRelevant = true;
 }
 
+AUniverse::~AUniverse() = default;
+
 void AUniverse::Tick(const float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
 	if (ShouldTickIfViewportsOnly())
 	{
-		PrimaryActorTick.TickInterval = SimulationTickInterval;
 		EditorSimulate();
 	}
-	else
+	else if (Constants != nullptr && Constants->GetPhysicsTimestep() > 0)
 	{
-		Simulate();
+		// Steps are a fixed amount of game time on every machine, so step differences between server and clients are time.
+		const float Timestep = Constants->GetPhysicsTimestep();
+		StepAccumulator += DeltaTime;
+		for (int32 Step = 0; StepAccumulator >= Timestep && Step < MaxStepsPerTick; Step++)
+		{
+			StepAccumulator -= Timestep;
+			Simulate();
+			Replicate();
+		}
+
+		// Whatever is left after a hitch is dropped rather than simulated over the following frames.
+		StepAccumulator = FMath::Min(StepAccumulator, Timestep);
 	}
 }
 
@@ -43,14 +77,290 @@ bool AUniverse::ShouldTickIfViewportsOnly() const
 	return false;
 }
 
+#if WITH_EDITOR
+void AUniverse::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	// More steps or a different budget only change how far and how fast the orbits are extended, the reference frame
+	// is only applied when drawing.
+	const FName PropertyName = PropertyChangedEvent.GetPropertyName();
+	if (PropertyName == GET_MEMBER_NAME_CHECKED(AUniverse, DrawOrbitsRelativeTo))
+	{
+		bRedrawEditorSimulation = true;
+	}
+	else if (PropertyName != GET_MEMBER_NAME_CHECKED(AUniverse, SimulationSteps)
+		&& PropertyName != GET_MEMBER_NAME_CHECKED(AUniverse, SimulationBudget)
+		&& PropertyName != GET_MEMBER_NAME_CHECKED(AUniverse, SimulationTickInterval))
+	{
+		bRestartEditorSimulation = true;
+	}
+	PrimaryActorTick.TickInterval = 0;
+}
+#endif
+
+void AUniverse::BeginDestroy()
+{
+#if WITH_EDITOR
+	if (GEngine != nullptr)
+	{
+		GEngine->OnLevelActorAdded().Remove(LevelActorAddedHandle);
+		GEngine->OnLevelActorDeleted().Remove(LevelActorDeletedHandle);
+	}
+	LevelActorAddedHandle.Reset();
+	LevelActorDeletedHandle.Reset();
+#endif
+
+	Super::BeginDestroy();
+}
+
+bool AUniverse::IsMassive(const IOrbitalInterface* Orbital) const
+{
+	return Orbital != nullptr && Orbital->IsMassiveBody();
+}
+
+TArray<IOrbitalInterface*> AUniverse::GetMassiveOrbitals(const IOrbitalInterface* Exclude) const
+{
+	TArray<IOrbitalInterface*> Result;
+	for (const auto Orbital : Orbitals)
+	{
+		if (Orbital != Exclude && IsMassive(Orbital)) Result.Add(Orbital);
+	}
+
+	return Result;
+}
+
+float AUniverse::GetSimulationTime() const
+{
+	const float Timestep = Constants != nullptr ? Constants->GetPhysicsTimestep() : 0;
+	return static_cast<double>(SimulationStep) * Timestep;
+}
+
+TSharedPtr<const FOrbitalEphemeris, ESPMode::ThreadSafe> AUniverse::GetEphemeris()
+{
+	check(IsInGameThread());
+
+	if (PendingEphemeris.IsValid() && PendingEphemeris.IsReady())
+	{
+		FScopeLock Lock(&EphemerisLock);
+		Ephemeris = PendingEphemeris.Consume();
+	}
+
+	auto Current = GetEphemerisSnapshot();
+	if (Constants == nullptr || PendingEphemeris.IsValid()) return Current;
+
+	// Refresh once half of the ephemeris has elapsed, so there always is at least half of it left to look ahead.
+	const double Time = static_cast<double>(SimulationStep) * Constants->GetPhysicsTimestep();
+	if (Current.IsValid()
+		&& Current->GetVersion() == MassiveOrbitalsVersion
+		&& Time >= Current->GetStartTime()
+		&& Time <= (Current->GetStartTime() + Current->GetEndTime()) * 0.5)
+	{
+		return Current;
+	}
+
+	// The worker only gets copies of the states, the orbitals are merely used as keys.
+	TArray<FOrbitalEphemeris::FBody> Bodies;
+	for (const auto MassiveOrbital : GetMassiveOrbitals())
+	{
+		Bodies.Add({MassiveOrbital, MassiveOrbital->GetLocation(), MassiveOrbital->GetVelocity(), MassiveOrbital->GetMass()});
+	}
+
+	const float Timestep = Constants->GetPhysicsTimestep();
+	const float G = Constants->G();
+	const float Softening = Constants->GetSofteningLength();
+	const int32 Steps = EphemerisSteps;
+	const float Tolerance = EphemerisTolerance;
+	const int32 Version = MassiveOrbitalsVersion;
+	PendingEphemeris = Async(EAsyncExecution::ThreadPool, [Bodies = MoveTemp(Bodies), Time, Timestep, G, Softening, Steps, Tolerance, Version]()
+	{
+		return TSharedPtr<const FOrbitalEphemeris, ESPMode::ThreadSafe>(
+			FOrbitalEphemeris::Build(Bodies, Time, Timestep, G, Softening, Steps, Tolerance, Version));
+	});
+
+	return Current;
+}
+
+TSharedPtr<const FOrbitalEphemeris, ESPMode::ThreadSafe> AUniverse::GetEphemerisSnapshot() const
+{
+	FScopeLock Lock(&EphemerisLock);
+	return Ephemeris;
+}
+
+bool AUniverse::PredictOrbitalLocation(const IOrbitalInterface* Orbital, const double Time, FVector& OutLocation) const
+{
+	const auto Current = GetEphemerisSnapshot();
+	if (Orbital == nullptr || !Current.IsValid() || !Current->Covers(Time)) return false;
+
+	const int32 Index = Current->Find(Orbital);
+	if (Index == INDEX_NONE) return false;
+
+	OutLocation = Current->GetLocation(Index, Time);
+	return true;
+}
+
+bool AUniverse::PredictBodyLocation(AActor* Body, const float Time, FVector& OutLocation)
+{
+	if (Body == nullptr) return false;
+
+	if (IsInGameThread()) GetEphemeris();
+	return PredictOrbitalLocation(Body->FindComponentByClass<UOrbitalMovementComponent>(), Time, OutLocation);
+}
+
+void AUniverse::CaptureSnapshot(TArray<uint8>& OutSnapshot) const
+{
+	FUniverseSnapshot::Write(SimulationStep, GetOrbitalMovements(), OutSnapshot);
+}
+
+bool AUniverse::RestoreSnapshot(const TArrayView<const uint8> Snapshot)
+{
+	const FUniverseSnapshotHeader* Header = nullptr;
+	TArrayView<const FOrbitalBodyState> Bodies;
+	if (!FUniverseSnapshot::Read(Snapshot, Header, Bodies)) return false;
+
+	// Snapshots hold no body classes, so bodies can neither be respawned nor destroyed to match one.
+	const auto OrbitalMovements = GetOrbitalMovementsById();
+	TSet<uint32> BodyIds;
+	for (const auto& Body : Bodies)
+	{
+		bool bDuplicate = false;
+		BodyIds.Add(Body.BodyId, &bDuplicate);
+		if (bDuplicate || !OrbitalMovements.Contains(Body.BodyId))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Universe snapshot holds body %u, which is not registered"), Body.BodyId);
+			return false;
+		}
+	}
+	if (BodyIds.Num() != OrbitalMovements.Num())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Universe snapshot holds %d bodies, %d are registered"), BodyIds.Num(), OrbitalMovements.Num());
+		return false;
+	}
+
+	for (const auto& Body : Bodies)
+	{
+		OrbitalMovements[Body.BodyId]->SetOrbitalState(Body.Location, Body.Velocity, Body.Mass);
+	}
+
+	// Everything recorded from the previous states is invalid now.
+	SimulationStep = Header->SimulationStep;
+	MassiveOrbitalsVersion++;
+	PendingEvents.Reset();
+	Keyframe = MakeUnique<FOrbitalKeyframe>(KeyframeLocationPrecision, KeyframeVelocityPrecision);
+
+	if (HasAuthority() && Constants != nullptr)
+	{
+		// Without baselines every orbital is written absolute, which replaces the baselines of the clients as well.
+		TArray<uint8> Data;
+		Keyframe->Write(
+			SimulationStep,
+			Constants->GetPhysicsTimestep(),
+			GetOrbitalMovements(),
+			OrbitalMovements.Num(),
+			AbsoluteKeyframeInterval,
+			Data);
+		MulticastRestore(Data);
+	}
+
+	return true;
+}
+
+bool AUniverse::SaveSnapshot(const FString& Filename) const
+{
+	TArray<uint8> Snapshot;
+	CaptureSnapshot(Snapshot);
+	return FUniverseSnapshot::SaveToFile(Snapshot, Filename);
+}
+
+bool AUniverse::LoadSnapshot(const FString& Filename)
+{
+	return FUniverseSnapshot::MapFile(Filename, [this](const TArrayView<const uint8> Snapshot)
+	{
+		return RestoreSnapshot(Snapshot);
+	});
+}
+
+void AUniverse::Checkpoint()
+{
+	CaptureSnapshot(CheckpointSnapshot);
+}
+
+bool AUniverse::RewindToCheckpoint()
+{
+	return CheckpointSnapshot.Num() > 0 && RestoreSnapshot(CheckpointSnapshot);
+}
+
+void AUniverse::ApplyImpulse(AActor* Body, const FVector Impulse)
+{
+	if (Body == nullptr || !HasAuthority()) return;
+
+	const auto OrbitalMovement = Body->FindComponentByClass<UOrbitalMovementComponent>();
+	if (OrbitalMovement == nullptr || OrbitalMovement->GetMass() <= 0) return;
+
+	FOrbitalEvent Event;
+	Event.Type = EOrbitalEventType::Impulse;
+	Event.BodyId = OrbitalMovement->GetBodyId();
+	Event.SimulationStep = SimulationStep;
+	Event.Velocity = Impulse / OrbitalMovement->GetMass();
+	PendingEvents.Add(Event);
+
+	OrbitalMovement->SetOrbitalState(
+		OrbitalMovement->GetLocation(),
+		OrbitalMovement->GetVelocity() + Event.Velocity,
+		OrbitalMovement->GetMass());
+	OnOrbitalStateOverridden(OrbitalMovement);
+}
+
+AActor* AUniverse::SpawnBody(const TSubclassOf<AActor> BodyClass, const FVector Location, const FVector Velocity, const float Mass)
+{
+	if (!HasAuthority()) return nullptr;
+
+	const auto OrbitalMovement = SpawnOrbital(BodyClass, Location, Velocity, Mass);
+	if (OrbitalMovement == nullptr) return nullptr;
+
+	FOrbitalEvent Event;
+	Event.Type = EOrbitalEventType::Spawn;
+	Event.BodyId = OrbitalMovement->GetBodyId();
+	Event.SimulationStep = SimulationStep;
+	Event.Location = Location;
+	Event.Velocity = Velocity;
+	Event.Mass = Mass;
+	Event.BodyClass = BodyClass;
+	PendingEvents.Add(Event);
+
+	return OrbitalMovement->GetOwner();
+}
+
+void AUniverse::PickupBody(AActor* Body)
+{
+	if (Body == nullptr || !HasAuthority()) return;
+
+	const auto OrbitalMovement = Body->FindComponentByClass<UOrbitalMovementComponent>();
+	if (OrbitalMovement != nullptr)
+	{
+		FOrbitalEvent Event;
+		Event.Type = EOrbitalEventType::Pickup;
+		Event.BodyId = OrbitalMovement->GetBodyId();
+		Event.SimulationStep = SimulationStep;
+		PendingEvents.Add(Event);
+	}
+
+	Body->Destroy();
+}
+
 void AUniverse::Register(IOrbitalInterface* Orbital)
 {
 	Orbitals.Add(Orbital);
+	if (IsMassive(Orbital)) MassiveOrbitalsVersion++;
 }
 
 void AUniverse::Unregister(IOrbitalInterface* Orbital)
 {
-	Orbitals.Remove(Orbital);
+	if (Orbitals.Remove(Orbital) > 0 && IsMassive(Orbital)) MassiveOrbitalsVersion++;
+	SphereOfInfluence->Remove(Orbital);
+
+	const auto OrbitalMovement = Cast<UOrbitalMovementComponent>(Orbital);
+	if (Keyframe.IsValid() && OrbitalMovement != nullptr) Keyframe->Forget(OrbitalMovement->GetBodyId());
 }
 
 void AUniverse::BeginPlay()
@@ -58,77 +368,432 @@ void AUniverse::BeginPlay()
 	Super::BeginPlay();
 
 	PrimaryActorTick.TickInterval = 0;
+	if (const auto World = GetWorld())
+	{
+		if (const auto Subsystem = World->GetSubsystem<UUniverseSubsystem>()) Subsystem->Register(this);
+	}
+}
+
+void AUniverse::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	if (const auto World = GetWorld())
+	{
+		if (const auto Subsystem = World->GetSubsystem<UUniverseSubsystem>()) Subsystem->Unregister(this);
+	}
 }
 
 void AUniverse::Simulate()
 {
-	for (const auto Orbital : Orbitals) Orbital->UpdateVelocity(Orbitals);
+	// Entities step first, so they are attracted by the orbitals at the same locations the orbitals start the step at.
+	const auto Subsystem = GetWorld()->GetSubsystem<UUniverseSubsystem>();
+	if (Subsystem != nullptr && Constants != nullptr) Subsystem->SimulateEntities(Constants->GetPhysicsTimestep());
+
+	if (bUseSphereOfInfluence && Constants != nullptr)
+	{
+		SphereOfInfluence->UpdateVelocities(
+			Orbitals,
+			GetMassiveOrbitals(),
+			Constants->GetPhysicsTimestep(),
+			Constants->G(),
+			Constants->GetSofteningLength());
+	}
+	else
+	{
+		for (const auto Orbital : Orbitals) Orbital->UpdateVelocity(Orbitals);
+	}
 	for (const auto Orbital : Orbitals) Orbital->UpdateLocation();
+
+	// Merges are decided by the server alone and replicated, clients could disagree about close calls.
+	if (bMergeCollidingOrbitals && HasAuthority()) MergeCollidingOrbitals();
+	SimulationStep++;
 }
 
-void AUniverse::EditorSimulate()
+void AUniverse::MergeCollidingOrbitals()
 {
-	const auto World = GetWorld();
-	if (World == nullptr) return;
-	
-	IOrbitalInterface* ReferenceFrameOrbital = nullptr;
-	const auto EditorOrbitals = GetEditorOrbitals(ReferenceFrameOrbital);
-	const FVector ReferenceFrameInitialLocation = ReferenceFrameOrbital != nullptr
-			? ReferenceFrameOrbital->GetLocation()
-			: FVector::ZeroVector;
+	TArray<UOrbitalMovementComponent*> Candidates;
+	float MaxRadius = 0;
+	for (const auto Orbital : Orbitals)
+	{
+		const auto OrbitalMovement = Cast<UOrbitalMovementComponent>(Orbital);
+		if (OrbitalMovement == nullptr || OrbitalMovement->GetRadius() <= 0) continue;
 
-	TMap<IOrbitalInterface*, TArray<FVector>> SimulationPoints;
-	for (const auto Orbital : EditorOrbitals) SimulationPoints.Add(Orbital, TArray<FVector>());
-	
-	for (int i = 0; i < SimulationSteps; i++)
+		Candidates.Add(OrbitalMovement);
+		MaxRadius = FMath::Max(MaxRadius, OrbitalMovement->GetRadius());
+	}
+	if (Candidates.Num() < 2) return;
+
+	// With cells twice the largest radius, every overlapping pair lies within neighbouring cells.
+	const float CellSize = 2 * MaxRadius;
+	const auto GetCell = [CellSize](const FVector& Location)
 	{
-		TArray<FVector> Locations;
-		
-		const FVector ReferenceFrameLocation = ReferenceFrameOrbital != nullptr
-			? ReferenceFrameOrbital->GetLocation()
-			: FVector::ZeroVector;
-		
-		for (const auto Orbital : EditorOrbitals) Orbital->UpdateVelocity(EditorOrbitals);
-		for (const auto Orbital : EditorOrbitals)
+		return FIntVector(
+			FMath::FloorToInt(Location.X / CellSize),
+			FMath::FloorToInt(Location.Y / CellSize),
+			FMath::FloorToInt(Location.Z / CellSize));
+	};
+
+	TMap<FIntVector, TArray<int32>> Cells;
+	for (int32 i = 0; i < Candidates.Num(); i++) Cells.FindOrAdd(GetCell(Candidates[i]->GetLocation())).Add(i);
+
+	TArray<FOrbitalMerge> Merges;
+	TArray<bool> Absorbed;
+	Absorbed.SetNumZeroed(Candidates.Num());
+	for (int32 i = 0; i < Candidates.Num(); i++)
+	{
+		const FIntVector Cell = GetCell(Candidates[i]->GetLocation());
+		for (int32 Neighbour = 0; Neighbour < 27 && !Absorbed[i]; Neighbour++)
 		{
-			auto Points = SimulationPoints[Orbital];
-			auto Location = Orbital->UpdateLocation();
+			const auto Others = Cells.Find(Cell + FIntVector(Neighbour % 3 - 1, Neighbour / 3 % 3 - 1, Neighbour / 9 - 1));
+			if (Others == nullptr) continue;
 
-			if (ReferenceFrameOrbital != nullptr)
+			for (const auto j : *Others)
 			{
-				const FVector ReferenceFrameOffset = ReferenceFrameLocation - ReferenceFrameInitialLocation;
-				Location -= ReferenceFrameOffset;
-			}
-			
-			if (ReferenceFrameOrbital != nullptr && Orbital == ReferenceFrameOrbital)
-			{
-				Location = ReferenceFrameInitialLocation;
+				if (j <= i || Absorbed[j]) continue;
+
+				const auto A = Candidates[i];
+				const auto B = Candidates[j];
+				const float CombinedRadius = A->GetRadius() + B->GetRadius();
+				if (FVector::DistSquared(A->GetLocation(), B->GetLocation()) > CombinedRadius * CombinedRadius) continue;
+
+				const bool bKeepA = A->GetMass() >= B->GetMass();
+				const auto Survivor = bKeepA ? A : B;
+				const auto Other = bKeepA ? B : A;
+				Absorbed[bKeepA ? j : i] = true;
+
+				const float Mass = Survivor->GetMass() + Other->GetMass();
+				const float Weight = Mass > 0 ? Other->GetMass() / Mass : 0.5f;
+				Survivor->SetOrbitalState(
+					FMath::Lerp(Survivor->GetLocation(), Other->GetLocation(), Weight),
+					FMath::Lerp(Survivor->GetVelocity(), Other->GetVelocity(), Weight),
+					Mass);
+				Survivor->SetRadius(FMath::Pow(FMath::Pow(Survivor->GetRadius(), 3) + FMath::Pow(Other->GetRadius(), 3), 1.0f / 3));
+				OnOrbitalStateOverridden(Survivor);
+
+				Merges.Add({Survivor->GetOwner(), Other->GetOwner()});
+				if (!bKeepA) break;
 			}
+		}
+	}
+	if (Merges.Num() == 0) return;
+
+	OnOrbitalsMerged.Broadcast(Merges);
+
+	for (const auto& Merge : Merges)
+	{
+		const auto Survivor = Merge.Survivor->FindComponentByClass<UOrbitalMovementComponent>();
+		const auto Other = Merge.Absorbed->FindComponentByClass<UOrbitalMovementComponent>();
+
+		FOrbitalEvent Event;
+		Event.Type = EOrbitalEventType::Merge;
+		Event.BodyId = Survivor->GetBodyId();
+		Event.SimulationStep = SimulationStep;
+		Event.Location = Survivor->GetLocation();
+		Event.Velocity = Survivor->GetVelocity();
+		Event.Mass = Survivor->GetMass();
+		PendingEvents.Add(Event);
+
+		Event.Type = EOrbitalEventType::Pickup;
+		Event.BodyId = Other->GetBodyId();
+		PendingEvents.Add(Event);
+	}
+
+	for (const auto& Merge : Merges) Merge.Absorbed->Destroy();
+}
+
+void AUniverse::Replicate()
+{
+	if (!HasAuthority() || GetNetMode() == NM_Standalone)
+	{
+		PendingEvents.Reset();
+		return;
+	}
+
+	if (PendingEvents.Num() > 0)
+	{
+		MulticastOrbitalEvents(PendingEvents);
+		PendingEvents.Reset();
+	}
+
+	if (Constants == nullptr || KeyframeInterval <= 0 || SimulationStep % KeyframeInterval != 0) return;
+	if (!Keyframe.IsValid()) Keyframe = MakeUnique<FOrbitalKeyframe>(KeyframeLocationPrecision, KeyframeVelocityPrecision);
+
+	TArray<uint8> Data;
+	Keyframe->Write(
+		SimulationStep,
+		Constants->GetPhysicsTimestep(),
+		GetOrbitalMovements(),
+		MaxKeyframeBodies,
+		AbsoluteKeyframeInterval,
+		Data);
+	MulticastKeyframe(Data);
+}
+
+void AUniverse::MulticastOrbitalEvents_Implementation(const TArray<FOrbitalEvent>& Events)
+{
+	// The server applied the events when they happened.
+	if (HasAuthority()) return;
+
+	auto OrbitalMovements = GetOrbitalMovementsById();
+	for (const auto& Event : Events) ApplyOrbitalEvent(Event, OrbitalMovements);
+}
+
+void AUniverse::MulticastKeyframe_Implementation(const TArray<uint8>& Data)
+{
+	if (HasAuthority() || Constants == nullptr) return;
+	if (!Keyframe.IsValid()) Keyframe = MakeUnique<FOrbitalKeyframe>(KeyframeLocationPrecision, KeyframeVelocityPrecision);
+
+	const float Timestep = Constants->GetPhysicsTimestep();
+	int64 KeyframeStep = 0;
+	TArray<FOrbitalBodyState> Bodies;
+	if (!Keyframe->Read(Data, Timestep, KeyframeStep, Bodies)) return;
+
+	// Clients that just joined continue counting at the servers step.
+	if (KeyframeStep > SimulationStep)
+	{
+		SimulationStep = KeyframeStep;
+		MassiveOrbitalsVersion++;
+	}
+
+	const float Lag = static_cast<float>(SimulationStep - KeyframeStep) * Timestep;
+	const auto OrbitalMovements = GetOrbitalMovementsById();
+	for (const auto& Body : Bodies)
+	{
+		const auto OrbitalMovement = OrbitalMovements.FindRef(Body.BodyId);
+		if (OrbitalMovement == nullptr) continue;
+
+		// Drift corrections within the ephemeris tolerance don't invalidate the recorded trajectories.
+		const FVector Location = Body.Location + Body.Velocity * Lag;
+		const bool bDrifted = !Location.Equals(OrbitalMovement->GetLocation(), EphemerisTolerance) || Body.Mass != OrbitalMovement->GetMass();
+		OrbitalMovement->SetOrbitalState(Location, Body.Velocity, Body.Mass);
+		if (bDrifted) OnOrbitalStateOverridden(OrbitalMovement);
+	}
+}
+
+void AUniverse::MulticastRestore_Implementation(const TArray<uint8>& Data)
+{
+	if (HasAuthority() || Constants == nullptr) return;
 
-			Points.Add(Location);
-			SimulationPoints[Orbital] = Points;
+	// The server dropped its baselines, so do the clients.
+	Keyframe = MakeUnique<FOrbitalKeyframe>(KeyframeLocationPrecision, KeyframeVelocityPrecision);
+
+	int64 KeyframeStep = 0;
+	TArray<FOrbitalBodyState> Bodies;
+	if (!Keyframe->Read(Data, Constants->GetPhysicsTimestep(), KeyframeStep, Bodies)) return;
+
+	// Restores may go back in time, unlike regular keyframes.
+	SimulationStep = KeyframeStep;
+	MassiveOrbitalsVersion++;
+
+	const auto OrbitalMovements = GetOrbitalMovementsById();
+	for (const auto& Body : Bodies)
+	{
+		const auto OrbitalMovement = OrbitalMovements.FindRef(Body.BodyId);
+		if (OrbitalMovement != nullptr) OrbitalMovement->SetOrbitalState(Body.Location, Body.Velocity, Body.Mass);
+	}
+}
+
+void AUniverse::ApplyOrbitalEvent(const FOrbitalEvent& Event, TMap<uint32, UOrbitalMovementComponent*>& OrbitalMovements)
+{
+	// The client is usually ahead of the server step the event happened at, move the change along for the difference.
+	const float Timestep = Constants != nullptr ? Constants->GetPhysicsTimestep() : 0;
+	const float Lag = static_cast<float>(FMath::Max<int64>(SimulationStep - Event.SimulationStep, 0)) * Timestep;
+
+	switch (Event.Type)
+	{
+	case EOrbitalEventType::Impulse:
+		{
+			const auto OrbitalMovement = OrbitalMovements.FindRef(Event.BodyId);
+			if (OrbitalMovement == nullptr) return;
+
+			OrbitalMovement->SetOrbitalState(
+				OrbitalMovement->GetLocation() + Event.Velocity * Lag,
+				OrbitalMovement->GetVelocity() + Event.Velocity,
+				OrbitalMovement->GetMass());
+			OnOrbitalStateOverridden(OrbitalMovement);
+		}
+		break;
+	case EOrbitalEventType::Spawn:
+		{
+			const auto OrbitalMovement = SpawnOrbital(Event.BodyClass, Event.Location + Event.Velocity * Lag, Event.Velocity, Event.Mass);
+			if (OrbitalMovement == nullptr) return;
+
+			OrbitalMovement->SetBodyId(Event.BodyId);
+			OrbitalMovements.Add(Event.BodyId, OrbitalMovement);
+		}
+		break;
+	case EOrbitalEventType::Merge:
+		{
+			const auto OrbitalMovement = OrbitalMovements.FindRef(Event.BodyId);
+			if (OrbitalMovement == nullptr) return;
+
+			OrbitalMovement->SetOrbitalState(Event.Location + Event.Velocity * Lag, Event.Velocity, Event.Mass);
+			OnOrbitalStateOverridden(OrbitalMovement);
+		}
+		break;
+	case EOrbitalEventType::Pickup:
+		{
+			UOrbitalMovementComponent* OrbitalMovement = nullptr;
+			if (OrbitalMovements.RemoveAndCopyValue(Event.BodyId, OrbitalMovement)) OrbitalMovement->GetOwner()->Destroy();
 		}
+		break;
 	}
+}
 
-	FlushPersistentDebugLines(World);
-	for (const auto Orbital : EditorOrbitals)
+void AUniverse::OnOrbitalStateOverridden(const IOrbitalInterface* Orbital)
+{
+	if (IsMassive(Orbital)) MassiveOrbitalsVersion++;
+}
+
+UOrbitalMovementComponent* AUniverse::SpawnOrbital(const TSubclassOf<AActor> BodyClass, const FVector& Location, const FVector& Velocity, const float Mass)
+{
+	const auto World = GetWorld();
+	if (World == nullptr || BodyClass == nullptr) return nullptr;
+
+	const auto Actor = World->SpawnActor<AActor>(BodyClass, Location, FRotator::ZeroRotator);
+	if (Actor == nullptr) return nullptr;
+
+	const auto OrbitalMovement = Actor->FindComponentByClass<UOrbitalMovementComponent>();
+	if (OrbitalMovement == nullptr) return nullptr;
+
+	// The orbital registered with its class defaults while spawning.
+	OrbitalMovement->SetOrbitalState(Location, Velocity, Mass);
+	OnOrbitalStateOverridden(OrbitalMovement);
+
+	return OrbitalMovement;
+}
+
+TMap<uint32, UOrbitalMovementComponent*> AUniverse::GetOrbitalMovementsById() const
+{
+	TMap<uint32, UOrbitalMovementComponent*> Result;
+	Result.Reserve(Orbitals.Num());
+	for (const auto Orbital : Orbitals)
 	{
-		const auto Points = SimulationPoints[Orbital];
-		for (int i = 0; i < Points.Num(); i++)
+		const auto OrbitalMovement = Cast<UOrbitalMovementComponent>(Orbital);
+		if (OrbitalMovement != nullptr) Result.Add(OrbitalMovement->GetBodyId(), OrbitalMovement);
+	}
+
+	return Result;
+}
+
+TArray<const UOrbitalMovementComponent*> AUniverse::GetOrbitalMovements() const
+{
+	TArray<const UOrbitalMovementComponent*> Result;
+	Result.Reserve(Orbitals.Num());
+	for (const auto Orbital : Orbitals)
+	{
+		const auto OrbitalMovement = Cast<UOrbitalMovementComponent>(Orbital);
+		if (OrbitalMovement != nullptr) Result.Add(OrbitalMovement);
+	}
+
+	return Result;
+}
+
+void AUniverse::EditorSimulate()
+{
+	const auto World = GetWorld();
+	if (World == nullptr) return;
+
+	const double Deadline = FPlatformTime::Seconds() + SimulationBudget / 1000.0;
+
+#if WITH_EDITOR
+	if (GEngine != nullptr && !LevelActorAddedHandle.IsValid())
+	{
+		LevelActorAddedHandle = GEngine->OnLevelActorAdded().AddUObject(this, &AUniverse::OnLevelActorsChanged);
+		LevelActorDeletedHandle = GEngine->OnLevelActorDeleted().AddUObject(this, &AUniverse::OnLevelActorsChanged);
+	}
+#endif
+
+	// Iterating every actor of the map is too slow to do every frame, the scan is repeated when actors are added or
+	// deleted and every tick interval for components added to or removed from existing actors.
+	const double Now = FPlatformTime::Seconds();
+	if (bRescanEditorOrbitalMovements || Now >= NextEditorScanTime)
+	{
+		EditorMapOrbitalMovements = GetEditorOrbitalMovements();
+		NextEditorScanTime = Now + SimulationTickInterval;
+		bRescanEditorOrbitalMovements = false;
+	}
+	else
+	{
+		EditorMapOrbitalMovements.RemoveAll([](const UOrbitalMovementComponent* OrbitalMovement)
 		{
-			const auto NextIndex = i + 1;
-			if (NextIndex >= Points.Num()) continue;
+			return !IsValid(OrbitalMovement);
+		});
+	}
+
+	const uint32 Hash = GetEditorSimulationHash(EditorMapOrbitalMovements);
+	if (bRestartEditorSimulation || Hash != EditorSimulationHash || EditorSimulationStep > SimulationSteps)
+	{
+		EditorSimulationHash = Hash;
+		RestartEditorSimulation(EditorMapOrbitalMovements);
+	}
+	else if (bRedrawEditorSimulation)
+	{
+		FlushPersistentDebugLines(World);
+		DrawEditorOrbits(1);
+	}
+	bRedrawEditorSimulation = false;
 
-			const auto Current = Points[i];
-			const auto Next = Points[NextIndex];
+	if (EditorSimulationStep >= SimulationSteps)
+	{
+		// Nothing left to simulate, only check for edits every now and then.
+		PrimaryActorTick.TickInterval = SimulationTickInterval;
+		return;
+	}
+	PrimaryActorTick.TickInterval = 0;
+
+	TArray<IOrbitalInterface*> Simulated(EditorOrbitals);
+	const int32 FirstPoint = EditorSimulationStep + 1;
+
+	// At least one step per frame, so a restarted simulation immediately shows the first segment of every orbit.
+	do
+	{
+		for (const auto Orbital : Simulated) Orbital->UpdateVelocity(Simulated);
+		for (int32 i = 0; i < Simulated.Num(); i++) EditorOrbitPoints[i].Add(Simulated[i]->UpdateLocation());
+
+		EditorSimulationStep++;
+	}
+	while (EditorSimulationStep < SimulationSteps && FPlatformTime::Seconds() < Deadline);
+
+	DrawEditorOrbits(FirstPoint);
+}
 
+void AUniverse::DrawEditorOrbits(const int32 FirstPoint) const
+{
+	const auto World = GetWorld();
+	if (World == nullptr) return;
+
+	const UOrbitalMovementComponent* ReferenceFrameOrbitalMovement = DrawOrbitsRelativeTo != nullptr
+		? DrawOrbitsRelativeTo->FindComponentByClass<UOrbitalMovementComponent>()
+		: nullptr;
+	const int32 ReferenceFrameIndex = EditorOrbitalMovements.IndexOfByKey(ReferenceFrameOrbitalMovement);
+	const TArray<FVector>* ReferenceFramePoints = EditorOrbitPoints.IsValidIndex(ReferenceFrameIndex)
+		? &EditorOrbitPoints[ReferenceFrameIndex]
+		: nullptr;
+
+	// Every point is moved by how far the reference frame orbital has moved from its initial location at that step.
+	const auto GetOffset = [ReferenceFramePoints](const int32 Point)
+	{
+		return ReferenceFramePoints != nullptr
+			? (*ReferenceFramePoints)[Point] - (*ReferenceFramePoints)[0]
+			: FVector::ZeroVector;
+	};
+
+	for (int32 i = 0; i < EditorOrbitPoints.Num(); i++)
+	{
+		if (i == ReferenceFrameIndex) continue;
+
+		const auto& Points = EditorOrbitPoints[i];
+		for (int32 Point = FMath::Max(FirstPoint, 1); Point < Points.Num(); Point++)
+		{
 			DrawDebugLine(
 				World,
-				Current,
-				Next,
+				Points[Point - 1] - GetOffset(Point - 1),
+				Points[Point] - GetOffset(Point),
 				FColor::Red,
 				true,
-				1,
+				-1,
 				0,
 				10
 				);
@@ -136,38 +801,73 @@ void AUniverse::EditorSimulate()
 	}
 }
 
-TArray<IOrbitalInterface*> AUniverse::GetEditorOrbitals(IOrbitalInterface*& OutReferenceFrameOrbital) const
+TArray<UOrbitalMovementComponent*> AUniverse::GetEditorOrbitalMovements() const
 {
-	TArray<IOrbitalInterface*> Result;
+	TArray<UOrbitalMovementComponent*> Result;
 	
 	const auto World = GetWorld();
 	if (World == nullptr) return Result;
-
-	const UOrbitalMovementComponent* ReferenceFrameOrbitalMovement = nullptr;
-	if (DrawOrbitsRelativeTo != nullptr)
-	{
-		const auto Component = DrawOrbitsRelativeTo->GetComponentByClass(UOrbitalMovementComponent::StaticClass());
-		if (Component != nullptr) ReferenceFrameOrbitalMovement = Cast<UOrbitalMovementComponent>(Component); 
-	}
 	
 	TArray<AActor*> Actors;
 	UGameplayStatics::GetAllActorsOfClass(World, AActor::StaticClass(), Actors);
 	for (const auto Actor : Actors)
 	{
-		const auto Component = Actor->GetComponentByClass(UOrbitalMovementComponent::StaticClass());
-		if (Component == nullptr) continue;;
-		
-		const auto OrbitalMovement = Cast<UOrbitalMovementComponent>(Component);
-		if (OrbitalMovement != nullptr)
-		{
-			const auto Orbital = OrbitalMovement->GetSimulationOrbital(SimulationTimestep, bUsePhysicsTimestep);
-			if (Orbital == nullptr) continue;
-
-			if (OrbitalMovement == ReferenceFrameOrbitalMovement) OutReferenceFrameOrbital = Orbital;
-			Result.Add(Orbital);
-		}
+		const auto OrbitalMovement = Cast<UOrbitalMovementComponent>(Actor->GetComponentByClass(UOrbitalMovementComponent::StaticClass()));
+		if (OrbitalMovement != nullptr) Result.Add(OrbitalMovement);
 	}
 
 	return Result;
 }
 
+#if WITH_EDITOR
+void AUniverse::OnLevelActorsChanged(AActor* Actor)
+{
+	if (Actor != nullptr && Actor->GetWorld() == GetWorld()) bRescanEditorOrbitalMovements = true;
+}
+#endif
+
+uint32 AUniverse::GetEditorSimulationHash(const TArray<UOrbitalMovementComponent*>& OrbitalMovements) const
+{
+	uint32 Hash = GetTypeHash(OrbitalMovements.Num());
+	if (Constants != nullptr)
+	{
+		Hash = HashCombine(Hash, GetTypeHash(Constants->GetPhysicsTimestep()));
+		Hash = HashCombine(Hash, GetTypeHash(Constants->G()));
+		Hash = HashCombine(Hash, GetTypeHash(Constants->GetSofteningLength()));
+	}
+
+	for (const auto OrbitalMovement : OrbitalMovements)
+	{
+		Hash = HashCombine(Hash, GetTypeHash(OrbitalMovement));
+		Hash = HashCombine(Hash, GetTypeHash(OrbitalMovement->GetLocation()));
+		Hash = HashCombine(Hash, GetTypeHash(OrbitalMovement->GetVelocity()));
+		Hash = HashCombine(Hash, GetTypeHash(OrbitalMovement->GetMass()));
+		Hash = HashCombine(Hash, GetTypeHash(OrbitalMovement->IsMassiveBody()));
+	}
+
+	return Hash;
+}
+
+void AUniverse::RestartEditorSimulation(const TArray<UOrbitalMovementComponent*>& OrbitalMovements)
+{
+	FlushPersistentDebugLines(GetWorld());
+
+	bRestartEditorSimulation = false;
+	EditorSimulationStep = 0;
+	EditorOrbitals.Reset();
+	EditorOrbitalMovements.Reset();
+	EditorOrbitPoints.Reset();
+	if (Constants == nullptr) return;
+
+	for (const auto OrbitalMovement : OrbitalMovements)
+	{
+		const auto Orbital = Cast<UOrbital>(OrbitalMovement->GetSimulationOrbital(SimulationTimestep, bUsePhysicsTimestep));
+		if (Orbital == nullptr) continue;
+
+		EditorOrbitals.Add(Orbital);
+		EditorOrbitalMovements.Add(OrbitalMovement);
+		auto& Points = EditorOrbitPoints.AddDefaulted_GetRef();
+		Points.Reserve(SimulationSteps + 1);
+		Points.Add(Orbital->GetLocation());
+	}
+}
@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "OrbitalMechanics/UniverseSnapshot.h"
+#include "OrbitalMechanics/OrbitalMovementComponent.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable<FOrbitalBodyState>::value, "Orbital states are copied as raw memory");
+static_assert(sizeof(FUniverseSnapshotHeader) % alignof(FOrbitalBodyState) == 0, "Orbital states have to be aligned");
+
+void FUniverseSnapshot::Write(const int64 SimulationStep, const TArray<const UOrbitalMovementComponent*>& Orbitals, TArray<uint8>& OutData)
+{
+	OutData.SetNumUninitialized(sizeof(FUniverseSnapshotHeader) + Orbitals.Num() * sizeof(FOrbitalBodyState));
+
+	const auto Header = reinterpret_cast<FUniverseSnapshotHeader*>(OutData.GetData());
+	Header->Magic = Magic;
+	Header->Version = Version;
+	Header->SimulationStep = SimulationStep;
+	Header->NumBodies = Orbitals.Num();
+	Header->BodyStride = sizeof(FOrbitalBodyState);
+
+	const auto Bodies = reinterpret_cast<FOrbitalBodyState*>(OutData.GetData() + sizeof(FUniverseSnapshotHeader));
+	for (int32 i = 0; i < Orbitals.Num(); i++)
+	{
+		const auto Orbital = Orbitals[i];
+		Bodies[i] = {Orbital->GetBodyId(), Orbital->GetMass(), Orbital->GetLocation(), Orbital->GetVelocity()};
+	}
+}
+
+bool FUniverseSnapshot::Read(const TArrayView<const uint8> Data, const FUniverseSnapshotHeader*& OutHeader, TArrayView<const FOrbitalBodyState>& OutBodies)
+{
+	if (Data.Num() < static_cast<int32>(sizeof(FUniverseSnapshotHeader))) return false;
+
+	const auto Header = reinterpret_cast<const FUniverseSnapshotHeader*>(Data.GetData());
+	if (Header->Magic != Magic || Header->Version != Version || Header->BodyStride != sizeof(FOrbitalBodyState)) return false;
+	if (Header->NumBodies < 0) return false;
+
+	const int64 ExpectedSize = sizeof(FUniverseSnapshotHeader) + static_cast<int64>(Header->NumBodies) * sizeof(FOrbitalBodyState);
+	if (Data.Num() != ExpectedSize) return false;
+
+	OutHeader = Header;
+	OutBodies = MakeArrayView(reinterpret_cast<const FOrbitalBodyState*>(Data.GetData() + sizeof(FUniverseSnapshotHeader)), Header->NumBodies);
+	return true;
+}
+
+bool FUniverseSnapshot::SaveToFile(const TArray<uint8>& Data, const FString& Filename)
+{
+	return FFileHelper::SaveArrayToFile(Data, *Filename);
+}
+
+bool FUniverseSnapshot::MapFile(const FString& Filename, const TFunctionRef<bool(TArrayView<const uint8>)> Reader)
+{
+	auto& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	const TUniquePtr<IMappedFileHandle> Handle(PlatformFile.OpenMapped(*Filename));
+	if (Handle.IsValid())
+	{
+		const TUniquePtr<IMappedFileRegion> Region(Handle->MapRegion(0, Handle->GetFileSize()));
+		if (Region.IsValid())
+		{
+			return Reader(MakeArrayView(Region->GetMappedPtr(), static_cast<int32>(Region->GetMappedSize())));
+		}
+	}
+
+	// Not every platform supports mapping files, fall back to reading the whole file.
+	TArray<uint8> Data;
+	return FFileHelper::LoadFileToArray(Data, *Filename) && Reader(Data);
+}
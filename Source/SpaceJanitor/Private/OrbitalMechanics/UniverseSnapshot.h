@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UOrbitalMovementComponent;
+
+/**
+ * @brief State of a single orbital within a universe snapshot.
+ */
+struct FOrbitalBodyState
+{
+	uint32 BodyId;
+	float Mass;
+	FVector Location;
+	FVector Velocity;
+};
+
+/**
+ * @brief Header in front of the orbital states of a universe snapshot.
+ */
+struct FUniverseSnapshotHeader
+{
+	uint32 Magic;
+	uint32 Version;
+	int64 SimulationStep;
+	int32 NumBodies;
+	uint32 BodyStride;
+};
+
+/**
+ * @brief Versioned binary snapshot of all orbital states.
+ *
+ * A snapshot is a header directly followed by a contiguous array of orbital states, so it is written and read in a
+ * single pass without any per field serialization and can be used straight from a memory mapped file.
+ */
+class FUniverseSnapshot
+{
+public:
+	/**
+	 * @brief Magic number every snapshot starts with.
+	 */
+	static constexpr uint32 Magic = 0x53554A53;
+
+	/**
+	 * @brief Current snapshot format version, has to be increased whenever the layout changes.
+	 */
+	static constexpr uint32 Version = 1;
+
+	/**
+	 * @brief Writes a snapshot of the given orbitals.
+	 * @param SimulationStep Simulation step the orbital states belong to
+	 * @param Orbitals Orbitals to capture
+	 * @param OutData Written snapshot
+	 */
+	static void Write(int64 SimulationStep, const TArray<const UOrbitalMovementComponent*>& Orbitals, TArray<uint8>& OutData);
+
+	/**
+	 * @brief Validates a snapshot and returns views onto its header and orbital states, nothing is copied.
+	 * @param Data Snapshot to read
+	 * @param OutHeader Snapshot header
+	 * @param OutBodies Orbital states
+	 * @return Flag, whether the data is a valid snapshot of the current version
+	 */
+	static bool Read(TArrayView<const uint8> Data, const FUniverseSnapshotHeader*& OutHeader, TArrayView<const FOrbitalBodyState>& OutBodies);
+
+	/**
+	 * @brief Saves a snapshot to a file.
+	 * @param Data Snapshot to save
+	 * @param Filename File to save to
+	 * @return Flag, whether the snapshot has been saved
+	 */
+	static bool SaveToFile(const TArray<uint8>& Data, const FString& Filename);
+
+	/**
+	 * @brief Memory maps a snapshot file and passes its contents to a reader, the mapping is released afterwards.
+	 * @param Filename File to map
+	 * @param Reader Reader that receives the mapped snapshot
+	 * @return Flag, whether the file could be mapped and the reader succeeded
+	 */
+	static bool MapFile(const FString& Filename, TFunctionRef<bool(TArrayView<const uint8>)> Reader);
+};
@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "OrbitalMechanics/UniverseSubsystem.h"
+#include "OrbitalMechanics/OrbitalProcessors.h"
+#include "OrbitalMechanics/Universe.h"
+#include "MassEntitySubsystem.h"
+#include "MassExecutor.h"
+
+void UUniverseSubsystem::Register(AUniverse* NewUniverse)
+{
+	Universe = NewUniverse;
+}
+
+void UUniverseSubsystem::Unregister(const AUniverse* OldUniverse)
+{
+	if (Universe.Get() == OldUniverse) Universe.Reset();
+}
+
+void UUniverseSubsystem::SimulateEntities(const float Timestep)
+{
+	const auto EntitySubsystem = GetWorld()->GetSubsystem<UMassEntitySubsystem>();
+	if (EntitySubsystem == nullptr) return;
+
+	if (EntityPipeline.Processors.Num() == 0)
+	{
+		// Run in this order, the pipeline does not sort its processors.
+		const TArray<TSubclassOf<UMassProcessor>> ProcessorClasses = {
+			UOrbitalGravityProcessor::StaticClass(),
+			UOrbitalIntegrationProcessor::StaticClass()
+		};
+		EntityPipeline.InitializeFromArray(ProcessorClasses, *this);
+	}
+
+	FMassProcessingContext Context(*EntitySubsystem, Timestep);
+	UE::Mass::Executor::Run(EntityPipeline, Context);
+}
@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTraitBase.h"
+#include "OrbitalBodyTrait.generated.h"
+
+/**
+ * @brief Turns a Mass entity into an orbital body that is simulated by the orbital processors.
+ *
+ * Meant for debris and other bodies that come in large numbers, hero objects keep using the orbital movement component.
+ * Entities are visualised by adding a Mass representation trait to the same entity config, it reads the transform.
+ */
+UCLASS(meta=(DisplayName="Orbital Body"))
+class SPACEJANITOR_API UOrbitalBodyTrait : public UMassEntityTraitBase
+{
+	GENERATED_BODY()
+
+	/**
+	 * @brief Initial velocity of the body.
+	 */
+	UPROPERTY(EditAnywhere, Category="Orbital")
+	FVector Velocity = FVector::ZeroVector;
+
+	/**
+	 * @brief Mass of the body.
+	 */
+	UPROPERTY(EditAnywhere, Category="Orbital")
+	float Mass = 1;
+
+	/**
+	 * @brief Flag, whether the body attracts all other bodies. Debris should leave it unset, every massive body adds to
+	 * the cost of simulating each entity.
+	 */
+	UPROPERTY(EditAnywhere, Category="Orbital")
+	bool bMassiveBody = false;
+
+protected:
+	/**
+	 * @brief Adds the orbital fragments to the entity template.
+	 * @param BuildContext Template build context
+	 * @param World World the entities are spawned in
+	 */
+	virtual void BuildTemplate(FMassEntityTemplateBuildContext& BuildContext, UWorld& World) const override;
+};
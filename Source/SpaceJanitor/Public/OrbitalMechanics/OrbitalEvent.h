@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OrbitalEvent.generated.h"
+
+/**
+ * @brief Kinds of gameplay events that change the simulation in a way clients can not predict.
+ */
+UENUM()
+enum class EOrbitalEventType : uint8
+{
+	Impulse,
+	Spawn,
+	Pickup,
+	Merge
+};
+
+/**
+ * @brief Gameplay event replicated by the universe, every client applies it to its own deterministic simulation.
+ */
+USTRUCT()
+struct SPACEJANITOR_API FOrbitalEvent
+{
+	GENERATED_BODY()
+
+	/**
+	 * @brief Kind of the event.
+	 */
+	UPROPERTY()
+	EOrbitalEventType Type = EOrbitalEventType::Impulse;
+
+	/**
+	 * @brief Identifier of the affected orbital.
+	 */
+	UPROPERTY()
+	uint32 BodyId = 0;
+
+	/**
+	 * @brief Simulation step the event happened at on the server.
+	 */
+	UPROPERTY()
+	int64 SimulationStep = 0;
+
+	/**
+	 * @brief Location of a spawned orbital or the new location of a merged one.
+	 */
+	UPROPERTY()
+	FVector Location = FVector::ZeroVector;
+
+	/**
+	 * @brief Velocity of a spawned or merged orbital, or the velocity change of an impulse.
+	 */
+	UPROPERTY()
+	FVector Velocity = FVector::ZeroVector;
+
+	/**
+	 * @brief Mass of a spawned or merged orbital.
+	 */
+	UPROPERTY()
+	float Mass = 0;
+
+	/**
+	 * @brief Actor class of a spawned orbital, has to have an orbital movement component and must not replicate itself.
+	 */
+	UPROPERTY()
+	TSubclassOf<AActor> BodyClass;
+
+	/**
+	 * @brief Serializes only the fields the event type uses, vectors are quantized.
+	 * @param Ar Archive to serialize with
+	 * @param Map Package map used to serialize the body class
+	 * @param bOutSuccess Flag, whether serialization succeeded
+	 * @return Flag, whether the event has been serialized
+	 */
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+/**
+ * @brief Two orbitals that collided and have been merged into one.
+ */
+USTRUCT(BlueprintType)
+struct SPACEJANITOR_API FOrbitalMerge
+{
+	GENERATED_BODY()
+
+	/**
+	 * @brief Orbital that absorbed the other one, the more massive of the two.
+	 */
+	UPROPERTY(BlueprintReadOnly, Category="Orbital")
+	AActor* Survivor = nullptr;
+
+	/**
+	 * @brief Orbital that has been absorbed, it is destroyed right after the merge has been broadcast.
+	 */
+	UPROPERTY(BlueprintReadOnly, Category="Orbital")
+	AActor* Absorbed = nullptr;
+};
+
+template<>
+struct TStructOpsTypeTraits<FOrbitalEvent> : public TStructOpsTypeTraitsBase2<FOrbitalEvent>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
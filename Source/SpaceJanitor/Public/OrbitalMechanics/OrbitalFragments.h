@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "OrbitalFragments.generated.h"
+
+/**
+ * @brief Velocity of an orbital body entity, its location lives in the transform fragment.
+ */
+USTRUCT()
+struct SPACEJANITOR_API FOrbitalVelocityFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	/**
+	 * @brief Current velocity.
+	 */
+	UPROPERTY(EditAnywhere, Category="Orbital")
+	FVector Value = FVector::ZeroVector;
+};
+
+/**
+ * @brief Mass of an orbital body entity.
+ */
+USTRUCT()
+struct SPACEJANITOR_API FOrbitalMassFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	/**
+	 * @brief Mass of the body.
+	 */
+	UPROPERTY(EditAnywhere, Category="Orbital")
+	float Value = 1;
+};
+
+/**
+ * @brief Marks entities that are simulated by the universe.
+ */
+USTRUCT()
+struct SPACEJANITOR_API FOrbitalBodyTag : public FMassTag
+{
+	GENERATED_BODY()
+};
+
+/**
+ * @brief Marks orbital body entities that attract all other entities, e.g. moons simulated as entities.
+ */
+USTRUCT()
+struct SPACEJANITOR_API FOrbitalMassiveBodyTag : public FMassTag
+{
+	GENERATED_BODY()
+};
@@ -28,6 +28,18 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Orbital Movement")
 	float Mass;
 
+	/**
+	* @brief Flag, whether the orbital is a massive body, e.g. a planet. Massive bodies attract everything, debris and pickups should leave it unset.
+	*/
+	UPROPERTY(EditAnywhere, Category="Orbital Movement")
+	bool bMassiveBody;
+
+	/**
+	* @brief Collision radius of the orbital, orbitals with a radius of zero are never merged.
+	*/
+	UPROPERTY(EditAnywhere, Category="Orbital Movement")
+	float Radius;
+
 private:
 	/**
 	 * @brief Universe component is registered on.
@@ -40,6 +52,11 @@ private:
 	 */
 	UPROPERTY()
 	class UOrbital* Orbital;
+
+	/**
+	 * @brief Identifier of the orbital that is stable across sessions and machines for level placed actors.
+	 */
+	uint32 BodyId = 0;
 	
 public:
 	/**
@@ -74,6 +91,59 @@ public:
 		return Mass;
 	}
 
+	/**
+	* @brief Returns whether or not the orbital is a massive body.
+	* @return Flag, whether the orbital is a massive body
+	*/
+	virtual bool IsMassiveBody() const override
+	{
+		return bMassiveBody;
+	}
+
+	/**
+	 * @brief Returns the collision radius of the orbital.
+	 * @return Collision radius
+	 */
+	float GetRadius() const
+	{
+		return Radius;
+	}
+
+	/**
+	 * @brief Sets the collision radius of the orbital, e.g. after it absorbed another orbital.
+	 * @param NewRadius New collision radius
+	 */
+	void SetRadius(const float NewRadius)
+	{
+		Radius = NewRadius;
+	}
+
+	/**
+	 * @brief Returns the identifier of the orbital, derived from the components path name.
+	 * @return Body identifier
+	 */
+	uint32 GetBodyId() const
+	{
+		return BodyId;
+	}
+
+	/**
+	 * @brief Overrides the identifier of the orbital, used for orbitals spawned by the server.
+	 * @param NewBodyId New body identifier
+	 */
+	void SetBodyId(const uint32 NewBodyId)
+	{
+		BodyId = NewBodyId;
+	}
+
+	/**
+	 * @brief Overrides the current orbital state, e.g. when restoring a snapshot.
+	 * @param NewLocation New orbital location
+	 * @param NewVelocity New orbital velocity
+	 * @param NewMass New orbital mass
+	 */
+	void SetOrbitalState(const FVector& NewLocation, const FVector& NewVelocity, float NewMass);
+
 	/**
 	 * @brief Returns the universe the component is registered on.
 	 * @return Universe component is registered on
@@ -95,6 +165,13 @@ public:
 	*/
 	virtual FVector UpdateVelocity(TArray<IOrbitalInterface*> Others) override;
 
+	/**
+	* @brief Updates the velocity with an externally computed acceleration.
+	* @param Acceleration Acceleration to apply for one timestep
+	* @return Updated velocity
+	*/
+	virtual FVector ApplyAcceleration(const FVector& Acceleration) override;
+
 	/**
 	* @brief Updates the location based on the current velocity.
 	* @return Updated location
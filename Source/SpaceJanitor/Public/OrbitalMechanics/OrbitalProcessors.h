@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassProcessor.h"
+#include "OrbitalProcessors.generated.h"
+
+/**
+ * @brief Updates the velocity of all orbital body entities by one physics timestep.
+ *
+ * Entities are attracted by the massive orbitals registered on the universe and by the entities tagged as massive
+ * bodies. The attractors are gathered once, afterwards the chunks are updated in parallel. Not part of the processing
+ * phases, the universe subsystem runs it for every simulation step.
+ */
+UCLASS()
+class SPACEJANITOR_API UOrbitalGravityProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+	/**
+	 * @brief Body attracting the entities.
+	 */
+	struct FAttractor
+	{
+		FMassEntityHandle Entity;
+		FVector Location;
+		float Mass;
+	};
+
+	/**
+	 * @brief Orbital body entities.
+	 */
+	FMassEntityQuery EntityQuery;
+
+	/**
+	 * @brief Orbital body entities tagged as massive bodies.
+	 */
+	FMassEntityQuery MassiveEntityQuery;
+
+	/**
+	 * @brief Attractors of the current execution.
+	 */
+	TArray<FAttractor> Attractors;
+
+public:
+	/**
+	 * @brief Default constructor.
+	 */
+	UOrbitalGravityProcessor();
+
+protected:
+	/**
+	 * @brief Configures the entity queries.
+	 */
+	virtual void ConfigureQueries() override;
+
+	/**
+	 * @brief Updates the entity velocities.
+	 * @param EntitySubsystem Entity subsystem
+	 * @param Context Execution context
+	 */
+	virtual void Execute(UMassEntitySubsystem& EntitySubsystem, FMassExecutionContext& Context) override;
+};
+
+/**
+ * @brief Moves all orbital body entities by their velocity for one physics timestep, the universe subsystem runs it
+ * after the gravity processor for every simulation step.
+ */
+UCLASS()
+class SPACEJANITOR_API UOrbitalIntegrationProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+	/**
+	 * @brief Orbital body entities.
+	 */
+	FMassEntityQuery EntityQuery;
+
+public:
+	/**
+	 * @brief Default constructor.
+	 */
+	UOrbitalIntegrationProcessor();
+
+protected:
+	/**
+	 * @brief Configures the entity query.
+	 */
+	virtual void ConfigureQueries() override;
+
+	/**
+	 * @brief Updates the entity locations.
+	 * @param EntitySubsystem Entity subsystem
+	 * @param Context Execution context
+	 */
+	virtual void Execute(UMassEntitySubsystem& EntitySubsystem, FMassExecutionContext& Context) override;
+};
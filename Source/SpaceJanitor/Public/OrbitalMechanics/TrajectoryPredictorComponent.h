@@ -0,0 +1,137 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "TrajectoryPredictorComponent.generated.h"
+
+class FOrbitalEphemeris;
+
+/**
+ * @brief Runtime trajectory predictor, predicts the orbit of the owning actors orbital movement component.
+ *
+ * Massive bodies do not depend on the predicted orbital, so their future locations are taken from the universes
+ * ephemeris. Each tick only the predicted orbital is integrated against that ephemeris and the prediction window is
+ * extended incrementally as the universe advances.
+ */
+UCLASS(ClassGroup=("Space Janitor"), meta=(BlueprintSpawnableComponent))
+class SPACEJANITOR_API UTrajectoryPredictorComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+protected:
+	/**
+	 * @brief Number of simulation steps to predict ahead.
+	 */
+	UPROPERTY(EditAnywhere, Category="Trajectory Prediction")
+	int32 PredictionSteps;
+
+	/**
+	 * @brief Maximum number of steps to integrate per tick when extending the prediction.
+	 */
+	UPROPERTY(EditAnywhere, Category="Trajectory Prediction")
+	int32 MaxStepsPerTick;
+
+	/**
+	 * @brief Distance the orbital may deviate from its prediction before the prediction gets restarted.
+	 */
+	UPROPERTY(EditAnywhere, Category="Trajectory Prediction")
+	float ResyncTolerance;
+
+	/**
+	 * @brief Flag, whether to draw the predicted trajectory.
+	 */
+	UPROPERTY(EditAnywhere, Category="Trajectory Prediction")
+	bool bDrawPrediction;
+
+	/**
+	 * @brief Color the predicted trajectory is drawn in.
+	 */
+	UPROPERTY(EditAnywhere, Category="Trajectory Prediction")
+	FColor DrawColor;
+
+private:
+	/**
+	 * @brief Orbital movement component of the owner, this is the orbital to predict.
+	 */
+	UPROPERTY()
+	class UOrbitalMovementComponent* OrbitalMovement;
+
+	/**
+	 * @brief Massive body ephemeris the prediction is integrated against.
+	 */
+	TSharedPtr<const FOrbitalEphemeris, ESPMode::ThreadSafe> Ephemeris;
+
+	/**
+	 * @brief Predicted locations, the first entry is the location at the prediction start step.
+	 */
+	TArray<FVector> PredictedLocations;
+
+	/**
+	 * @brief Predicted velocities, parallel to the predicted locations.
+	 */
+	TArray<FVector> PredictedVelocities;
+
+	/**
+	 * @brief Simulation step of the first predicted location.
+	 */
+	int64 PredictionStartStep = 0;
+
+public:
+	/**
+	 * @brief Default constructor.
+	 */
+	UTrajectoryPredictorComponent();
+
+	/**
+	 * @brief Will be called every frame.
+	 * @param DeltaTime Time since the last tick
+	 * @param TickType Kind of tick
+	 * @param ThisTickFunction Tick function that caused this tick
+	 */
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/**
+	 * @brief Returns the predicted locations, starting at the current simulation step.
+	 * @return Predicted locations
+	 */
+	UFUNCTION(BlueprintCallable, Category="Trajectory Prediction")
+	TArray<FVector> GetPredictedLocations() const
+	{
+		return PredictedLocations;
+	}
+
+	/**
+	 * @brief Discards the prediction, it will be restarted from the current orbital state on the next tick.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Trajectory Prediction")
+	void ResetPrediction();
+
+protected:
+	/**
+	 * @brief Will be called when the game starts or when the component is added to an actor.
+	 */
+	virtual void BeginPlay() override;
+
+private:
+	/**
+	 * @brief Drops predicted states that lie before a given simulation step.
+	 * @param Step Current simulation step
+	 */
+	void DiscardBefore(int64 Step);
+
+	/**
+	 * @brief Integrates the predicted orbital by a number of steps against the massive body ephemeris.
+	 * @param Steps Number of steps to integrate
+	 * @param Timestep Timestep to integrate with
+	 * @param G Gravitational constant
+	 * @param Softening Softening length
+	 */
+	void ExtendPrediction(int32 Steps, float Timestep, float G, float Softening);
+
+	/**
+	 * @brief Draws the predicted trajectory.
+	 */
+	void DrawPrediction() const;
+};
@@ -27,17 +27,25 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Constants")
 	float GravitationalConstant;
 
+	/**
+	 * @brief Softening length, keeps the gravitational acceleration between close bodies finite.
+	 */
+	UPROPERTY(EditAnywhere, Category="Constants")
+	float SofteningLength;
+
 public:
 	/**
 	 * @brief Creates new universal constants, can only be used in C++ code.
 	 * @param Timestep Timestep to use
 	 * @param G Gravitational constants to use
+	 * @param Softening Softening length to use
 	 */
-	static UUniversalConstants* Create(const float Timestep, const float G)
+	static UUniversalConstants* Create(const float Timestep, const float G, const float Softening = 0)
 	{
 		auto Result = NewObject<UUniversalConstants>();
 		Result->PhysicsTimestep = Timestep;
 		Result->GravitationalConstant = G;
+		Result->SofteningLength = Softening;
 
 		return Result;
 	}
@@ -68,4 +76,13 @@ public:
 	{
 		return GravitationalConstant;
 	}
+
+	/**
+	 * @brief Returns the softening length.
+	 * @return Softening length
+	 */
+	float GetSofteningLength() const
+	{
+		return SofteningLength;
+	}
 };
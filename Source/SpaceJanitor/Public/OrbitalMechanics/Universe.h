@@ -3,10 +3,18 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "OrbitalEvent.h"
 #include "UniversalConstants.h"
+#include "Async/Future.h"
 #include "GameFramework/Actor.h"
 #include "Universe.generated.h"
 
+class FOrbitalEphemeris;
+class FOrbitalKeyframe;
+class FSphereOfInfluence;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnOrbitalsMerged, const TArray<FOrbitalMerge>&, Merges);
+
 /**
  * @brief Universe actor, runs the N-body simulation. 
  */
@@ -20,6 +28,67 @@ class SPACEJANITOR_API AUniverse : public AActor
 	 */
 	UPROPERTY(EditAnywhere, Category="Universe")
 	UUniversalConstants* Constants;
+
+	/**
+	 * @brief Maximum number of physics steps simulated per frame, slower frames let the simulation fall behind real time
+	 * instead of taking ever longer to catch up.
+	 */
+	UPROPERTY(EditAnywhere, Category="Universe")
+	int32 MaxStepsPerTick;
+
+	/**
+	 * @brief Flag, whether orbitals that are no massive bodies only feel their dominant massive body (patched conics).
+	 */
+	UPROPERTY(EditAnywhere, Category="Universe")
+	bool bUseSphereOfInfluence;
+
+	/**
+	 * @brief Flag, whether orbitals that come within their combined radius are merged into one, conserving mass and momentum.
+	 */
+	UPROPERTY(EditAnywhere, Category="Universe")
+	bool bMergeCollidingOrbitals;
+
+	/**
+	 * @brief Number of physics steps the massive body ephemeris covers, it is refreshed once half of it has elapsed.
+	 */
+	UPROPERTY(EditAnywhere, Category="Universe")
+	int32 EphemerisSteps;
+
+	/**
+	 * @brief Maximum distance between the ephemeris and the simulated massive body trajectories.
+	 */
+	UPROPERTY(EditAnywhere, Category="Universe")
+	float EphemerisTolerance;
+
+	/**
+	 * @brief Number of physics steps between two drift correction keyframes.
+	 */
+	UPROPERTY(EditAnywhere, Category="Replication")
+	int32 KeyframeInterval;
+
+	/**
+	 * @brief Maximum number of orbitals within a single keyframe, larger universes are corrected over several keyframes.
+	 */
+	UPROPERTY(EditAnywhere, Category="Replication")
+	int32 MaxKeyframeBodies;
+
+	/**
+	 * @brief Number of rounds over all orbitals after which keyframes are sent without baseline, for late joining clients.
+	 */
+	UPROPERTY(EditAnywhere, Category="Replication")
+	int32 AbsoluteKeyframeInterval;
+
+	/**
+	 * @brief Precision keyframe locations are quantized to.
+	 */
+	UPROPERTY(EditAnywhere, Category="Replication")
+	float KeyframeLocationPrecision;
+
+	/**
+	 * @brief Precision keyframe velocities are quantized to.
+	 */
+	UPROPERTY(EditAnywhere, Category="Replication")
+	float KeyframeVelocityPrecision;
 	
 	/**
 	 * @brief Flag, whether or not to simulate in editor.
@@ -27,8 +96,18 @@ class SPACEJANITOR_API AUniverse : public AActor
 	UPROPERTY(EditAnywhere, Category="Editor Universe")
 	bool bSimulateInEditor;
 
+	/**
+	 * @brief Interval in which a finished editor simulation checks the map for edits and the map is rescanned for
+	 * orbital movement components.
+	 */
 	UPROPERTY(EditAnywhere, Category="Editor Universe")
 	float SimulationTickInterval = 1;
+
+	/**
+	 * @brief Time in milliseconds the editor simulation may take per frame, the orbits are extended over several frames.
+	 */
+	UPROPERTY(EditAnywhere, Category="Editor Universe")
+	float SimulationBudget = 4;
 	
 	/**
 	 * @brief Number of steps to simulate.
@@ -54,18 +133,144 @@ class SPACEJANITOR_API AUniverse : public AActor
 	UPROPERTY(EditAnywhere, Category="Editor Universe")
 	AActor* DrawOrbitsRelativeTo;
 
-	float EditorSimulationTickTimer = 0;
+	/**
+	 * @brief Orbitals of the running editor simulation, they are kept across frames until the simulation restarts.
+	 */
+	UPROPERTY(Transient)
+	TArray<class UOrbital*> EditorOrbitals;
+
+	/**
+	 * @brief Orbital movement component each editor simulation orbital has been created from.
+	 */
+	UPROPERTY(Transient)
+	TArray<class UOrbitalMovementComponent*> EditorOrbitalMovements;
+
+	/**
+	 * @brief Orbital movement components found by the last scan of the map, hashed every editor tick.
+	 */
+	UPROPERTY(Transient)
+	TArray<class UOrbitalMovementComponent*> EditorMapOrbitalMovements;
+
+	/**
+	 * @brief Time in platform seconds after which the map is scanned for orbital movement components again, catches
+	 * components added to or removed from existing actors.
+	 */
+	double NextEditorScanTime = 0;
+
+	/**
+	 * @brief Flag, whether the map has to be scanned for orbital movement components, set when actors are added or
+	 * deleted.
+	 */
+	bool bRescanEditorOrbitalMovements = true;
+
+#if WITH_EDITOR
+	/**
+	 * @brief Handle of the level actor added event binding.
+	 */
+	FDelegateHandle LevelActorAddedHandle;
+
+	/**
+	 * @brief Handle of the level actor deleted event binding.
+	 */
+	FDelegateHandle LevelActorDeletedHandle;
+#endif
+
+	/**
+	 * @brief Simulated points of each editor simulation orbital in inertial coordinates, starting at its initial location.
+	 */
+	TArray<TArray<FVector>> EditorOrbitPoints;
+
+	/**
+	 * @brief Number of steps the editor simulation has run.
+	 */
+	int32 EditorSimulationStep = 0;
+
+	/**
+	 * @brief Hash of the orbital states the editor simulation started from, used to detect edits.
+	 */
+	uint32 EditorSimulationHash = 0;
+
+	/**
+	 * @brief Flag, whether the editor simulation has to start over.
+	 */
+	bool bRestartEditorSimulation = true;
+
+	/**
+	 * @brief Flag, whether the simulated orbits have to be drawn again, e.g. because the reference frame changed.
+	 */
+	bool bRedrawEditorSimulation = false;
 	
 	/**
 	 * @brief Registered orbitals to simulate. 
 	 */
 	TArray<class IOrbitalInterface*> Orbitals;
+
+	/**
+	 * @brief Number of simulation steps run since the game started.
+	 */
+	int64 SimulationStep = 0;
+
+	/**
+	 * @brief Game time not simulated yet, at most one physics timestep after every tick.
+	 */
+	float StepAccumulator = 0;
+
+	/**
+	 * @brief Version of the massive body set, changes whenever a massive body is registered, unregistered or its state is overridden.
+	 */
+	int32 MassiveOrbitalsVersion = 0;
+
+	/**
+	 * @brief Recorded massive body trajectories, replaced as a whole whenever it gets rebuilt.
+	 */
+	TSharedPtr<const FOrbitalEphemeris, ESPMode::ThreadSafe> Ephemeris;
+
+	/**
+	 * @brief Guards swapping the ephemeris.
+	 */
+	mutable FCriticalSection EphemerisLock;
+
+	/**
+	 * @brief Ephemeris being built on a worker thread, swapped in once it is ready.
+	 */
+	TFuture<TSharedPtr<const FOrbitalEphemeris, ESPMode::ThreadSafe>> PendingEphemeris;
+
+	/**
+	 * @brief Sphere of influence hierarchy, used when simulating in patched conics mode.
+	 */
+	TUniquePtr<FSphereOfInfluence> SphereOfInfluence;
+
+	/**
+	 * @brief Snapshot taken by the last checkpoint.
+	 */
+	TArray<uint8> CheckpointSnapshot;
+
+	/**
+	 * @brief Events that happened since the last tick, sent to the clients in one batch.
+	 */
+	TArray<FOrbitalEvent> PendingEvents;
+
+	/**
+	 * @brief Baselines of the drift correction keyframes, created on first use.
+	 */
+	TUniquePtr<FOrbitalKeyframe> Keyframe;
 	
 public:	
+	/**
+	 * @brief Broadcast once per step with all orbitals that have been merged in it.
+	 */
+	UPROPERTY(BlueprintAssignable, Category="Universe")
+	FOnOrbitalsMerged OnOrbitalsMerged;
+
 	/**
 	 * @brief Default constructor.
 	 */
 	AUniverse();
+
+	/**
+	 * @brief Destructor.
+	 */
+	virtual ~AUniverse() override;
 	
 	/**
 	 * @brief Will be called every frame.
@@ -80,6 +285,19 @@ public:
      */
     virtual bool ShouldTickIfViewportsOnly() const override;
 
+#if WITH_EDITOR
+	/**
+	 * @brief Will be called when a property has been changed in the editor, restarts the editor simulation.
+	 * @param PropertyChangedEvent Property change
+	 */
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	/**
+	 * @brief Will be called before the universe is destroyed, stops listening for level actor changes.
+	 */
+	virtual void BeginDestroy() override;
+
 	/**
 	 * @brief Returns the universal constants.
 	 * @return Universal constants
@@ -89,6 +307,150 @@ public:
 		return Constants;
 	}
 
+	/**
+	 * @brief Returns the number of simulation steps run since the game started.
+	 * @return Current simulation step
+	 */
+	int64 GetSimulationStep() const
+	{
+		return SimulationStep;
+	}
+
+	/**
+	 * @brief Returns the simulation time, this is the number of simulation steps times the physics timestep.
+	 * @return Current simulation time
+	 */
+	UFUNCTION(BlueprintPure, Category="Universe")
+	float GetSimulationTime() const;
+
+	/**
+	 * @brief Returns the version of the massive body set.
+	 * @return Massive body set version
+	 */
+	int32 GetMassiveOrbitalsVersion() const
+	{
+		return MassiveOrbitalsVersion;
+	}
+
+	/**
+	 * @brief Returns whether or not a given orbital is a massive body.
+	 * @param Orbital Orbital to check
+	 * @return Flag, whether the orbital is a massive body
+	 */
+	bool IsMassive(const class IOrbitalInterface* Orbital) const;
+
+	/**
+	 * @brief Returns all registered massive bodies.
+	 * @param Exclude Orbital to leave out of the result, e.g. the orbital a trajectory is predicted for
+	 * @return Registered massive bodies
+	 */
+	TArray<class IOrbitalInterface*> GetMassiveOrbitals(const class IOrbitalInterface* Exclude = nullptr) const;
+
+	/**
+	 * @brief Returns the massive body ephemeris. Starts rebuilding it on a worker thread if the massive body set changed
+	 * or the simulation ran past half of it, the previous ephemeris is returned until the rebuilt one is ready.
+	 * Has to be called from the game thread.
+	 * @return Massive body ephemeris, null until the first one has been built
+	 */
+	TSharedPtr<const FOrbitalEphemeris, ESPMode::ThreadSafe> GetEphemeris();
+
+	/**
+	 * @brief Returns the last built massive body ephemeris without rebuilding it, can be called from any thread.
+	 * @return Last built massive body ephemeris, might be null or stale
+	 */
+	TSharedPtr<const FOrbitalEphemeris, ESPMode::ThreadSafe> GetEphemerisSnapshot() const;
+
+	/**
+	 * @brief Looks up where a massive orbital will be at a given simulation time in the last built ephemeris, can be
+	 * called from any thread. Only game thread queries rebuild the ephemeris, see GetEphemeris.
+	 * @param Orbital Massive orbital to look up
+	 * @param Time Simulation time to look up
+	 * @param OutLocation Predicted location of the orbital
+	 * @return Flag, whether the orbital is part of the ephemeris and the time is covered by it
+	 */
+	bool PredictOrbitalLocation(const class IOrbitalInterface* Orbital, double Time, FVector& OutLocation) const;
+
+	/**
+	 * @brief Looks up where a massive body will be at a given simulation time. Called on the game thread, it keeps the
+	 * ephemeris up to date as well, elsewhere it queries the last built one.
+	 * @param Body Actor with an orbital movement component
+	 * @param Time Simulation time to look up
+	 * @param OutLocation Predicted location of the body
+	 * @return Flag, whether the body is part of the ephemeris and the time is covered by it
+	 */
+	UFUNCTION(BlueprintCallable, Category="Universe")
+	bool PredictBodyLocation(AActor* Body, float Time, FVector& OutLocation);
+
+	/**
+	 * @brief Captures a binary snapshot of all registered orbitals.
+	 * @param OutSnapshot Captured snapshot
+	 */
+	void CaptureSnapshot(TArray<uint8>& OutSnapshot) const;
+
+	/**
+	 * @brief Restores the registered orbitals from a binary snapshot, orbitals are matched by their body identifier.
+	 * Snapshots hold no body classes, so the registered orbitals have to match the snapshot exactly, nothing is
+	 * restored otherwise. The keyframe baselines are reset and the server sends a full keyframe to the clients.
+	 * @param Snapshot Snapshot to restore
+	 * @return Flag, whether the snapshot was valid and matched the registered orbitals
+	 */
+	bool RestoreSnapshot(TArrayView<const uint8> Snapshot);
+
+	/**
+	 * @brief Saves a snapshot of all registered orbitals to a file.
+	 * @param Filename File to save to
+	 * @return Flag, whether the snapshot has been saved
+	 */
+	UFUNCTION(BlueprintCallable, Category="Universe")
+	bool SaveSnapshot(const FString& Filename) const;
+
+	/**
+	 * @brief Restores the registered orbitals from a snapshot file, the file is memory mapped.
+	 * @param Filename File to load from
+	 * @return Flag, whether the snapshot has been restored
+	 */
+	UFUNCTION(BlueprintCallable, Category="Universe")
+	bool LoadSnapshot(const FString& Filename);
+
+	/**
+	 * @brief Captures an in memory checkpoint of all registered orbitals.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Universe")
+	void Checkpoint();
+
+	/**
+	 * @brief Rewinds all registered orbitals to the last checkpoint.
+	 * @return Flag, whether there was a checkpoint to rewind to
+	 */
+	UFUNCTION(BlueprintCallable, Category="Universe")
+	bool RewindToCheckpoint();
+
+	/**
+	 * @brief Changes the velocity of an orbital by an impulse and replicates it, has to be called on the server.
+	 * @param Body Actor with an orbital movement component
+	 * @param Impulse Impulse to apply, the velocity changes by the impulse divided by the mass
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="Universe")
+	void ApplyImpulse(AActor* Body, FVector Impulse);
+
+	/**
+	 * @brief Spawns an orbital and replicates it, has to be called on the server.
+	 * @param BodyClass Actor class with an orbital movement component, must not replicate itself
+	 * @param Location Initial location
+	 * @param Velocity Initial velocity
+	 * @param Mass Mass of the orbital
+	 * @return Spawned actor
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="Universe")
+	AActor* SpawnBody(TSubclassOf<AActor> BodyClass, FVector Location, FVector Velocity, float Mass);
+
+	/**
+	 * @brief Removes an orbital, e.g. when it has been picked up, and replicates it, has to be called on the server.
+	 * @param Body Actor with an orbital movement component
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="Universe")
+	void PickupBody(AActor* Body);
+
 	/**
 	 * @brief Registers a orbital to simulate.
 	 * @param Orbital Orbital to simulate
@@ -107,22 +469,120 @@ protected:
 	 * @brief Will be called when the game starts.
 	 */
 	virtual void BeginPlay() override;
+
+	/**
+	 * @brief Will be called when the game ends or the universe is destroyed.
+	 * @param EndPlayReason Reason why play ended
+	 */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	
 	/**
-	 * @brief Runs the N-body simulation during the game.
+	 * @brief Runs one step of the N-body simulation during the game, the orbital body entities included.
 	 */
 	virtual void Simulate();
 
 	/**
-	 * @brief Runs the N-body simulation in the editor.
+	 * @brief Merges all orbitals that overlap, the more massive orbital absorbs the other one.
+	 */
+	virtual void MergeCollidingOrbitals();
+
+	/**
+	 * @brief Sends the pending events and, when due, a drift correction keyframe to the clients.
+	 */
+	virtual void Replicate();
+
+	/**
+	 * @brief Runs the N-body simulation in the editor, extends the drawn orbits for as many steps as the budget allows.
 	 */
 	virtual void EditorSimulate();
 
 private:
 	/**
-	 * @brief Returns all orbitals to be used within the editor simulation.
-	 * @param OutReferenceFrameOrbital Reference frame orbital, this is the orbital the simulation should be drawn relative to
-	 * @return All orbitals in the current map
+	 * @brief Applies a batch of gameplay events from the server.
+	 * @param Events Events in the order they happened
+	 */
+	UFUNCTION(NetMulticast, Reliable)
+	void MulticastOrbitalEvents(const TArray<FOrbitalEvent>& Events);
+
+	/**
+	 * @brief Corrects the orbitals by a keyframe from the server.
+	 * @param Data Encoded keyframe
+	 */
+	UFUNCTION(NetMulticast, Reliable)
+	void MulticastKeyframe(const TArray<uint8>& Data);
+
+	/**
+	 * @brief Replaces the orbitals and keyframe baselines by a full keyframe after the server restored a snapshot.
+	 * @param Data Encoded keyframe holding every orbital
+	 */
+	UFUNCTION(NetMulticast, Reliable)
+	void MulticastRestore(const TArray<uint8>& Data);
+
+	/**
+	 * @brief Invalidates the ephemeris if a given orbital is a massive body, has to be called whenever the state of an orbital is overridden.
+	 * @param Orbital Orbital whose state has been overridden
+	 */
+	void OnOrbitalStateOverridden(const class IOrbitalInterface* Orbital);
+
+	/**
+	 * @brief Applies a gameplay event from the server to the local simulation.
+	 * @param Event Event to apply
+	 * @param OrbitalMovements Registered orbital movement components by body identifier, kept up to date with spawns and pickups
+	 */
+	void ApplyOrbitalEvent(const FOrbitalEvent& Event, TMap<uint32, class UOrbitalMovementComponent*>& OrbitalMovements);
+
+	/**
+	 * @brief Spawns an actor with an orbital movement component and sets its orbital state.
+	 * @param BodyClass Actor class with an orbital movement component
+	 * @param Location Initial location
+	 * @param Velocity Initial velocity
+	 * @param Mass Mass of the orbital
+	 * @return Orbital movement component of the spawned actor, null if the actor could not be spawned or has none
+	 */
+	class UOrbitalMovementComponent* SpawnOrbital(TSubclassOf<AActor> BodyClass, const FVector& Location, const FVector& Velocity, float Mass);
+
+	/**
+	 * @brief Returns all registered orbital movement components by body identifier.
+	 * @return Registered orbital movement components
+	 */
+	TMap<uint32, class UOrbitalMovementComponent*> GetOrbitalMovementsById() const;
+
+	/**
+	 * @brief Returns all registered orbital movement components.
+	 * @return Registered orbital movement components
+	 */
+	TArray<const class UOrbitalMovementComponent*> GetOrbitalMovements() const;
+
+	/**
+	 * @brief Returns all orbital movement components in the current map.
+	 * @return All orbital movement components
+	 */
+	TArray<class UOrbitalMovementComponent*> GetEditorOrbitalMovements() const;
+
+#if WITH_EDITOR
+	/**
+	 * @brief Will be called when an actor has been added to or deleted from a level, the map is scanned again.
+	 * @param Actor Added or deleted actor
+	 */
+	void OnLevelActorsChanged(AActor* Actor);
+#endif
+
+	/**
+	 * @brief Hashes everything the editor simulation depends on.
+	 * @param OrbitalMovements Orbital movement components in the current map
+	 * @return Hash of the editor simulation input
+	 */
+	uint32 GetEditorSimulationHash(const TArray<class UOrbitalMovementComponent*>& OrbitalMovements) const;
+
+	/**
+	 * @brief Starts the editor simulation over from the current orbital states.
+	 * @param OrbitalMovements Orbital movement components in the current map
+	 */
+	void RestartEditorSimulation(const TArray<class UOrbitalMovementComponent*>& OrbitalMovements);
+
+	/**
+	 * @brief Draws the simulated orbits relative to the current reference frame.
+	 * @param FirstPoint Index of the first point to draw a segment to, earlier segments have already been drawn
 	 */
-	TArray<IOrbitalInterface*> GetEditorOrbitals(IOrbitalInterface*& OutReferenceFrameOrbital) const;
+	void DrawEditorOrbits(int32 FirstPoint) const;
 };
@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassProcessingTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UniverseSubsystem.generated.h"
+
+class AUniverse;
+
+/**
+ * @brief Keeps track of the universe playing in a world, so it can be looked up every frame without searching the world.
+ */
+UCLASS()
+class SPACEJANITOR_API UUniverseSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/**
+	 * @brief Universe playing in the world.
+	 */
+	TWeakObjectPtr<AUniverse> Universe;
+
+	/**
+	 * @brief Processors simulating the orbital body entities, created on first use.
+	 */
+	UPROPERTY()
+	FMassRuntimePipeline EntityPipeline;
+
+public:
+	/**
+	 * @brief Returns the universe playing in the world.
+	 * @return Universe, null if none is playing
+	 */
+	AUniverse* GetUniverse() const
+	{
+		return Universe.Get();
+	}
+
+	/**
+	 * @brief Registers the universe that started playing.
+	 * @param NewUniverse Universe to register
+	 */
+	void Register(AUniverse* NewUniverse);
+
+	/**
+	 * @brief Unregisters a universe that stopped playing.
+	 * @param OldUniverse Universe to unregister, ignored if another one has been registered meanwhile
+	 */
+	void Unregister(const AUniverse* OldUniverse);
+
+	/**
+	 * @brief Simulates the orbital body entities for one simulation step, called by the universe for each of its steps.
+	 * @param Timestep Physics timestep
+	 */
+	void SimulateEntities(float Timestep);
+};
@@ -8,7 +8,7 @@ public class SpaceJanitor : ModuleRules
 	{
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 	
-		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore" });
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "MassEntity", "MassCommon", "MassSpawner", "StructUtils" });
 
 		PrivateDependencyModuleNames.AddRange(new string[] {  });
 